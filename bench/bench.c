@@ -0,0 +1,216 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Upper bound on calibrated iterations per repetition
+#define BENCH_MAX_ITERATIONS 100000000L
+
+// Default harness settings
+void init_bench_options(bench_options_t* options) {
+    if (!options) return;
+
+    options->warmup_repetitions = 3;
+    options->repetitions = 30;
+    options->min_repetition_ms = 10.0;
+    options->filter = NULL;
+    options->perf_counters = 0;
+}
+
+// Monotonic clock in nanoseconds
+int64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Check a case name against the filter
+int bench_matches_filter(const char* name, const bench_options_t* options) {
+    if (!options || !options->filter || options->filter[0] == '\0') return 1;
+    return strstr(name, options->filter) != NULL;
+}
+
+// Time one repetition
+static int64_t time_repetition(const bench_case_t* bench, void* context, long iterations) {
+    int64_t start = bench_now_ns();
+    bench->run(context, iterations);
+    return bench_now_ns() - start;
+}
+
+// Grow the iteration count until one repetition takes at least the target time
+static long calibrate_iterations(const bench_case_t* bench, void* context, double target_ns) {
+    long iterations = 1;
+
+    while (iterations < BENCH_MAX_ITERATIONS) {
+        int64_t elapsed = time_repetition(bench, context, iterations);
+        if (elapsed >= target_ns) break;
+
+        // Aim slightly past the target, but never grow more than 10x per step
+        long next = elapsed > 0 ? (long)(iterations * target_ns * 1.2 / (double)elapsed) : iterations * 10;
+        if (next > iterations * 10) next = iterations * 10;
+        if (next <= iterations) next = iterations + 1;
+        iterations = next;
+    }
+
+    return iterations < BENCH_MAX_ITERATIONS ? iterations : BENCH_MAX_ITERATIONS;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of a sorted array
+static double sorted_percentile(const double* sorted, int count, double fraction) {
+    int rank = (int)(fraction * count + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+// Calibrate, warm up and time one case
+int run_bench_case(const bench_case_t* bench, const bench_options_t* options, bench_result_t* result) {
+    if (!bench || !bench->run || !options || !result || options->repetitions <= 0) return -1;
+
+    memset(result, 0, sizeof(*result));
+    result->name = bench->name;
+
+    void* context = NULL;
+    if (bench->setup && bench->setup(&context) != 0) {
+        fprintf(stderr, "Error: Setup failed for benchmark '%s'\n", bench->name);
+        return -1;
+    }
+
+    result->ns_per_op = malloc(options->repetitions * sizeof(double));
+    if (!result->ns_per_op) {
+        if (bench->teardown) bench->teardown(context);
+        return -1;
+    }
+
+    result->iterations = calibrate_iterations(bench, context, options->min_repetition_ms * 1e6);
+
+    for (int i = 0; i < options->warmup_repetitions; i++) {
+        time_repetition(bench, context, result->iterations);
+    }
+
+    // Counters only cover the timed repetitions; the harness overhead is a few reads per repetition
+    perf_counters_t counters;
+    int have_counters = options->perf_counters && open_perf_counters(&counters) > 0;
+    if (have_counters) {
+        start_perf_counters(&counters);
+    }
+
+    double total = 0.0;
+    for (int i = 0; i < options->repetitions; i++) {
+        int64_t elapsed = time_repetition(bench, context, result->iterations);
+        result->ns_per_op[i] = (double)elapsed / (double)result->iterations;
+        total += result->ns_per_op[i];
+    }
+    result->repetitions = options->repetitions;
+
+    if (have_counters) {
+        perf_reading_t reading;
+        stop_perf_counters(&counters);
+        if (read_perf_counters(&counters, &reading) == 0) {
+            double items = (double)result->iterations * result->repetitions * bench->items_per_op;
+            for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+                result->perf_valid[c] = reading.valid[c];
+                result->perf_per_item[c] = reading.values[c] / items;
+            }
+            if (reading.valid[PERF_COUNTER_CYCLES] && reading.valid[PERF_COUNTER_INSTRUCTIONS] &&
+                reading.values[PERF_COUNTER_CYCLES] > 0) {
+                result->ipc = (double)reading.values[PERF_COUNTER_INSTRUCTIONS] /
+                              (double)reading.values[PERF_COUNTER_CYCLES];
+            }
+        }
+        close_perf_counters(&counters);
+    }
+
+    if (bench->teardown) bench->teardown(context);
+
+    // Summaries come from a sorted copy; ns_per_op keeps repetition order
+    double* sorted = malloc(result->repetitions * sizeof(double));
+    if (!sorted) return -1;
+    memcpy(sorted, result->ns_per_op, result->repetitions * sizeof(double));
+    qsort(sorted, result->repetitions, sizeof(double), compare_doubles);
+
+    result->min_ns = sorted[0];
+    result->median_ns = sorted_percentile(sorted, result->repetitions, 0.50);
+    result->p99_ns = sorted_percentile(sorted, result->repetitions, 0.99);
+    result->mean_ns = total / result->repetitions;
+    if (result->median_ns > 0.0) {
+        result->items_per_second = (double)bench->items_per_op * 1e9 / result->median_ns;
+    }
+
+    free(sorted);
+    return 0;
+}
+
+// Free per-repetition samples
+void cleanup_bench_result(bench_result_t* result) {
+    if (!result) return;
+
+    free(result->ns_per_op);
+    result->ns_per_op = NULL;
+}
+
+// Print result table header
+void print_bench_header(void) {
+    printf("%-28s %12s %5s %12s %12s %12s %14s\n",
+           "Benchmark", "Iterations", "Reps", "Min ns/op", "Median ns/op", "P99 ns/op", "Items/s");
+}
+
+// Print per-item counter value or a dash when the event was unavailable
+static void print_perf_value(const bench_result_t* result, perf_counter_t counter, int width) {
+    if (result->perf_valid[counter]) {
+        printf(" %*.2f", width, result->perf_per_item[counter]);
+    } else {
+        printf(" %*s", width, "-");
+    }
+}
+
+// Print hardware counter table (cases without counters are skipped)
+void print_bench_perf_results(const bench_result_t* results, int count) {
+    int header_printed = 0;
+
+    for (int i = 0; i < count; i++) {
+        const bench_result_t* result = &results[i];
+        int any_valid = 0;
+        for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+            any_valid |= result->perf_valid[c];
+        }
+        if (!any_valid) continue;
+
+        if (!header_printed) {
+            printf("\n=== Hardware Counters (per item, user space) ===\n");
+            printf("%-28s %12s %12s %6s %12s %12s\n",
+                   "Benchmark", "Cycles", "Instructions", "IPC", "Cache miss", "Branch miss");
+            header_printed = 1;
+        }
+
+        printf("%-28s", result->name);
+        print_perf_value(result, PERF_COUNTER_CYCLES, 12);
+        print_perf_value(result, PERF_COUNTER_INSTRUCTIONS, 12);
+        if (result->ipc > 0.0) {
+            printf(" %6.2f", result->ipc);
+        } else {
+            printf(" %6s", "-");
+        }
+        print_perf_value(result, PERF_COUNTER_CACHE_MISSES, 12);
+        print_perf_value(result, PERF_COUNTER_BRANCH_MISSES, 12);
+        printf("\n");
+    }
+}
+
+// Print one result row
+void print_bench_result(const bench_result_t* result) {
+    if (!result) return;
+
+    printf("%-28s %12ld %5d %12.1f %12.1f %12.1f %14.4g\n",
+           result->name, result->iterations, result->repetitions,
+           result->min_ns, result->median_ns, result->p99_ns, result->items_per_second);
+}
@@ -0,0 +1,125 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "../include/perf_counters.h"
+
+// One benchmark case. run() performs 'iterations' operations; each operation
+// processes items_per_op items (samples, records, parses ...).
+typedef struct {
+    const char* name;
+    long items_per_op;
+    int (*setup)(void** context);                 // Optional, returns 0 on success
+    void (*run)(void* context, long iterations);
+    void (*teardown)(void* context);              // Optional
+} bench_case_t;
+
+// Harness settings
+typedef struct {
+    int warmup_repetitions;     // Untimed repetitions before measuring
+    int repetitions;            // Timed repetitions
+    double min_repetition_ms;   // Iteration count is calibrated to at least this long
+    const char* filter;         // Only run cases whose name contains this (NULL = all)
+    int perf_counters;          // Collect hardware counters over the timed repetitions
+} bench_options_t;
+
+// Result of one case
+typedef struct {
+    const char* name;
+    long iterations;            // Operations per repetition
+    int repetitions;
+    double* ns_per_op;          // One entry per timed repetition
+    double min_ns;
+    double median_ns;
+    double p99_ns;
+    double mean_ns;
+    double items_per_second;    // From the median
+
+    // Hardware counters per item over all timed repetitions (when collected)
+    int perf_valid[PERF_COUNTER_COUNT];
+    double perf_per_item[PERF_COUNTER_COUNT];
+    double ipc;                 // Instructions per cycle, 0 if unavailable
+} bench_result_t;
+
+// Default harness settings
+void init_bench_options(bench_options_t* options);
+
+// Monotonic clock in nanoseconds
+int64_t bench_now_ns(void);
+
+// Keep the compiler from discarding a computed value
+static inline void bench_do_not_optimize(const void* value) {
+    __asm__ __volatile__("" : : "r"(value) : "memory");
+}
+
+// Check a case name against the filter
+int bench_matches_filter(const char* name, const bench_options_t* options);
+
+// Calibrate, warm up and time one case
+int run_bench_case(const bench_case_t* bench, const bench_options_t* options, bench_result_t* result);
+
+// Free per-repetition samples
+void cleanup_bench_result(bench_result_t* result);
+
+// Print result table
+void print_bench_header(void);
+void print_bench_result(const bench_result_t* result);
+
+// Print hardware counter table (cases without counters are skipped)
+void print_bench_perf_results(const bench_result_t* results, int count);
+
+// Microbenchmark cases
+const bench_case_t* get_micro_bench_cases(int* count);
+
+// Write the "environment" object (CPU model, compiler, flags, host)
+void write_bench_environment(FILE* file);
+
+// Write results, including every repetition, as JSON
+int write_bench_json(const char* filename, const bench_options_t* options,
+                     const bench_result_t* results, int count);
+
+// Two-sided Mann-Whitney U test p-value between two sets of repetitions
+double mann_whitney_p_value(const double* a, int count_a, const double* b, int count_b);
+
+// Compare two JSON results files; returns the number of significant
+// slowdowns beyond threshold_percent, or -1 on error
+int compare_bench_files(const char* baseline_file, const char* current_file, double threshold_percent);
+
+#define E2E_MAX_STEPS 32
+
+// End-to-end pipeline benchmark settings
+typedef struct {
+    double start_rate;          // Offered samples/s of the first step
+    double max_rate;            // Stop ramping beyond this rate
+    double growth;              // Rate multiplier between ramp steps
+    double step_seconds;        // Duration of each step
+    int refine_steps;           // Bisection steps after the first saturated rate
+    double max_drop_ratio;      // A step is sustained if drops stay at or below this
+    double max_p99_ms;          // ... and p99 ingest-to-durable latency stays below this
+    const char* report_file;    // JSON report path (NULL = none)
+} e2e_options_t;
+
+// Result of one offered rate
+typedef struct {
+    double offered_rate;
+    double achieved_rate;       // Samples written per second of wall time
+    long generated;
+    long logged;
+    long dropped;
+    double drop_ratio;
+    double p50_ms;              // Ingest-to-durable latency percentiles
+    double p90_ms;
+    double p99_ms;
+    double p999_ms;
+    double max_ms;
+    int sustained;
+} e2e_step_t;
+
+// Default end-to-end settings
+void init_e2e_options(e2e_options_t* options);
+
+// Ramp the offered rate until the pipeline saturates and report each step
+int run_e2e_bench(const e2e_options_t* options);
+
+#endif // BENCH_H
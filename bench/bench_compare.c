@@ -0,0 +1,244 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define COMPARE_MAX_RESULTS 64
+#define COMPARE_ALPHA 0.05    // Significance level for flagging a change
+
+// Repetition samples of one benchmark read back from a results file
+typedef struct {
+    char name[64];
+    double* samples;
+    int count;
+    double median;
+} loaded_result_t;
+
+// Read a whole file into memory
+static char* read_file(const char* filename) {
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot open results '%s'\n", filename);
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char* text = size >= 0 ? malloc(size + 1) : NULL;
+    if (text) {
+        size_t length = fread(text, 1, size, file);
+        text[length] = '\0';
+    }
+
+    fclose(file);
+    return text;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Median of an unsorted array
+static double median_of(const double* values, int count) {
+    if (count == 0) return 0.0;
+
+    double* sorted = malloc(count * sizeof(double));
+    if (!sorted) return 0.0;
+    memcpy(sorted, values, count * sizeof(double));
+    qsort(sorted, count, sizeof(double), compare_doubles);
+
+    double median = count % 2 ? sorted[count / 2] : (sorted[count / 2 - 1] + sorted[count / 2]) / 2.0;
+    free(sorted);
+    return median;
+}
+
+// Load name and samples_ns of every result in a file written by write_bench_json.
+// Only the keys this harness writes are understood; this is not a general JSON parser.
+static int load_bench_json(const char* filename, loaded_result_t* results, int max_results) {
+    char* text = read_file(filename);
+    if (!text) return -1;
+
+    int count = 0;
+    char* cursor = strstr(text, "\"results\"");
+
+    while (cursor && count < max_results && (cursor = strstr(cursor, "\"name\": \"")) != NULL) {
+        loaded_result_t* result = &results[count];
+        memset(result, 0, sizeof(*result));
+
+        cursor += strlen("\"name\": \"");
+        size_t length = strcspn(cursor, "\"");
+        if (length >= sizeof(result->name)) length = sizeof(result->name) - 1;
+        memcpy(result->name, cursor, length);
+        result->name[length] = '\0';
+
+        char* samples = strstr(cursor, "\"samples_ns\": [");
+        if (!samples) break;
+        samples += strlen("\"samples_ns\": [");
+
+        // Count entries first, then parse them
+        int capacity = 1;
+        for (char* p = samples; *p && *p != ']'; p++) {
+            if (*p == ',') capacity++;
+        }
+        result->samples = malloc(capacity * sizeof(double));
+        if (!result->samples) break;
+
+        char* p = samples;
+        while (*p && *p != ']' && result->count < capacity) {
+            char* end;
+            double value = strtod(p, &end);
+            if (end == p) break;
+            result->samples[result->count++] = value;
+            p = end;
+            while (*p == ',' || *p == ' ' || *p == '\n') p++;
+        }
+
+        result->median = median_of(result->samples, result->count);
+        cursor = p;
+        count++;
+    }
+
+    free(text);
+
+    if (count == 0) {
+        fprintf(stderr, "Error: No benchmark results found in '%s'\n", filename);
+        return -1;
+    }
+    return count;
+}
+
+// Pooled sample tagged with its group
+typedef struct {
+    double value;
+    int from_a;
+} pooled_sample_t;
+
+static int compare_pooled(const void* a, const void* b) {
+    return compare_doubles(&((const pooled_sample_t*)a)->value, &((const pooled_sample_t*)b)->value);
+}
+
+// Two-sided Mann-Whitney U test p-value (normal approximation with tie correction)
+double mann_whitney_p_value(const double* a, int count_a, const double* b, int count_b) {
+    if (count_a == 0 || count_b == 0) return 1.0;
+
+    int n = count_a + count_b;
+    pooled_sample_t* pooled = malloc(n * sizeof(pooled_sample_t));
+    if (!pooled) return 1.0;
+
+    for (int i = 0; i < n; i++) {
+        pooled[i].value = i < count_a ? a[i] : b[i - count_a];
+        pooled[i].from_a = i < count_a;
+    }
+    qsort(pooled, n, sizeof(pooled_sample_t), compare_pooled);
+
+    // Average ranks over ties
+    double rank_sum_a = 0.0;
+    double tie_term = 0.0;
+    for (int i = 0; i < n;) {
+        int j = i;
+        while (j + 1 < n && pooled[j + 1].value == pooled[i].value) j++;
+
+        double rank = (i + j) / 2.0 + 1.0;
+        for (int k = i; k <= j; k++) {
+            if (pooled[k].from_a) rank_sum_a += rank;
+        }
+
+        double ties = j - i + 1;
+        tie_term += ties * ties * ties - ties;
+        i = j + 1;
+    }
+
+    free(pooled);
+
+    double u = rank_sum_a - count_a * (count_a + 1) / 2.0;
+    double mean = count_a * (double)count_b / 2.0;
+    double variance = count_a * (double)count_b / 12.0 * ((n + 1) - tie_term / ((double)n * (n - 1)));
+    if (variance <= 0.0) return 1.0;
+
+    double difference = fabs(u - mean) - 0.5;  // Continuity correction
+    if (difference < 0.0) difference = 0.0;
+
+    return erfc(difference / sqrt(variance) / sqrt(2.0));
+}
+
+static void free_loaded_results(loaded_result_t* results, int count) {
+    for (int i = 0; i < count; i++) {
+        free(results[i].samples);
+    }
+}
+
+// Compare two results files; returns the number of significant regressions or -1 on error
+int compare_bench_files(const char* baseline_file, const char* current_file, double threshold_percent) {
+    loaded_result_t baseline[COMPARE_MAX_RESULTS];
+    loaded_result_t current[COMPARE_MAX_RESULTS];
+
+    int baseline_count = load_bench_json(baseline_file, baseline, COMPARE_MAX_RESULTS);
+    if (baseline_count < 0) return -1;
+
+    int current_count = load_bench_json(current_file, current, COMPARE_MAX_RESULTS);
+    if (current_count < 0) {
+        free_loaded_results(baseline, baseline_count);
+        return -1;
+    }
+
+    printf("\n=== Benchmark Comparison (threshold %.1f%%, alpha %.2f) ===\n", threshold_percent, COMPARE_ALPHA);
+    printf("Baseline: %s\nCurrent:  %s\n", baseline_file, current_file);
+    printf("%-28s %14s %14s %9s %9s  %s\n",
+           "Benchmark", "Base ns/op", "Current ns/op", "Change", "p-value", "Verdict");
+
+    int regressions = 0;
+    for (int i = 0; i < current_count; i++) {
+        const loaded_result_t* now = &current[i];
+        const loaded_result_t* base = NULL;
+        for (int j = 0; j < baseline_count; j++) {
+            if (strcmp(baseline[j].name, now->name) == 0) {
+                base = &baseline[j];
+                break;
+            }
+        }
+
+        if (!base) {
+            printf("%-28s %14s %14.1f %9s %9s  %s\n", now->name, "-", now->median, "-", "-", "new");
+            continue;
+        }
+
+        double change = base->median > 0.0 ? (now->median - base->median) / base->median * 100.0 : 0.0;
+        double p_value = mann_whitney_p_value(base->samples, base->count, now->samples, now->count);
+
+        const char* verdict = "unchanged";
+        if (p_value < COMPARE_ALPHA && change > threshold_percent) {
+            verdict = "REGRESSION";
+            regressions++;
+        } else if (p_value < COMPARE_ALPHA && change < -threshold_percent) {
+            verdict = "improved";
+        } else if (p_value < COMPARE_ALPHA) {
+            verdict = "within threshold";
+        }
+
+        printf("%-28s %14.1f %14.1f %+8.1f%% %9.4f  %s\n",
+               now->name, base->median, now->median, change, p_value, verdict);
+    }
+
+    for (int j = 0; j < baseline_count; j++) {
+        int found = 0;
+        for (int i = 0; i < current_count && !found; i++) {
+            found = strcmp(baseline[j].name, current[i].name) == 0;
+        }
+        if (!found) {
+            printf("%-28s %14.1f %14s %9s %9s  %s\n", baseline[j].name, baseline[j].median, "-", "-", "-", "removed");
+        }
+    }
+
+    printf("%d regression(s) beyond %.1f%%\n", regressions, threshold_percent);
+
+    free_loaded_results(baseline, baseline_count);
+    free_loaded_results(current, current_count);
+    return regressions;
+}
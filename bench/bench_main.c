@@ -0,0 +1,173 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Print usage information
+static void print_bench_usage(const char* program_name) {
+    printf("Usage: %s [options]\n", program_name);
+    printf("Options:\n");
+    printf("  --filter <text>       Only run benchmarks whose name contains text\n");
+    printf("  --repetitions <n>     Timed repetitions per benchmark (default: 30)\n");
+    printf("  --warmup <n>          Untimed warmup repetitions (default: 3)\n");
+    printf("  --min-time-ms <ms>    Minimum duration of one repetition (default: 10)\n");
+    printf("  --list                List benchmarks and exit\n");
+    printf("  --json <file>         Write results with environment metadata as JSON\n");
+    printf("  --perf                Collect cycles, instructions, cache and branch misses\n");
+    printf("\nComparing results:\n");
+    printf("  --compare <base> <new>  Compare two JSON results files (exit 1 on regression)\n");
+    printf("  --threshold <percent>   Slowdown that counts as a regression (default: 5)\n");
+    printf("\nEnd-to-end pipeline benchmark:\n");
+    printf("  --e2e                 Ramp the simulator -> analysis -> logger pipeline to saturation\n");
+    printf("  --start-rate <n>      First offered rate in samples/s (default: 1000)\n");
+    printf("  --max-rate <n>        Highest offered rate in samples/s (default: 2000000)\n");
+    printf("  --step-seconds <s>    Duration of each rate step (default: 2)\n");
+    printf("  --report <file>       JSON report path (default: e2e_report.json)\n");
+    printf("  --help                Show this help message\n");
+}
+
+// Parse benchmark options; returns 1 when the program should exit successfully
+static int parse_bench_args(int argc, char* argv[], bench_options_t* options,
+                            e2e_options_t* e2e_options, int* list_only, int* e2e_mode,
+                            const char** json_file, const char** compare_files, double* threshold) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--help") == 0) {
+            print_bench_usage(argv[0]);
+            return 1;
+        } else if (strcmp(argv[i], "--list") == 0) {
+            *list_only = 1;
+        } else if (strcmp(argv[i], "--perf") == 0) {
+            options->perf_counters = 1;
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            *json_file = argv[++i];
+        } else if (strcmp(argv[i], "--compare") == 0 && i + 2 < argc) {
+            compare_files[0] = argv[++i];
+            compare_files[1] = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            *threshold = atof(argv[++i]);
+            if (*threshold < 0.0) {
+                fprintf(stderr, "Error: Threshold cannot be negative\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--e2e") == 0) {
+            *e2e_mode = 1;
+        } else if (strcmp(argv[i], "--start-rate") == 0 && i + 1 < argc) {
+            e2e_options->start_rate = atof(argv[++i]);
+            if (e2e_options->start_rate <= 0.0) {
+                fprintf(stderr, "Error: Start rate must be positive\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--max-rate") == 0 && i + 1 < argc) {
+            e2e_options->max_rate = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--step-seconds") == 0 && i + 1 < argc) {
+            e2e_options->step_seconds = atof(argv[++i]);
+            if (e2e_options->step_seconds <= 0.0) {
+                fprintf(stderr, "Error: Step duration must be positive\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--report") == 0 && i + 1 < argc) {
+            e2e_options->report_file = argv[++i];
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            options->filter = argv[++i];
+        } else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+            options->repetitions = atoi(argv[++i]);
+            if (options->repetitions <= 0) {
+                fprintf(stderr, "Error: Repetitions must be positive\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            options->warmup_repetitions = atoi(argv[++i]);
+            if (options->warmup_repetitions < 0) {
+                fprintf(stderr, "Error: Warmup repetitions cannot be negative\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--min-time-ms") == 0 && i + 1 < argc) {
+            options->min_repetition_ms = atof(argv[++i]);
+            if (options->min_repetition_ms <= 0.0) {
+                fprintf(stderr, "Error: Minimum repetition time must be positive\n");
+                return -1;
+            }
+        } else {
+            fprintf(stderr, "Error: Unknown option '%s'\n", argv[i]);
+            print_bench_usage(argv[0]);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    bench_options_t options;
+    e2e_options_t e2e_options;
+    int list_only = 0;
+    int e2e_mode = 0;
+    const char* json_file = NULL;
+    const char* compare_files[2] = {NULL, NULL};
+    double threshold = 5.0;
+
+    init_bench_options(&options);
+    init_e2e_options(&e2e_options);
+
+    int parse_result = parse_bench_args(argc, argv, &options, &e2e_options, &list_only, &e2e_mode,
+                                        &json_file, compare_files, &threshold);
+    if (parse_result != 0) {
+        return parse_result > 0 ? 0 : 1;
+    }
+
+    if (compare_files[0]) {
+        int regressions = compare_bench_files(compare_files[0], compare_files[1], threshold);
+        return regressions == 0 ? 0 : 1;
+    }
+
+    if (e2e_mode) {
+        return run_e2e_bench(&e2e_options) == 0 ? 0 : 1;
+    }
+
+    int case_count = 0;
+    const bench_case_t* cases = get_micro_bench_cases(&case_count);
+
+    if (list_only) {
+        for (int i = 0; i < case_count; i++) {
+            printf("%s\n", cases[i].name);
+        }
+        return 0;
+    }
+
+    // Run every case first so setup output does not break up the table
+    bench_result_t* results = calloc(case_count, sizeof(bench_result_t));
+    if (!results) return 1;
+
+    int failures = 0;
+    for (int i = 0; i < case_count; i++) {
+        if (!bench_matches_filter(cases[i].name, &options)) continue;
+
+        if (run_bench_case(&cases[i], &options, &results[i]) != 0) {
+            failures++;
+        }
+    }
+
+    printf("\n=== Microbenchmarks (%d warmup, %d timed repetitions, >= %.1f ms each) ===\n",
+           options.warmup_repetitions, options.repetitions, options.min_repetition_ms);
+    print_bench_header();
+    for (int i = 0; i < case_count; i++) {
+        if (results[i].repetitions > 0) {
+            print_bench_result(&results[i]);
+        }
+    }
+
+    print_bench_perf_results(results, case_count);
+
+    if (json_file && write_bench_json(json_file, &options, results, case_count) == 0) {
+        printf("Results written to %s\n", json_file);
+    }
+
+    for (int i = 0; i < case_count; i++) {
+        cleanup_bench_result(&results[i]);
+    }
+
+    free(results);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/utsname.h>
+
+#ifndef BENCH_CFLAGS
+#define BENCH_CFLAGS "unknown"
+#endif
+
+// Write a JSON string literal, escaping quotes, backslashes and control characters
+static void write_json_string(FILE* file, const char* text) {
+    fputc('"', file);
+    for (const char* p = text; p && *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fputc('\\', file);
+            fputc(*p, file);
+        } else if ((unsigned char)*p >= 0x20) {
+            fputc(*p, file);
+        }
+    }
+    fputc('"', file);
+}
+
+// CPU model from /proc/cpuinfo
+static void read_cpu_model(char* buffer, size_t buffer_size) {
+    snprintf(buffer, buffer_size, "unknown");
+
+    FILE* file = fopen("/proc/cpuinfo", "r");
+    if (!file) return;
+
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        if (strncmp(line, "model name", 10) == 0) {
+            char* value = strchr(line, ':');
+            if (value) {
+                value++;
+                while (*value == ' ' || *value == '\t') value++;
+                value[strcspn(value, "\n")] = '\0';
+                snprintf(buffer, buffer_size, "%s", value);
+            }
+            break;
+        }
+    }
+
+    fclose(file);
+}
+
+// Write the "environment" object (CPU, compiler, flags, host)
+void write_bench_environment(FILE* file) {
+    if (!file) return;
+
+    char cpu_model[128];
+    read_cpu_model(cpu_model, sizeof(cpu_model));
+
+    struct utsname host;
+    if (uname(&host) != 0) {
+        memset(&host, 0, sizeof(host));
+    }
+
+    char date[32];
+    time_t now = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+    fprintf(file, "  \"environment\": {\n");
+    fprintf(file, "    \"date\": ");
+    write_json_string(file, date);
+    fprintf(file, ",\n    \"host\": ");
+    write_json_string(file, host.nodename);
+    fprintf(file, ",\n    \"kernel\": ");
+    write_json_string(file, host.release);
+    fprintf(file, ",\n    \"machine\": ");
+    write_json_string(file, host.machine);
+    fprintf(file, ",\n    \"cpu_model\": ");
+    write_json_string(file, cpu_model);
+    fprintf(file, ",\n    \"online_cpus\": %ld", sysconf(_SC_NPROCESSORS_ONLN));
+    fprintf(file, ",\n    \"compiler\": ");
+#ifdef __VERSION__
+    write_json_string(file, __VERSION__);
+#else
+    write_json_string(file, "unknown");
+#endif
+    fprintf(file, ",\n    \"cflags\": ");
+    write_json_string(file, BENCH_CFLAGS);
+    fprintf(file, "\n  },\n");
+}
+
+// Write microbenchmark results, including every repetition, as JSON
+int write_bench_json(const char* filename, const bench_options_t* options,
+                     const bench_result_t* results, int count) {
+    if (!filename || !options || !results) return -1;
+
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot write results '%s'\n", filename);
+        return -1;
+    }
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"benchmark\": \"micro\",\n");
+    write_bench_environment(file);
+    fprintf(file, "  \"warmup_repetitions\": %d,\n", options->warmup_repetitions);
+    fprintf(file, "  \"min_repetition_ms\": %.3f,\n", options->min_repetition_ms);
+    fprintf(file, "  \"results\": [");
+
+    int written = 0;
+    for (int i = 0; i < count; i++) {
+        const bench_result_t* result = &results[i];
+        if (result->repetitions == 0) continue;
+
+        fprintf(file, "%s\n    {\"name\": ", written++ ? "," : "");
+        write_json_string(file, result->name);
+        fprintf(file, ", \"iterations\": %ld, \"repetitions\": %d, "
+                      "\"min_ns\": %.3f, \"median_ns\": %.3f, \"p99_ns\": %.3f, \"mean_ns\": %.3f, "
+                      "\"items_per_second\": %.1f,\n     \"samples_ns\": [",
+                result->iterations, result->repetitions, result->min_ns, result->median_ns,
+                result->p99_ns, result->mean_ns, result->items_per_second);
+
+        for (int r = 0; r < result->repetitions; r++) {
+            fprintf(file, "%s%.3f", r ? ", " : "", result->ns_per_op[r]);
+        }
+        fprintf(file, "]");
+
+        // Per-item hardware counters, only for events that were collected
+        int perf_written = 0;
+        for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+            if (!result->perf_valid[c]) continue;
+            fprintf(file, "%s\"%s_per_item\": %.4f", perf_written++ ? ", " : ",\n     \"perf\": {",
+                    perf_counter_name((perf_counter_t)c), result->perf_per_item[c]);
+        }
+        if (perf_written) {
+            if (result->ipc > 0.0) fprintf(file, ", \"ipc\": %.4f", result->ipc);
+            fprintf(file, "}");
+        }
+        fprintf(file, "}");
+    }
+
+    fprintf(file, "\n  ]\n}\n");
+    fclose(file);
+    return 0;
+}
@@ -0,0 +1,377 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench.h"
+#include "../include/sensor_simulator.h"
+#include "../include/data_logger.h"
+#include "../include/data_analyzer.h"
+#include "../include/realtime.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+
+#define E2E_RING_CAPACITY 16384      // Acquisition to analysis queue (power of two)
+#define E2E_TICK_NS 1000000L         // Producer wakes every millisecond
+#define E2E_MAX_BACKLOG_SECONDS 0.1  // Producer overrun beyond this is counted as dropped
+#define E2E_IDLE_SLEEP_NS 100000L    // Consumer back-off when the queue is empty
+
+// Queued sample with its acquisition time
+typedef struct {
+    sensor_data_t data;
+    int64_t ingest_ns;
+} e2e_slot_t;
+
+// One pipeline run at a fixed offered rate
+typedef struct {
+    double rate;
+    double seconds;
+
+    // Single-producer single-consumer queue
+    e2e_slot_t* ring;
+    atomic_long head;
+    atomic_long tail;
+    atomic_int producing;
+
+    // Producer side
+    int64_t start_ns;
+    long generated;
+    long dropped;
+
+    // Consumer side
+    long logged;
+    int64_t end_ns;
+    double* latencies_ns;
+    long latency_count;
+    long latency_capacity;
+} e2e_pipeline_t;
+
+// Default end-to-end settings
+void init_e2e_options(e2e_options_t* options) {
+    if (!options) return;
+
+    options->start_rate = 1000.0;
+    options->max_rate = 2000000.0;
+    options->growth = 2.0;
+    options->step_seconds = 2.0;
+    options->refine_steps = 3;
+    options->max_drop_ratio = 0.001;
+    options->max_p99_ms = 1000.0;
+    options->report_file = "e2e_report.json";
+}
+
+// Acquisition thread: generate samples at the offered rate
+static void* e2e_producer(void* arg) {
+    e2e_pipeline_t* pipeline = arg;
+    long max_backlog = (long)(pipeline->rate * E2E_MAX_BACKLOG_SECONDS) + 1;
+    int64_t duration_ns = (int64_t)(pipeline->seconds * 1e9);
+
+    timestamp_ns_t deadline = get_current_time();
+
+    for (;;) {
+        int64_t elapsed = bench_now_ns() - pipeline->start_ns;
+        if (elapsed > duration_ns) elapsed = duration_ns;
+
+        long due = (long)(pipeline->rate * (double)elapsed / 1e9) - pipeline->generated;
+
+        // Samples the producer itself was too late to read are lost
+        if (due > max_backlog) {
+            pipeline->dropped += due - max_backlog;
+            pipeline->generated += due - max_backlog;
+            due = max_backlog;
+        }
+
+        long head = atomic_load_explicit(&pipeline->head, memory_order_relaxed);
+        for (long i = 0; i < due; i++) {
+            long tail = atomic_load_explicit(&pipeline->tail, memory_order_acquire);
+            pipeline->generated++;
+
+            if (head - tail >= E2E_RING_CAPACITY) {
+                pipeline->dropped++;
+                continue;
+            }
+
+            e2e_slot_t* slot = &pipeline->ring[head & (E2E_RING_CAPACITY - 1)];
+            slot->data = generate_bridge_vibration_data();
+            slot->ingest_ns = bench_now_ns();
+            head++;
+            atomic_store_explicit(&pipeline->head, head, memory_order_release);
+        }
+
+        if (elapsed >= duration_ns) break;
+
+        deadline += E2E_TICK_NS;
+        wait_until_deadline(deadline, E2E_TICK_NS, NULL);
+    }
+
+    atomic_store_explicit(&pipeline->producing, 0, memory_order_release);
+    return NULL;
+}
+
+// Record ingest-to-durable latency for every sample written by the last flush
+static void record_durable(e2e_pipeline_t* pipeline, const int64_t* pending, int count) {
+    int64_t durable_ns = bench_now_ns();
+
+    for (int i = 0; i < count && pipeline->latency_count < pipeline->latency_capacity; i++) {
+        pipeline->latencies_ns[pipeline->latency_count++] = (double)(durable_ns - pending[i]);
+    }
+    pipeline->logged += count;
+}
+
+// Analysis and logging thread: the same per-sample work as bridge monitoring
+static void* e2e_consumer(void* arg) {
+    e2e_pipeline_t* pipeline = arg;
+    data_logger_t logger;
+    statistics_t stats;
+    moving_average_t moving_avg;
+    anomaly_config_t anomaly_config;
+
+    memset(&logger, 0, sizeof(logger));
+    if (init_data_logger(&logger, "bench_e2e") != 0) {
+        atomic_store(&pipeline->tail, -1);
+        return NULL;
+    }
+    logger.config.auto_rotate = 0;
+
+    init_statistics(&stats);
+    init_moving_average(&moving_avg, 20);
+    anomaly_config.threshold_multiplier = 3.0;
+    anomaly_config.absolute_threshold = 1.0;
+    anomaly_config.window_size = 50;
+    anomaly_config.min_samples_for_analysis = 20;
+
+    // Ingest times of samples still sitting in the logger buffer
+    int64_t* pending = malloc(logger.config.buffer_size * sizeof(int64_t));
+    int pending_count = 0;
+    double moving_sum = 0.0;
+
+    long tail = 0;
+    for (;;) {
+        long head = atomic_load_explicit(&pipeline->head, memory_order_acquire);
+
+        if (tail == head) {
+            if (!atomic_load_explicit(&pipeline->producing, memory_order_acquire) &&
+                tail == atomic_load_explicit(&pipeline->head, memory_order_acquire)) {
+                break;
+            }
+            struct timespec idle = {0, E2E_IDLE_SLEEP_NS};
+            nanosleep(&idle, NULL);
+            continue;
+        }
+
+        while (tail < head) {
+            const e2e_slot_t* slot = &pipeline->ring[tail & (E2E_RING_CAPACITY - 1)];
+
+            update_statistics(&stats, slot->data.value);
+            moving_sum += update_moving_average(&moving_avg, slot->data.value);
+            if (stats.sample_count >= anomaly_config.min_samples_for_analysis) {
+                finalize_statistics(&stats);
+                detect_anomaly(&slot->data, &stats, &anomaly_config);
+            }
+
+            if (pending) pending[pending_count++] = slot->ingest_ns;
+            log_sensor_data(&logger, &slot->data);
+
+            // An empty buffer after logging means the batch was just written
+            if (logger.buffer_index == 0 && pending) {
+                record_durable(pipeline, pending, pending_count);
+                pending_count = 0;
+            }
+
+            tail++;
+            atomic_store_explicit(&pipeline->tail, tail, memory_order_release);
+        }
+    }
+
+    flush_logger_buffer(&logger);
+    if (pending) record_durable(pipeline, pending, pending_count);
+    pipeline->end_ns = bench_now_ns();
+    bench_do_not_optimize(&moving_sum);
+
+    char filename[512];
+    snprintf(filename, sizeof(filename), "%s", logger.current_filename);
+    cleanup_data_logger(&logger);
+    cleanup_moving_average(&moving_avg);
+    remove(filename);
+    free(pending);
+    return NULL;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of a sorted array, in milliseconds
+static double percentile_ms(const double* sorted, long count, double fraction) {
+    if (count == 0) return 0.0;
+
+    long rank = (long)(fraction * count + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1] / 1e6;
+}
+
+// Run the pipeline at one offered rate
+static int run_e2e_step(double rate, const e2e_options_t* options, e2e_step_t* step) {
+    e2e_pipeline_t pipeline;
+    memset(&pipeline, 0, sizeof(pipeline));
+    memset(step, 0, sizeof(*step));
+
+    pipeline.rate = rate;
+    pipeline.seconds = options->step_seconds;
+    pipeline.latency_capacity = (long)(rate * options->step_seconds) + E2E_RING_CAPACITY;
+    pipeline.ring = malloc(E2E_RING_CAPACITY * sizeof(e2e_slot_t));
+    pipeline.latencies_ns = malloc(pipeline.latency_capacity * sizeof(double));
+    if (!pipeline.ring || !pipeline.latencies_ns) {
+        fprintf(stderr, "Error: Cannot allocate pipeline buffers for %.0f samples/s\n", rate);
+        free(pipeline.ring);
+        free(pipeline.latencies_ns);
+        return -1;
+    }
+    atomic_store(&pipeline.producing, 1);
+
+    pthread_t producer, consumer;
+    pipeline.start_ns = bench_now_ns();
+    if (pthread_create(&consumer, NULL, e2e_consumer, &pipeline) != 0) {
+        free(pipeline.ring);
+        free(pipeline.latencies_ns);
+        return -1;
+    }
+    if (pthread_create(&producer, NULL, e2e_producer, &pipeline) != 0) {
+        atomic_store(&pipeline.producing, 0);
+        pthread_join(consumer, NULL);
+        free(pipeline.ring);
+        free(pipeline.latencies_ns);
+        return -1;
+    }
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+
+    int result = atomic_load(&pipeline.tail) < 0 ? -1 : 0;
+
+    qsort(pipeline.latencies_ns, pipeline.latency_count, sizeof(double), compare_doubles);
+
+    double elapsed = (double)(pipeline.end_ns - pipeline.start_ns) / 1e9;
+    step->offered_rate = rate;
+    step->achieved_rate = elapsed > 0.0 ? pipeline.logged / elapsed : 0.0;
+    step->generated = pipeline.generated;
+    step->dropped = pipeline.dropped;
+    step->logged = pipeline.logged;
+    step->drop_ratio = pipeline.generated > 0 ? (double)pipeline.dropped / pipeline.generated : 0.0;
+    step->p50_ms = percentile_ms(pipeline.latencies_ns, pipeline.latency_count, 0.50);
+    step->p90_ms = percentile_ms(pipeline.latencies_ns, pipeline.latency_count, 0.90);
+    step->p99_ms = percentile_ms(pipeline.latencies_ns, pipeline.latency_count, 0.99);
+    step->p999_ms = percentile_ms(pipeline.latencies_ns, pipeline.latency_count, 0.999);
+    step->max_ms = percentile_ms(pipeline.latencies_ns, pipeline.latency_count, 1.0);
+    step->sustained = result == 0 &&
+                      step->drop_ratio <= options->max_drop_ratio &&
+                      step->p99_ms <= options->max_p99_ms;
+
+    free(pipeline.ring);
+    free(pipeline.latencies_ns);
+    return result;
+}
+
+// Print one step row
+static void print_e2e_step(const e2e_step_t* step) {
+    printf("%12.0f %12.0f %10ld %10ld %9.4f%% %9.2f %9.2f %9.2f %9.2f  %s\n",
+           step->offered_rate, step->achieved_rate, step->logged, step->dropped,
+           step->drop_ratio * 100.0, step->p50_ms, step->p99_ms, step->p999_ms, step->max_ms,
+           step->sustained ? "ok" : "SATURATED");
+}
+
+// Write the machine-readable report
+static int write_e2e_report(const char* filename, const e2e_options_t* options,
+                            const e2e_step_t* steps, int step_count, double saturation_rate) {
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot write report '%s'\n", filename);
+        return -1;
+    }
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"benchmark\": \"e2e_pipeline\",\n");
+    write_bench_environment(file);
+    fprintf(file, "  \"pipeline\": \"generate_bridge_vibration_data -> update_statistics/detect_anomaly -> log_sensor_data\",\n");
+    fprintf(file, "  \"step_seconds\": %.3f,\n", options->step_seconds);
+    fprintf(file, "  \"queue_capacity\": %d,\n", E2E_RING_CAPACITY);
+    fprintf(file, "  \"max_drop_ratio\": %g,\n", options->max_drop_ratio);
+    fprintf(file, "  \"max_p99_ms\": %g,\n", options->max_p99_ms);
+    fprintf(file, "  \"saturation_rate\": %.0f,\n", saturation_rate);
+    fprintf(file, "  \"steps\": [\n");
+
+    for (int i = 0; i < step_count; i++) {
+        const e2e_step_t* step = &steps[i];
+        fprintf(file, "    {\"offered_rate\": %.0f, \"achieved_rate\": %.1f, \"generated\": %ld, "
+                      "\"logged\": %ld, \"dropped\": %ld, \"drop_ratio\": %.6f, "
+                      "\"latency_ms\": {\"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"p999\": %.3f, \"max\": %.3f}, "
+                      "\"sustained\": %s}%s\n",
+                step->offered_rate, step->achieved_rate, step->generated, step->logged, step->dropped,
+                step->drop_ratio, step->p50_ms, step->p90_ms, step->p99_ms, step->p999_ms, step->max_ms,
+                step->sustained ? "true" : "false", i + 1 < step_count ? "," : "");
+    }
+
+    fprintf(file, "  ]\n");
+    fprintf(file, "}\n");
+    fclose(file);
+    return 0;
+}
+
+// Ramp the offered rate until the pipeline saturates
+int run_e2e_bench(const e2e_options_t* options) {
+    if (!options || options->start_rate <= 0.0 || options->growth <= 1.0) return -1;
+
+    e2e_step_t steps[E2E_MAX_STEPS];
+    int step_count = 0;
+    double best_rate = 0.0;
+    double failed_rate = 0.0;
+
+    init_sensor_simulator();
+
+    // Geometric ramp until the first failing rate
+    for (double rate = options->start_rate; rate <= options->max_rate && step_count < E2E_MAX_STEPS;
+         rate *= options->growth) {
+        if (run_e2e_step(rate, options, &steps[step_count]) != 0) return -1;
+        if (steps[step_count++].sustained) {
+            best_rate = rate;
+        } else {
+            failed_rate = rate;
+            break;
+        }
+    }
+
+    // Bisect between the last sustained and the first failing rate
+    for (int i = 0; i < options->refine_steps && failed_rate > 0.0 && best_rate > 0.0 &&
+                    step_count < E2E_MAX_STEPS; i++) {
+        double rate = (best_rate + failed_rate) / 2.0;
+        if (run_e2e_step(rate, options, &steps[step_count]) != 0) return -1;
+        if (steps[step_count++].sustained) {
+            best_rate = rate;
+        } else {
+            failed_rate = rate;
+        }
+    }
+
+    printf("\n=== End-to-End Pipeline (%.1f s per step) ===\n", options->step_seconds);
+    printf("%12s %12s %10s %10s %10s %9s %9s %9s %9s\n",
+           "Offered/s", "Achieved/s", "Logged", "Dropped", "Drop", "P50 ms", "P99 ms", "P99.9 ms", "Max ms");
+    for (int i = 0; i < step_count; i++) {
+        print_e2e_step(&steps[i]);
+    }
+
+    if (failed_rate > 0.0) {
+        printf("Saturation point: %.0f samples/s sustained\n", best_rate);
+    } else {
+        printf("No saturation up to %.0f samples/s\n", best_rate);
+    }
+
+    if (options->report_file && write_e2e_report(options->report_file, options, steps,
+                                                 step_count, best_rate) == 0) {
+        printf("Report written to %s\n", options->report_file);
+    }
+
+    return 0;
+}
@@ -0,0 +1,244 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench.h"
+#include "../include/utils.h"
+#include "../include/sensor_simulator.h"
+#include "../include/hardware_interface.h"
+#include "../include/data_logger.h"
+#include "../include/data_analyzer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define SAMPLE_SET_SIZE 1024     // Power of two so indices wrap with a mask
+#define ANALYSIS_WINDOW 256      // Matches BRIDGE_RECENT_WINDOW in main.c
+#define TREND_WINDOW 50          // Matches BRIDGE_TREND_WINDOW in main.c
+#define MOVING_AVERAGE_WINDOW 20 // Matches the bridge monitor filter
+
+// Deterministic vibration-like samples
+static void fill_samples(sensor_data_t* samples, int count) {
+    timestamp_ns_t now = get_current_time();
+
+    for (int i = 0; i < count; i++) {
+        memset(&samples[i], 0, sizeof(samples[i]));
+        samples[i].type = SENSOR_VIBRATION;
+        samples[i].value = 0.05 * sin(i * 0.37) + 0.01 * sin(i * 2.9) + 0.002 * (i % 7);
+        samples[i].timestamp = now + (int64_t)i * NS_PER_MS;
+        strcpy(samples[i].unit, "m/s²");
+        strcpy(samples[i].description, "Bridge Vibration Sensor");
+    }
+}
+
+// ---- flush_logger_buffer ----
+
+static int setup_flush(void** context) {
+    data_logger_t* logger = calloc(1, sizeof(data_logger_t));
+    if (!logger) return -1;
+
+    if (init_data_logger(logger, "bench_flush") != 0) {
+        free(logger);
+        return -1;
+    }
+
+    // Keep the benchmark to a single file
+    logger->config.auto_rotate = 0;
+    fill_samples(logger->buffer, logger->config.buffer_size);
+
+    *context = logger;
+    return 0;
+}
+
+static void run_flush(void* context, long iterations) {
+    data_logger_t* logger = context;
+
+    // Synchronous flushes leave the buffer contents intact, so refilling is free
+    for (long i = 0; i < iterations; i++) {
+        logger->buffer_index = logger->config.buffer_size;
+        flush_logger_buffer(logger);
+    }
+}
+
+static void teardown_flush(void* context) {
+    data_logger_t* logger = context;
+    char filename[512];
+
+    snprintf(filename, sizeof(filename), "%s", logger->current_filename);
+    cleanup_data_logger(logger);
+    remove(filename);
+    free(logger);
+}
+
+// ---- format_timestamp ----
+
+static void run_format_timestamp(void* context, long iterations) {
+    (void)context;
+    timestamp_ns_t start = get_current_time();
+    char buffer[32];
+
+    for (long i = 0; i < iterations; i++) {
+        format_timestamp(start + (i * 1000L) % NS_PER_SEC, buffer, sizeof(buffer));
+        bench_do_not_optimize(buffer);
+    }
+}
+
+// ---- parse_arduino_sensor_data / parse_modbus_sensor_data ----
+
+static void run_parse_arduino(void* context, long iterations) {
+    (void)context;
+    static const char* lines[] = {
+        "SENSOR:VIB:0.0234:m/s2:Bridge Deck\n",
+        "SENSOR:TEMP:21.75:C:Abutment\n",
+        "SENSOR:STRAIN:152.3:ue:Main Girder\n",
+        "SENSOR:ACCEL_Z:-0.981:g:Pier 2\n"
+    };
+    sensor_data_t data;
+
+    for (long i = 0; i < iterations; i++) {
+        parse_arduino_sensor_data(lines[i & 3], &data);
+        bench_do_not_optimize(&data);
+    }
+}
+
+static void run_parse_modbus(void* context, long iterations) {
+    (void)context;
+    static const char* lines[] = {
+        "MB:01:0001:2345\n",
+        "MB:01:0002:6120\n",
+        "MB:02:0003:10132\n",
+        "MB:02:0004:512\n"
+    };
+    sensor_data_t data;
+
+    for (long i = 0; i < iterations; i++) {
+        parse_modbus_sensor_data(lines[i & 3], &data);
+        bench_do_not_optimize(&data);
+    }
+}
+
+// ---- update_statistics / update_moving_average ----
+
+// Shared value set for the per-sample cases
+typedef struct {
+    double values[SAMPLE_SET_SIZE];
+    statistics_t stats;
+    moving_average_t moving_avg;
+} value_context_t;
+
+static int setup_values(void** context) {
+    value_context_t* values = calloc(1, sizeof(value_context_t));
+    if (!values) return -1;
+
+    sensor_data_t* samples = malloc(SAMPLE_SET_SIZE * sizeof(sensor_data_t));
+    if (!samples) {
+        free(values);
+        return -1;
+    }
+    fill_samples(samples, SAMPLE_SET_SIZE);
+    for (int i = 0; i < SAMPLE_SET_SIZE; i++) {
+        values->values[i] = samples[i].value;
+    }
+    free(samples);
+
+    init_statistics(&values->stats);
+    if (init_moving_average(&values->moving_avg, MOVING_AVERAGE_WINDOW) != 0) {
+        free(values);
+        return -1;
+    }
+
+    *context = values;
+    return 0;
+}
+
+static void teardown_values(void* context) {
+    value_context_t* values = context;
+    cleanup_moving_average(&values->moving_avg);
+    free(values);
+}
+
+static void run_update_statistics(void* context, long iterations) {
+    value_context_t* values = context;
+
+    for (long i = 0; i < iterations; i++) {
+        update_statistics(&values->stats, values->values[i & (SAMPLE_SET_SIZE - 1)]);
+    }
+    bench_do_not_optimize(&values->stats);
+}
+
+static void run_update_moving_average(void* context, long iterations) {
+    value_context_t* values = context;
+    double average = 0.0;
+
+    for (long i = 0; i < iterations; i++) {
+        average += update_moving_average(&values->moving_avg, values->values[i & (SAMPLE_SET_SIZE - 1)]);
+    }
+    bench_do_not_optimize(&average);
+}
+
+// ---- analyze_trend / analyze_bridge_vibration ----
+
+static int setup_window(void** context) {
+    sensor_data_t* samples = malloc(ANALYSIS_WINDOW * sizeof(sensor_data_t));
+    if (!samples) return -1;
+
+    fill_samples(samples, ANALYSIS_WINDOW);
+    *context = samples;
+    return 0;
+}
+
+static void teardown_window(void* context) {
+    free(context);
+}
+
+static void run_analyze_trend(void* context, long iterations) {
+    const sensor_data_t* samples = context;
+
+    for (long i = 0; i < iterations; i++) {
+        trend_analysis_t trend = analyze_trend(samples, ANALYSIS_WINDOW, TREND_WINDOW);
+        bench_do_not_optimize(&trend);
+    }
+}
+
+static void run_analyze_bridge_vibration(void* context, long iterations) {
+    const sensor_data_t* samples = context;
+
+    for (long i = 0; i < iterations; i++) {
+        bridge_analysis_t analysis = analyze_bridge_vibration(samples, ANALYSIS_WINDOW);
+        bench_do_not_optimize(&analysis);
+    }
+}
+
+// ---- generate_sensor_data ----
+
+static int setup_simulator(void** context) {
+    (void)context;
+    init_sensor_simulator();
+    return 0;
+}
+
+static void run_generate_sensor_data(void* context, long iterations) {
+    (void)context;
+
+    for (long i = 0; i < iterations; i++) {
+        sensor_data_t data = generate_sensor_data(SENSOR_VIBRATION);
+        bench_do_not_optimize(&data);
+    }
+}
+
+static const bench_case_t micro_cases[] = {
+    {"flush_logger_buffer", 100, setup_flush, run_flush, teardown_flush},
+    {"format_timestamp", 1, NULL, run_format_timestamp, NULL},
+    {"parse_arduino_sensor_data", 1, NULL, run_parse_arduino, NULL},
+    {"parse_modbus_sensor_data", 1, NULL, run_parse_modbus, NULL},
+    {"update_statistics", 1, setup_values, run_update_statistics, teardown_values},
+    {"update_moving_average", 1, setup_values, run_update_moving_average, teardown_values},
+    {"analyze_trend", TREND_WINDOW, setup_window, run_analyze_trend, teardown_window},
+    {"analyze_bridge_vibration", ANALYSIS_WINDOW, setup_window, run_analyze_bridge_vibration, teardown_window},
+    {"generate_sensor_data", 1, setup_simulator, run_generate_sensor_data, NULL}
+};
+
+// Microbenchmark cases
+const bench_case_t* get_micro_bench_cases(int* count) {
+    if (count) *count = (int)(sizeof(micro_cases) / sizeof(micro_cases[0]));
+    return micro_cases;
+}
@@ -0,0 +1,77 @@
+#ifndef ADAPTIVE_RATE_H
+#define ADAPTIVE_RATE_H
+
+#include "sensor_simulator.h"
+
+#define ADAPTIVE_MAX_CHANNELS 8
+#define ADAPTIVE_WARMUP_SAMPLES 64          // Samples forming the first baseline
+#define ADAPTIVE_FAST_WEIGHT (1.0 / 8)      // Recent activity, about 8 samples
+#define ADAPTIVE_SLOW_WEIGHT (1.0 / 1024)   // Baseline, about 1024 samples
+#define ADAPTIVE_DEFAULT_RAISE 2.5
+#define ADAPTIVE_DEFAULT_LOWER 1.5
+#define ADAPTIVE_DEFAULT_HOLD_MS 2000
+
+// Interval range of one channel
+typedef struct {
+    int min_interval_ms;        // While the signal is active
+    int max_interval_ms;        // While it is quiet
+} adaptive_bounds_t;
+
+// Switching thresholds shared by the channels of a controller. Between
+// lower_score and raise_score the interval stays where it is (hysteresis).
+typedef struct {
+    double raise_score;         // Activity at or above this halves the interval
+    double lower_score;         // Activity below this for hold_ms doubles it
+    int hold_ms;
+} adaptive_config_t;
+
+// Activity and current interval of one channel. Activity is the larger of
+// recent standard deviation over the baseline one and the distance of the
+// recent mean from the baseline mean in baseline deviations (rate of change).
+typedef struct {
+    adaptive_bounds_t bounds;
+    int interval_ms;
+    double fast_mean;
+    double fast_variance;
+    double slow_mean;
+    double slow_variance;
+    double score;
+    long samples;
+    timestamp_ns_t quiet_since;     // Start of the current quiet stretch (0 = not quiet)
+    timestamp_ns_t last_kept;
+    timestamp_ns_t next_keep;       // Time slot of the next kept sample
+
+    long kept;
+    long raises;
+    long lowers;
+    int fastest_ms;                 // Shortest interval reached
+} adaptive_channel_t;
+
+// Per-channel sampling rate controller. Acquisition runs at the shortest
+// channel interval; each channel then keeps only the samples that fall on its
+// own interval, so quiet channels are logged sparsely without slowing down
+// active ones. An anomaly moves its channel straight to the fastest rate.
+typedef struct {
+    adaptive_config_t config;
+    adaptive_channel_t channels[ADAPTIVE_MAX_CHANNELS];
+    int channel_count;
+} adaptive_rate_t;
+
+// Fill in the default thresholds
+void init_adaptive_config(adaptive_config_t* config);
+
+// Start every channel at initial_interval_ms, clamped to its bounds
+int init_adaptive_rate(adaptive_rate_t* rate, const adaptive_config_t* config,
+                       const adaptive_bounds_t* bounds, int channel_count, int initial_interval_ms);
+
+// Feed one acquired sample of a channel (anomaly = detection flagged it).
+// Returns 1 when the sample falls on the channel's current interval.
+int update_adaptive_rate(adaptive_rate_t* rate, int channel, const sensor_data_t* sample, int anomaly);
+
+// Interval acquisition needs: the shortest current channel interval
+int adaptive_acquisition_interval_ms(const adaptive_rate_t* rate);
+
+// Print current and fastest interval, kept fraction and rate changes per channel
+void print_adaptive_summary(const adaptive_rate_t* rate, const sensor_type_t* types);
+
+#endif // ADAPTIVE_RATE_H
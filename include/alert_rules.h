@@ -0,0 +1,180 @@
+#ifndef ALERT_RULES_H
+#define ALERT_RULES_H
+
+#include "sensor_simulator.h"
+#include "data_analyzer.h"
+#include <stdint.h>
+#include <pthread.h>
+
+#define ALERT_MAX_RULES 16384
+#define ALERT_MAX_PROGRAM 32          // Instructions per compiled rule
+#define ALERT_STACK_DEPTH 16
+#define ALERT_DEFAULT_WINDOW 100      // Samples for mean, rms and peak
+#define ALERT_MAX_WINDOW 65536
+#define ALERT_RECENT_HITS 64
+
+// Per-channel input of a condition, computed once per sample however many
+// conditions use it
+typedef enum {
+    ALERT_SIGNAL_VALUE,   // CHAN
+    ALERT_SIGNAL_ABS,     // abs(CHAN)
+    ALERT_SIGNAL_RATE,    // rate(CHAN): change per second since the previous sample
+    ALERT_SIGNAL_MEAN,    // mean(CHAN[, n]): exponentially weighted over n samples
+    ALERT_SIGNAL_RMS,     // rms(CHAN[, n]): exponentially weighted over n samples
+    ALERT_SIGNAL_PEAK     // peak(CHAN[, n]): largest |value| of the last n samples
+} alert_signal_kind_t;
+
+typedef enum {
+    ALERT_OP_GT,
+    ALERT_OP_GE,
+    ALERT_OP_LT,
+    ALERT_OP_LE
+} alert_compare_t;
+
+typedef enum {
+    ALERT_INFO,
+    ALERT_WARNING,
+    ALERT_CRITICAL
+} alert_severity_t;
+
+// Rule program instructions: the opcode sits in the top two bits and the
+// operand (condition index) in the rest
+#define ALERT_INSN_COND 0u
+#define ALERT_INSN_AND  1u
+#define ALERT_INSN_OR   2u
+#define ALERT_INSN_NOT  3u
+#define ALERT_INSN(op, operand) (((uint32_t)(op) << 30) | (uint32_t)(operand))
+
+// Sliding maximum entry for peak signals
+typedef struct {
+    double value;
+    long index;
+} alert_peak_entry_t;
+
+// Derived metric of one channel
+typedef struct {
+    alert_signal_kind_t kind;
+    sensor_type_t channel;
+    int window;
+    double value;           // Current output
+    double state;           // Previous value (rate) or weighted mean (mean, rms)
+    double alpha;
+    int64_t previous_ns;
+    long samples;
+    alert_peak_entry_t* peaks;  // Monotonic ring of window entries (peak only)
+    int peak_head;
+    int peak_count;
+} alert_signal_t;
+
+// Comparison of a signal against a constant, optionally held for a duration.
+// Identical comparisons in different rules share one entry.
+typedef struct {
+    int signal;
+    alert_compare_t op;
+    double threshold;
+    int64_t hold_ns;        // Must stay true this long (0 = immediately)
+    int64_t true_since_ns;
+    int raw;                // Comparison result at the last sample
+    int state;              // raw and held long enough
+    int evaluated;          // Seen a sample of its channel yet
+} alert_condition_t;
+
+// Compiled rule
+typedef struct {
+    char name[32];
+    char expression[160];
+    alert_severity_t severity;
+    int64_t debounce_ns;    // Minimum time between hits
+    int program_start;
+    int program_length;
+    int active;             // Expression true at the last evaluation
+    int64_t last_hit_ns;
+    long hits;
+    long suppressed;        // Rising edges inside the debounce period
+    long dirty_stamp;       // Sample that last queued the rule for evaluation
+} alert_rule_t;
+
+// Debounced rule hit
+typedef struct {
+    int rule;
+    alert_severity_t severity;
+    sensor_type_t channel;  // Channel whose sample completed the rule
+    double value;
+    int64_t timestamp_ns;
+} alert_hit_t;
+
+// Called for every hit on the evaluating thread (keep it short)
+typedef void (*alert_hit_handler_t)(void* context, const alert_rule_t* rule, const alert_hit_t* hit);
+
+// Limits the rules file may set for the built-in analysis
+typedef struct {
+    bridge_safety_limits_t bridge;
+    double absolute_threshold;
+} alert_limits_t;
+
+// Rules compiled into flat tables. A sample of channel c updates the signals
+// listed in channel_signals[signal_start[c] .. signal_start[c + 1]) and the
+// conditions indexed the same way. A rule's result only changes when one of
+// its conditions does, so only the rules listed for conditions that changed
+// (condition_rules[rule_start[i] .. rule_start[i + 1])) are run again.
+typedef struct {
+    alert_signal_t* signals;
+    int signal_count;
+    alert_condition_t* conditions;
+    int condition_count;
+    alert_rule_t* rules;
+    int rule_count;
+    uint32_t* program;
+    int program_length;
+
+    int* channel_signals;
+    int signal_start[SENSOR_TYPE_COUNT + 1];
+    int* channel_conditions;
+    int condition_start[SENSOR_TYPE_COUNT + 1];
+    int* condition_rules;
+    int* rule_start;        // condition_count + 1 entries
+    int* dirty_rules;       // Rules to run for the current sample
+    long dirty_stamp;
+
+    alert_limits_t limits;
+    alert_hit_handler_t handler;
+    void* handler_context;
+
+    alert_hit_t recent[ALERT_RECENT_HITS];
+    int recent_next;
+    long total_hits;
+    long samples_evaluated;
+    int64_t evaluate_ns;    // Time spent in evaluate_alert_frame
+    pthread_mutex_t lock;
+} alert_engine_t;
+
+// Load and compile a rules file. Sections:
+//   [limits]       bridge_rms_warning, bridge_rms_critical, bridge_peak_warning,
+//                  bridge_peak_critical, absolute_threshold (each warning
+//                  below its critical level)
+//   [rule NAME]    when = <expression>, severity = info|warning|critical,
+//                  debounce_ms = <ms>
+// Expressions combine comparisons with and, or, not and parentheses, e.g.
+//   rms(VIB, 50) > 0.3 or (STRAIN > 150 for 2s and rate(TEMP) > 0.5)
+int load_alert_rules(const char* path, alert_engine_t* engine);
+
+// Evaluate a frame of samples in timestamp order; never allocates
+void evaluate_alert_frame(alert_engine_t* engine, const sensor_data_t* samples, int count);
+
+// Receive hits as they happen (optional)
+void set_alert_hit_handler(alert_engine_t* engine, alert_hit_handler_t handler, void* context);
+
+// Evaluate rules from the pipeline (subscriber) and serve GET /alerts on the
+// metrics server
+int attach_alert_rules(alert_engine_t* engine);
+
+// Severity name for output
+const char* alert_severity_name(alert_severity_t severity);
+
+// Print hit counts of every rule that fired and evaluation cost
+void print_alert_report(alert_engine_t* engine);
+
+// Free the compiled tables
+void cleanup_alert_rules(alert_engine_t* engine);
+
+#endif // ALERT_RULES_H
@@ -0,0 +1,21 @@
+#ifndef BUS_PUBLISHER_H
+#define BUS_PUBLISHER_H
+
+#include "sample_bus.h"
+#include "sensor_simulator.h"
+
+// Create /dev/shm/<name> with slot_count samples (rounded up to a power of
+// two) and start publishing. Publishing is a no-op until this succeeds.
+int start_sample_bus(const char* name, int slot_count);
+
+// Mark the bus closed for readers and remove it (after publishers have stopped)
+void stop_sample_bus(void);
+
+// Register a named source (pipeline or profile); returns its index.
+// Safe to call when the bus is not running.
+int register_bus_source(const char* name);
+
+// Publish samples from one source (lock-free, safe from any thread)
+void publish_bus_samples(int source, const sensor_data_t* samples, int count);
+
+#endif // BUS_PUBLISHER_H
@@ -0,0 +1,68 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include "sensor_simulator.h"
+#include "realtime.h"
+#include "overload.h"
+#include "adaptive_rate.h"
+#include "uplink.h"
+
+#define DAEMON_MAX_PROFILES 16
+#define DAEMON_MAX_CHANNELS 8
+#define DAEMON_MAX_REACTORS 8
+#define DAEMON_MAX_DEVICES 4     // Serial devices merged into one profile
+
+// Monitoring profile types
+typedef enum {
+    PROFILE_BRIDGE,
+    PROFILE_ENVIRONMENTAL,
+    PROFILE_CUSTOM
+} profile_type_t;
+
+// One monitoring pipeline (from a [profile NAME] section)
+typedef struct {
+    char name[64];
+    profile_type_t type;
+    sensor_type_t channels[DAEMON_MAX_CHANNELS];
+    int channel_count;
+    int interval_ms;
+    double threshold;            // Anomaly threshold in standard deviations
+    double absolute_threshold;   // Absolute anomaly limit (bridge: NaN = daemon-wide limit)
+    char output[256];            // Log file base name
+    char devices[DAEMON_MAX_DEVICES][256];  // Serial devices, none = simulated
+    int device_count;
+    int reorder_window_ms;       // Lateness window for merging devices by timestamp
+    int trigger_pre_ms;          // Raw history written to an event file per anomaly (0 = off)
+    int trigger_post_ms;         // Raw samples written after an anomaly
+    int log_decimation;          // Main log keeps every Nth sample per channel
+    overload_policy_t overload;  // What the log does when the writer falls behind
+    sample_priority_t priorities[SENSOR_TYPE_COUNT];    // Shedding order under overload
+    int adaptive;                // Sampling rate follows signal activity
+    adaptive_config_t adaptive_config;
+    adaptive_bounds_t adaptive_default;                 // Range of channels not listed (0 = fixed)
+    adaptive_bounds_t adaptive_bounds[SENSOR_TYPE_COUNT];   // Per channel type, 0 = default
+} profile_config_t;
+
+// Daemon configuration (from the [daemon] section and profile sections)
+typedef struct {
+    profile_config_t profiles[DAEMON_MAX_PROFILES];
+    int profile_count;
+    int reactor_count;           // Acquisition threads shared by all profiles
+    int writer_threads;          // Writer pool size shared by all loggers
+    int duration;                // Seconds, 0 = until stopped
+    double bridge_absolute_limit;    // Bridge profiles without their own absolute_threshold
+    uplink_config_t uplink;      // Store-and-forward to a collector ([uplink], no host = off)
+} daemon_config_t;
+
+// Load daemon configuration file
+int load_daemon_config(const char* path, daemon_config_t* config);
+
+// Print loaded configuration
+void print_daemon_config(const daemon_config_t* config);
+
+// Run all profiles concurrently until *running is cleared or duration expires.
+// Acquisition wakeup latency is merged into rt_report when it is non-NULL.
+int run_daemon(const daemon_config_t* config, const realtime_config_t* rt_config,
+               volatile int* running, realtime_report_t* rt_report);
+
+#endif // DAEMON_H
@@ -2,6 +2,11 @@
 #define DATA_ANALYZER_H
 
 #include "sensor_simulator.h"
+#include "scratch_arena.h"
+
+#define ANALYSIS_PERSISTENT_BYTES (16 * 1024)
+#define ANALYSIS_SCRATCH_BYTES (64 * 1024)
+#define ANALYSIS_PARALLEL_GRAIN 4096    // Samples per task when analysis runs on the task pool
 
 // Statistical data structure
 typedef struct {
@@ -11,7 +16,7 @@ typedef struct {
     double std_deviation;
     double variance;
     double median;
-    int sample_count;
+    long sample_count;
     double sum;
     double sum_squares;
 } statistics_t;
@@ -23,8 +28,19 @@ typedef struct {
     int current_index;
     int sample_count;
     double sum;
+    int owns_buffer;        // 0 when the buffer belongs to an analysis context
 } moving_average_t;
 
+// Memory of one analysis thread. Filters and windows set up once live in the
+// persistent arena until the context is cleaned up; temporaries come from the
+// scratch arena, which begin_analysis_cycle empties. After the first cycle of
+// a periodic analysis no heap allocation happens.
+typedef struct {
+    scratch_arena_t persistent;
+    scratch_arena_t scratch;
+    long cycles;
+} analysis_context_t;
+
 // Anomaly detection configuration
 typedef struct {
     double threshold_multiplier;  // Multiplier for standard deviation threshold
@@ -38,7 +54,7 @@ typedef struct {
     int is_anomaly;
     double severity;  // How far from normal (in standard deviations)
     char description[128];
-    precise_time_t detected_at;
+    timestamp_ns_t detected_at;
 } anomaly_result_t;
 
 // Trend analysis result
@@ -58,9 +74,24 @@ void update_statistics(statistics_t* stats, double value);
 // Calculate final statistics (call after all data points added)
 void finalize_statistics(statistics_t* stats);
 
+// Initialize analysis context (scratch_bytes 0 = ANALYSIS_SCRATCH_BYTES)
+int init_analysis_context(analysis_context_t* context, size_t scratch_bytes);
+
+// Release the previous cycle's temporaries
+void begin_analysis_cycle(analysis_context_t* context);
+
+// Free both arenas (filters and windows from the context become invalid)
+void cleanup_analysis_context(analysis_context_t* context);
+
+// Context of the calling thread, created on first use and freed at thread exit
+analysis_context_t* thread_analysis_context(void);
+
 // Initialize moving average filter
 int init_moving_average(moving_average_t* ma, int window_size);
 
+// Initialize moving average filter with its buffer in a context's persistent arena
+int init_moving_average_in(moving_average_t* ma, int window_size, analysis_context_t* context);
+
 // Add value to moving average and get current average
 double update_moving_average(moving_average_t* ma, double value);
 
@@ -74,7 +105,7 @@ void cleanup_moving_average(moving_average_t* ma);
 anomaly_result_t detect_anomaly(const sensor_data_t* data, const statistics_t* baseline_stats, 
                                const anomaly_config_t* config);
 
-// Detect anomalies in a data array
+// Detect anomalies in a data array (split across the task pool when it runs)
 int detect_anomalies_batch(const sensor_data_t* data_array, int count, 
                           const anomaly_config_t* config, anomaly_result_t* results);
 
@@ -84,7 +115,7 @@ trend_analysis_t analyze_trend(const sensor_data_t* data_array, int count, int w
 // Rate of change calculation
 double calculate_rate_of_change(const sensor_data_t* data_array, int count, int window_size);
 
-// FFT analysis for vibration data (simplified)
+// FFT analysis for vibration data (simplified; large inputs use the task pool)
 int analyze_frequency_spectrum(const double* values, int count, double* dominant_frequency, 
                               double* amplitude);
 
@@ -99,6 +130,75 @@ typedef struct {
 
 bridge_analysis_t analyze_bridge_vibration(const sensor_data_t* vibration_data, int count);
 
+// Bridge vibration analysis with temporaries from the context's scratch arena
+bridge_analysis_t analyze_bridge_vibration_in(analysis_context_t* context,
+                                              const sensor_data_t* vibration_data, int count);
+
+// Bridge safety classification limits (m/s²); below both warning limits is
+// safe, below both critical limits is a warning, anything else is critical
+typedef struct {
+    double rms_warning;
+    double rms_critical;
+    double peak_warning;
+    double peak_critical;
+} bridge_safety_limits_t;
+
+#define BRIDGE_DEFAULT_RMS_WARNING 0.1
+#define BRIDGE_DEFAULT_RMS_CRITICAL 0.3
+#define BRIDGE_DEFAULT_PEAK_WARNING 0.3
+#define BRIDGE_DEFAULT_PEAK_CRITICAL 0.8
+#define BRIDGE_DEFAULT_ABSOLUTE_LIMIT 1.0   // Absolute anomaly limit for vibration
+
+// Replace the limits used by analyze_bridge_vibration and finalize_bridge_accumulator
+void set_bridge_safety_limits(const bridge_safety_limits_t* limits);
+
+// Limits currently in use
+bridge_safety_limits_t get_bridge_safety_limits(void);
+
+// Streaming bridge vibration accumulator (constant memory for any run length)
+typedef struct {
+    long count;
+    double sum_squares;
+    double peak_amplitude;
+    long peak_count;
+    double prev_value;       // Most recent value
+    double prev_prev_value;  // Value before that
+} bridge_accumulator_t;
+
+// Initialize streaming bridge accumulator
+void init_bridge_accumulator(bridge_accumulator_t* acc);
+
+// Add vibration sample to accumulator
+void update_bridge_accumulator(bridge_accumulator_t* acc, double value);
+
+// Produce the same result analyze_bridge_vibration would give over all samples
+bridge_analysis_t finalize_bridge_accumulator(const bridge_accumulator_t* acc);
+
+// Fixed-size window of the most recent samples.
+// Every sample is written twice so the window is always contiguous in memory.
+typedef struct {
+    sensor_data_t* samples;  // 2 * capacity entries
+    int capacity;
+    int head;                // Next write position in [0, capacity)
+    int count;
+    int owns_samples;        // 0 when the samples belong to an analysis context
+} sample_window_t;
+
+// Initialize sample window
+int init_sample_window(sample_window_t* window, int capacity);
+
+// Initialize sample window with its samples in a context's persistent arena
+int init_sample_window_in(sample_window_t* window, int capacity, analysis_context_t* context);
+
+// Append sample, overwriting the oldest when full
+void push_sample_window(sample_window_t* window, const sensor_data_t* sample);
+
+// Contiguous view of the window, oldest first (window->count entries)
+const sensor_data_t* sample_window_data(const sample_window_t* window);
+
+// Cleanup sample window
+void cleanup_sample_window(sample_window_t* window);
+
 // Print analysis results
 void print_statistics(const statistics_t* stats, const char* sensor_name);
 void print_anomaly_result(const anomaly_result_t* result);
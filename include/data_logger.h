@@ -2,11 +2,19 @@
 #define DATA_LOGGER_H
 
 #include "sensor_simulator.h"
+#include "sample_batch.h"
+#include "overload.h"
 #include <stdio.h>
+#include <pthread.h>
+
+struct writer_pool;
+
+#define LOGGER_MAX_BATCH_REFS 16     // Batches held by reference per flush
+#define LOGGER_MAX_SEGMENT_SEQUENCE 9999   // Segments per name stamp
 
 // Logger configuration
 typedef struct {
-    char filename[256];
+    char filename[256];          // Base name of the log segments
     char directory[256];
     int max_file_size_mb;
     int auto_rotate;
@@ -19,11 +27,42 @@ typedef struct {
     FILE* file;
     logger_config_t config;
     char current_filename[512];
+    char segment_stamp[16];      // UTC stamp and sequence of the newest segment name
+    int segment_sequence;
     long current_file_size;
-    int sample_count;
+    long sample_count;
     sensor_data_t* buffer;
     int buffer_index;
-    precise_time_t last_flush;
+    timestamp_ns_t last_flush;
+    
+    // Pooled batches logged by reference (log_sample_batch). The two arrays
+    // alternate like buffer and spare_buffer. Only one of buffer and the
+    // reference list holds data at a time, so records stay in order.
+    sample_batch_t* batch_refs[2][LOGGER_MAX_BATCH_REFS];
+    int active_refs;
+    int batch_ref_count;
+    int batch_ref_samples;
+    
+    // Asynchronous writing through a shared writer pool (optional).
+    // At most one batch per logger is in flight, so writes stay ordered
+    // and the file is only ever touched by one thread at a time.
+    struct writer_pool* writer_pool;
+    sensor_data_t* spare_buffer;
+    int write_pending;
+    pthread_mutex_t pending_lock;
+    pthread_cond_t pending_cond;
+    
+    // Overload handling while the previous write is still in flight (writer
+    // pool only). Instead of waiting, a full buffer sheds samples of the
+    // lowest priority present; shed samples are written as gap lines ahead
+    // of the next batch. The gap sets alternate with the buffers.
+    overload_policy_t overload_policy;
+    sample_priority_t priorities[SENSOR_TYPE_COUNT];
+    sample_gap_t gaps[2][SENSOR_TYPE_COUNT];
+    int active_gaps;
+    int gaps_pending;
+    long samples_shed;
+    long rotations_skipped;      // Rotations due while every newer segment name was taken
 } data_logger_t;
 
 // Initialize data logger
@@ -38,9 +77,34 @@ int log_sensor_data(data_logger_t* logger, const sensor_data_t* data);
 // Log multiple sensor data points
 int log_sensor_data_batch(data_logger_t* logger, const sensor_data_t* data_array, int count);
 
+// Log a pooled batch without copying; the logger holds a reference until the
+// samples are written
+int log_sample_batch(data_logger_t* logger, sample_batch_t* batch);
+
+// Choose what a full buffer does while the writer is busy; priorities holds
+// one entry per sensor type (NULL = default_sample_priority)
+void set_logger_overload_policy(data_logger_t* logger, overload_policy_t policy,
+                                const sample_priority_t* priorities);
+
 // Flush buffered data to file
 int flush_logger_buffer(data_logger_t* logger);
 
+// Write records to the current file and rotate if needed (caller owns the file)
+int write_logger_records(data_logger_t* logger, const sensor_data_t* records, int count);
+
+// Write pooled batches in order and release them (caller owns the file)
+int write_logger_batches(data_logger_t* logger, sample_batch_t* const* batches, int count);
+
+// Write one gap line per channel with shed samples and clear the set
+// (caller owns the file; the next record write flushes them)
+int write_logger_gaps(data_logger_t* logger, sample_gap_t* gaps);
+
+// Hand buffer flushes to a writer pool instead of writing on the caller's thread
+int attach_writer_pool(data_logger_t* logger, struct writer_pool* pool);
+
+// Mark an asynchronous batch as written (called by writer threads)
+void complete_logger_write(data_logger_t* logger);
+
 // Rotate log file (create new file when current gets too large)
 int rotate_log_file(data_logger_t* logger);
 
@@ -48,7 +112,7 @@ int rotate_log_file(data_logger_t* logger);
 int write_csv_header(data_logger_t* logger);
 
 // Get current log file statistics
-void get_logger_stats(data_logger_t* logger, int* sample_count, long* file_size, char* filename);
+void get_logger_stats(data_logger_t* logger, long* sample_count, long* file_size, char* filename);
 
 // Close and cleanup logger
 void cleanup_data_logger(data_logger_t* logger);
@@ -4,6 +4,8 @@
 #include "sensor_simulator.h"  // For sensor_data_t structure
 #include <termios.h>
 
+#define HARDWARE_LINE_BUFFER_SIZE 1024  // Bytes read but not yet parsed
+
 // Hardware interface configuration
 typedef struct {
     char device_path[256];
@@ -20,6 +22,13 @@ typedef struct {
     struct termios original_termios;
     hardware_config_t config;
     int is_connected;
+    int64_t byte_time_ns;       // Time on the wire per character at the configured baud
+    
+    // Batch reads: one read() and one clock read can return several lines,
+    // which stay here until parsed
+    char line_buffer[HARDWARE_LINE_BUFFER_SIZE];
+    int line_length;
+    timestamp_ns_t line_buffer_time;  // When the last buffered byte arrived
 } hardware_interface_t;
 
 // Initialize hardware interface
@@ -43,6 +52,14 @@ int check_hardware_connection(hardware_interface_t* hw);
 // Read sensor data from hardware (high-level function)
 int read_sensor_from_hardware(hardware_interface_t* hw, sensor_data_t* data);
 
+// Parse up to max_samples lines from a single read, reading the clock once.
+// Each line is timestamped back from the read time by the bytes that arrived
+// after it, or by sample_interval_ns per line when the device rate is known
+// (0 = use byte position). Lines beyond max_samples are kept for the next call.
+// Returns the number of samples parsed, or -1 on read error or timeout.
+int read_sensor_batch_from_hardware(hardware_interface_t* hw, sensor_data_t* data,
+                                    int max_samples, int64_t sample_interval_ns);
+
 // Cleanup hardware interface
 void cleanup_hardware_interface(hardware_interface_t* hw);
 
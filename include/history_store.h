@@ -0,0 +1,107 @@
+#ifndef HISTORY_STORE_H
+#define HISTORY_STORE_H
+
+#include "sensor_simulator.h"
+#include <stdint.h>
+#include <pthread.h>
+
+#define HISTORY_CHUNK_BYTES 240           // Compressed payload per chunk
+#define HISTORY_DEFAULT_HORIZON_S 600
+#define HISTORY_DEFAULT_MEMORY_MB 16
+
+// Fixed-size chunk of one channel. Timestamps are stored as delta-of-delta
+// microseconds and values as XOR against the previous value (Gorilla encoding).
+typedef struct history_chunk {
+    struct history_chunk* next;   // Next newer chunk of the channel, or next free chunk
+    int64_t first_us;
+    int64_t last_us;
+    double first_value;
+    double last_value;
+    double min;
+    double max;
+    double sum;
+    uint32_t count;
+    uint32_t bit_length;
+
+    // Encoder state, only meaningful while the chunk is the channel's newest
+    int64_t previous_delta;
+    uint64_t previous_bits;
+    uint8_t previous_leading;
+    uint8_t previous_trailing;
+
+    uint8_t data[HISTORY_CHUNK_BYTES];
+} history_chunk_t;
+
+// Chunk list of one channel, oldest to newest
+typedef struct {
+    history_chunk_t* oldest;
+    history_chunk_t* newest;      // Open chunk receiving appends
+    long chunk_count;
+    long sample_count;
+} history_channel_t;
+
+// Recent history of every channel (sensor type) in a bounded chunk pool
+typedef struct {
+    history_channel_t channels[SENSOR_TYPE_COUNT];
+    history_chunk_t* chunks;      // Preallocated pool; never grows
+    history_chunk_t* free_chunks;
+    int chunk_total;
+    int chunks_used;
+    int64_t horizon_us;
+    long samples_stored;
+    long chunks_evicted;
+    long samples_evicted;
+    pthread_mutex_t lock;
+} history_store_t;
+
+// One stored sample
+typedef struct {
+    int64_t timestamp_ns;
+    double value;
+} history_point_t;
+
+// Aggregate over a time range
+typedef struct {
+    long count;
+    double min;
+    double max;
+    double mean;
+    double first;
+    double last;
+    int64_t first_ns;
+    int64_t last_ns;
+} history_aggregate_t;
+
+// Called for each sample of a range scan, in timestamp order
+typedef void (*history_visitor_t)(void* context, int64_t timestamp_ns, double value);
+
+// Keep horizon_seconds per channel within memory_mb of chunks
+int init_history_store(history_store_t* store, int horizon_seconds, int memory_mb);
+
+// Append one sample (timestamps per channel are expected in order)
+int append_history_sample(history_store_t* store, const sensor_data_t* sample);
+
+// Visit samples of a channel with from_ns <= timestamp <= to_ns; returns the count
+long scan_history_range(history_store_t* store, sensor_type_t type, int64_t from_ns, int64_t to_ns,
+                        history_visitor_t visitor, void* context);
+
+// Copy up to max_points samples of a range; returns the number copied
+int query_history_range(history_store_t* store, sensor_type_t type, int64_t from_ns, int64_t to_ns,
+                        history_point_t* points, int max_points);
+
+// Count, min, max, mean, first and last over a range. Whole chunks are answered
+// from their summaries; only chunks at the range edges are decoded.
+int query_history_aggregate(history_store_t* store, sensor_type_t type, int64_t from_ns, int64_t to_ns,
+                            history_aggregate_t* aggregate);
+
+// Feed the store from the pipeline (subscriber) and serve GET /history on the
+// metrics server: ?channel=VIB&seconds=600&points=500
+int attach_history_store(history_store_t* store);
+
+// Print memory use, compression and per-channel coverage
+void print_history_summary(history_store_t* store);
+
+// Free the chunk pool
+void cleanup_history_store(history_store_t* store);
+
+#endif // HISTORY_STORE_H
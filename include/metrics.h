@@ -0,0 +1,75 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#define METRICS_MAX_METRICS 64
+#define METRICS_SHARDS 8              // Per-thread shards for counters and histograms
+#define METRICS_HISTOGRAM_BUCKETS 16  // Upper bounds 1us, 2.5us, 5us ... 10s
+#define METRICS_CACHE_LINE 64
+#define METRICS_MAX_ROUTES 8              // Extra HTTP paths served next to /metrics
+#define METRICS_CLIENT_TIMEOUT_MS 1000    // A silent or stalled client is dropped after this
+
+// Counter shard padded to its own cache line
+typedef struct {
+    atomic_long value;
+    char padding[METRICS_CACHE_LINE - sizeof(atomic_long)];
+} metrics_shard_t;
+
+// Monotonic counter, sharded so concurrent threads never share a cache line
+typedef struct {
+    metrics_shard_t shards[METRICS_SHARDS];
+} metrics_counter_t;
+
+// Point-in-time value
+typedef struct {
+    _Atomic int64_t value;
+} metrics_gauge_t;
+
+// Latency histogram shard (bucket counts plus sum in nanoseconds)
+typedef struct {
+    atomic_long buckets[METRICS_HISTOGRAM_BUCKETS + 1];  // Last bucket is +Inf
+    atomic_long sum_ns;
+    char padding[METRICS_CACHE_LINE];
+} metrics_histogram_shard_t;
+
+// Latency histogram in seconds
+typedef struct {
+    metrics_histogram_shard_t shards[METRICS_SHARDS];
+} metrics_histogram_t;
+
+// Register metrics (idempotent by name). Returns NULL when the registry is full;
+// all update functions accept NULL so callers never need to check.
+metrics_counter_t* register_counter(const char* name, const char* help);
+metrics_gauge_t* register_gauge(const char* name, const char* help);
+metrics_histogram_t* register_histogram(const char* name, const char* help);
+
+// Hot-path updates (lock-free, relaxed atomics on the calling thread's shard)
+void counter_add(metrics_counter_t* counter, long amount);
+void gauge_set(metrics_gauge_t* gauge, int64_t value);
+void gauge_add(metrics_gauge_t* gauge, int64_t amount);
+void histogram_observe_ns(metrics_histogram_t* histogram, long nanoseconds);
+
+// Monotonic nanosecond clock for latency measurements
+int64_t metrics_now_ns(void);
+
+// Write all metrics in Prometheus text exposition format
+int write_metrics(FILE* out);
+
+// Writes the response body for an extra HTTP path; query is the text after '?' ("" if none)
+typedef void (*http_route_handler_t)(FILE* out, const char* query, void* context);
+
+// Serve handler for GET <path> on the metrics server
+int register_http_route(const char* path, const char* content_type,
+                        http_route_handler_t handler, void* context);
+
+// Serve metrics over HTTP on 127.0.0.1:port from a background thread
+int start_metrics_server(int port);
+
+// Stop the metrics HTTP server
+void stop_metrics_server(void);
+
+#endif // METRICS_H
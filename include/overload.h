@@ -0,0 +1,44 @@
+#ifndef OVERLOAD_H
+#define OVERLOAD_H
+
+#include "sensor_simulator.h"
+
+// What a pipeline queue does when its consumer cannot keep up
+typedef enum {
+    OVERLOAD_BLOCK,             // Wait for the consumer; nothing is lost
+    OVERLOAD_DROP_OLDEST,       // Discard the oldest queued samples
+    OVERLOAD_DROP_NEWEST,       // Discard arriving samples
+    OVERLOAD_DECIMATE           // Thin queued samples to every other one
+} overload_policy_t;
+
+// Shedding order under overload: low first, then normal. Critical samples are
+// never shed; a queue holding only critical samples waits instead.
+typedef enum {
+    SAMPLE_PRIORITY_LOW,
+    SAMPLE_PRIORITY_NORMAL,
+    SAMPLE_PRIORITY_CRITICAL
+} sample_priority_t;
+
+// Samples of one channel shed since the last write
+typedef struct {
+    long dropped;
+    timestamp_ns_t first;
+    timestamp_ns_t last;
+} sample_gap_t;
+
+// Look up a policy by name (block, drop_oldest, drop_newest, decimate)
+int parse_overload_policy(const char* name, overload_policy_t* policy);
+
+// Config name of a policy
+const char* overload_policy_name(overload_policy_t policy);
+
+// Look up a priority by name (low, normal, critical)
+int parse_sample_priority(const char* name, sample_priority_t* priority);
+
+// Structural channels are critical, environmental channels low
+sample_priority_t default_sample_priority(sensor_type_t type);
+
+// Count a shed sample in its channel's gap
+void record_sample_gap(sample_gap_t* gap, const sensor_data_t* sample);
+
+#endif // OVERLOAD_H
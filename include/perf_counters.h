@@ -0,0 +1,46 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdint.h>
+
+// Hardware events collected through perf_event_open
+typedef enum {
+    PERF_COUNTER_CYCLES,
+    PERF_COUNTER_INSTRUCTIONS,
+    PERF_COUNTER_CACHE_MISSES,
+    PERF_COUNTER_BRANCH_MISSES,
+    PERF_COUNTER_COUNT
+} perf_counter_t;
+
+// Counter group for the calling thread (user-space events only)
+typedef struct {
+    int fds[PERF_COUNTER_COUNT];        // -1 when the event is unavailable
+    uint64_t ids[PERF_COUNTER_COUNT];
+    int group_fd;                       // First event that opened; -1 if none did
+} perf_counters_t;
+
+// One reading; values are scaled when the kernel multiplexed the group
+typedef struct {
+    uint64_t values[PERF_COUNTER_COUNT];
+    int valid[PERF_COUNTER_COUNT];
+} perf_reading_t;
+
+// Open counters for the calling thread; returns the number of events available (0 = none)
+int open_perf_counters(perf_counters_t* counters);
+
+// Reset and start counting
+void start_perf_counters(perf_counters_t* counters);
+
+// Stop counting
+void stop_perf_counters(perf_counters_t* counters);
+
+// Read current values with one system call
+int read_perf_counters(const perf_counters_t* counters, perf_reading_t* reading);
+
+// Close all counters
+void close_perf_counters(perf_counters_t* counters);
+
+// Event name for reports
+const char* perf_counter_name(perf_counter_t counter);
+
+#endif // PERF_COUNTERS_H
@@ -0,0 +1,80 @@
+#ifndef REALTIME_H
+#define REALTIME_H
+
+#include <stddef.h>
+#include <time.h>
+#include "utils.h"
+
+// Number of log2 buckets in the wakeup latency histogram (1us .. ~1s)
+#define REALTIME_LATENCY_BUCKETS 21
+
+// Real-time execution configuration
+typedef struct {
+    int enabled;
+    int priority;            // SCHED_FIFO priority for acquisition (1-99)
+    int acquisition_cpu;     // CPU to pin acquisition thread to (-1 = no pinning)
+    int writer_cpu;          // CPU to pin writer threads to (-1 = no pinning)
+    int lock_memory;         // Lock current and future pages with mlockall
+    size_t stack_prefault_kb; // Stack depth to prefault
+} realtime_config_t;
+
+// What real-time mode actually achieved, plus wakeup latency
+typedef struct {
+    int memory_locked;
+    int priority_set;
+    int cpu_pinned;
+    long wakeup_count;
+    long overrun_count;      // Wakeups later than a full period
+    double min_latency_us;
+    double max_latency_us;
+    double sum_latency_us;
+    long latency_buckets[REALTIME_LATENCY_BUCKETS];
+} realtime_report_t;
+
+// Periodic timer with absolute deadlines on CLOCK_MONOTONIC
+typedef struct {
+    timestamp_ns_t next_deadline;
+    int64_t period_ns;
+} realtime_timer_t;
+
+// Initialize configuration with defaults (disabled)
+void init_realtime_config(realtime_config_t* config);
+
+// Initialize an empty report
+void init_realtime_report(realtime_report_t* report);
+
+// Enable real-time mode for the calling (acquisition) thread.
+// Each step degrades gracefully with a warning when privileges are missing.
+// Returns the number of steps that failed (0 = everything applied).
+int enable_realtime_mode(const realtime_config_t* config, realtime_report_t* report);
+
+// Pin the calling thread to a CPU (-1 = leave unpinned)
+int pin_current_thread_to_cpu(int cpu);
+
+// Let the calling thread run on every online CPU again, under SCHED_OTHER
+// (for helper threads created by a pinned real-time thread)
+int reset_current_thread_affinity(void);
+
+// Run the calling thread under SCHED_FIFO at the given priority
+int set_current_thread_realtime_priority(int priority);
+
+// Touch every page of a buffer so it is resident before the hot loop
+void prefault_memory(void* buffer, size_t size);
+
+// Periodic timer for the acquisition loop
+void init_realtime_timer(realtime_timer_t* timer, int interval_ms);
+
+// Sleep until the next period and record the wakeup latency
+void wait_next_period(realtime_timer_t* timer, realtime_report_t* report);
+
+// Sleep until an absolute CLOCK_MONOTONIC deadline and record the wakeup latency.
+// period_ns is used to classify overruns.
+void wait_until_deadline(timestamp_ns_t deadline, int64_t period_ns, realtime_report_t* report);
+
+// Merge one report's wakeup statistics into another
+void merge_realtime_report(realtime_report_t* into, const realtime_report_t* from);
+
+// Print achieved real-time status and latency distribution
+void print_realtime_report(const realtime_report_t* report);
+
+#endif // REALTIME_H
@@ -0,0 +1,56 @@
+#ifndef REORDER_H
+#define REORDER_H
+
+#include "sensor_simulator.h"
+#include <stdint.h>
+
+#define REORDER_MAX_STREAMS 8
+#define REORDER_DEFAULT_CAPACITY 256   // Samples buffered per stream
+
+// Per-stream buffer, kept sorted by timestamp
+typedef struct {
+    sensor_data_t* samples;   // Ring of capacity entries
+    int head;
+    int count;
+    long received;
+    long late;                // Dropped because older than the last emitted sample
+} reorder_stream_t;
+
+// K-way merge of per-device streams with a bounded lateness window. A sample is
+// emitted once it is the oldest pending one and either every stream has a
+// newer sample queued, the newest timestamp seen is more than the window ahead
+// of it, or a stream buffer is full.
+typedef struct {
+    reorder_stream_t streams[REORDER_MAX_STREAMS];
+    int stream_count;
+    int capacity;
+    int heap[REORDER_MAX_STREAMS];      // Streams with pending samples, min-heap by head timestamp
+    int heap_position[REORDER_MAX_STREAMS];
+    int heap_size;
+    int64_t window_ns;
+    int64_t newest_ns;                  // Newest timestamp received on any stream
+    int64_t last_emitted_ns;
+    int has_emitted;
+    long emitted;
+    long late;
+} reorder_buffer_t;
+
+// Initialize for stream_count streams (capacity 0 = REORDER_DEFAULT_CAPACITY)
+int init_reorder_buffer(reorder_buffer_t* buffer, int stream_count, int window_ms, int capacity);
+
+// Queue a sample from one stream. Returns 0 when queued and 1 when it arrived
+// later than an already emitted sample and was dropped. Drain the buffer with
+// pop_reorder_sample after every push.
+int push_reorder_sample(reorder_buffer_t* buffer, int stream, const sensor_data_t* sample);
+
+// Take the next sample in timestamp order if it is ready (or any pending sample
+// when force is set). Returns 1 when a sample was written to out.
+int pop_reorder_sample(reorder_buffer_t* buffer, sensor_data_t* out, int force);
+
+// Samples waiting in the buffer
+int reorder_pending(const reorder_buffer_t* buffer);
+
+// Free stream buffers
+void cleanup_reorder_buffer(reorder_buffer_t* buffer);
+
+#endif // REORDER_H
@@ -0,0 +1,51 @@
+#ifndef SAMPLE_BATCH_H
+#define SAMPLE_BATCH_H
+
+#include "sensor_simulator.h"
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define SAMPLE_BATCH_CAPACITY 32    // One acquisition of every channel of every device
+
+// Fixed-size set of samples filled once by acquisition and read in place by
+// later stages. Each stage that keeps the batch beyond its call takes a
+// reference; the last release returns it to its pool.
+typedef struct sample_batch {
+    sensor_data_t samples[SAMPLE_BATCH_CAPACITY];
+    int count;
+    atomic_int references;
+    atomic_uint next_free;              // Free-list link (index + 1, 0 = end)
+    struct sample_batch_pool* pool;
+} sample_batch_t;
+
+// Preallocated batches on a lock-free free list. The list head carries a
+// generation count next to the index so a concurrent pop and push cannot
+// mistake a reused batch for the one it read (ABA).
+typedef struct sample_batch_pool {
+    sample_batch_t* batches;
+    int batch_count;
+    _Atomic uint64_t free_head;         // generation << 32 | (index + 1)
+    atomic_long in_use;
+    atomic_long peak_in_use;
+    atomic_long exhausted;              // Acquires that found no free batch
+} sample_batch_pool_t;
+
+// Allocate batch_count batches, all free
+int init_sample_batch_pool(sample_batch_pool_t* pool, int batch_count);
+
+// Take a free batch with one reference and no samples; NULL when none is free
+sample_batch_t* acquire_sample_batch(sample_batch_pool_t* pool);
+
+// Add a reference for a stage that keeps the batch
+void retain_sample_batch(sample_batch_t* batch);
+
+// Drop a reference; the last one returns the batch to its pool
+void release_sample_batch(sample_batch_t* batch);
+
+// Print batches in use, peak and exhaustion
+void print_sample_batch_report(const sample_batch_pool_t* pool);
+
+// Free the batches (every batch must have been released)
+void cleanup_sample_batch_pool(sample_batch_pool_t* pool);
+
+#endif // SAMPLE_BATCH_H
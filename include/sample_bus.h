@@ -0,0 +1,80 @@
+#ifndef SAMPLE_BUS_H
+#define SAMPLE_BUS_H
+
+// Shared-memory live sample bus: memory layout and client library.
+// This header and src/sample_bus.c depend only on libc so local consumers can
+// link libsamplebus.a without the rest of the logger.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#define SAMPLE_BUS_MAGIC 0x53425553u      // "SBUS"
+#define SAMPLE_BUS_VERSION 1
+#define SAMPLE_BUS_DEFAULT_SLOTS 65536    // Ring size in samples (power of two)
+#define SAMPLE_BUS_MAX_SOURCES 16
+#define SAMPLE_BUS_NAME_LENGTH 32
+
+// Compact sample as published on the bus (24 bytes)
+typedef struct {
+    int64_t timestamp_ns;     // Wall-clock nanoseconds since the epoch
+    double value;
+    uint16_t source;          // Index into the header's source names
+    uint16_t type;            // sensor_type_t
+    uint32_t reserved;
+} bus_sample_t;
+
+// Ring slot. The sequence is 2n+1 while sample n is being written and 2n+2
+// once it is complete, so readers detect torn or overwritten slots.
+typedef struct {
+    _Atomic uint64_t sequence;
+    bus_sample_t sample;
+} bus_slot_t;
+
+// Segment header, followed by the slot array at slots_offset
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_size;
+    uint64_t slots_offset;
+    int64_t start_time_ns;    // Wall-clock nanoseconds when the publisher started
+    int32_t publisher_pid;
+    _Atomic uint32_t source_count;
+    _Atomic uint32_t closed;  // Set when the publisher stops
+    char source_names[SAMPLE_BUS_MAX_SOURCES][SAMPLE_BUS_NAME_LENGTH];
+    char padding[64];
+    _Atomic uint64_t write_sequence;  // Samples reserved so far (own cache line)
+} sample_bus_header_t;
+
+// Read-only view of a bus held by one consumer
+typedef struct {
+    int fd;
+    void* map;
+    size_t map_size;
+    const sample_bus_header_t* header;
+    const bus_slot_t* slots;
+    uint64_t mask;
+    uint64_t next_sequence;   // Next sample this reader expects
+    uint64_t lost;            // Samples overwritten before they were read
+} sample_bus_reader_t;
+
+// Map the bus /dev/shm/<name>. Starts at the newest sample, or at the oldest
+// one still in the ring when from_oldest is set.
+int open_sample_bus(sample_bus_reader_t* reader, const char* name, int from_oldest);
+
+// Copy up to max_samples new samples without blocking. Returns the number
+// copied, or -1 once the publisher has stopped and everything was read.
+// Overruns skip ahead to live data and are added to reader->lost.
+int read_sample_bus(sample_bus_reader_t* reader, bus_sample_t* samples, int max_samples);
+
+// Poll until a new sample is available; returns 1 when one is, 0 on timeout
+int wait_sample_bus(sample_bus_reader_t* reader, int timeout_ms);
+
+// Name registered by the publisher for a source index ("" if unknown)
+const char* sample_bus_source_name(const sample_bus_reader_t* reader, int source);
+
+// Unmap the bus
+void close_sample_bus(sample_bus_reader_t* reader);
+
+#endif // SAMPLE_BUS_H
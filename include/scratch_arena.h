@@ -0,0 +1,49 @@
+#ifndef SCRATCH_ARENA_H
+#define SCRATCH_ARENA_H
+
+#include <stddef.h>
+
+#define SCRATCH_ALIGNMENT 16
+
+struct scratch_overflow;
+
+// Bump allocator for short-lived analysis buffers. Allocations are carved from
+// one block and released all at once. A request that does not fit goes to a
+// separate heap block; once the arena is empty again the main block grows to
+// the largest demand seen, so a repeating workload stops touching the heap
+// after its first cycle.
+typedef struct {
+    unsigned char* base;
+    size_t capacity;
+    size_t used;
+    struct scratch_overflow* overflow;  // Heap blocks for requests that did not fit
+    size_t overflow_bytes;
+    size_t peak;                        // Largest used + overflow_bytes so far
+    long heap_allocations;              // Block allocations, including growth
+} scratch_arena_t;
+
+// Position to return to with release_scratch_arena
+typedef struct {
+    size_t used;
+    struct scratch_overflow* overflow;
+} scratch_mark_t;
+
+// Allocate the initial block (0 bytes is allowed; the arena grows on demand)
+int init_scratch_arena(scratch_arena_t* arena, size_t capacity);
+
+// Aligned allocation valid until the arena is released past it or reset
+void* scratch_alloc(scratch_arena_t* arena, size_t size);
+
+// Current position, for nested use of one arena
+scratch_mark_t mark_scratch_arena(const scratch_arena_t* arena);
+
+// Free everything allocated since the mark
+void release_scratch_arena(scratch_arena_t* arena, scratch_mark_t mark);
+
+// Free everything
+void reset_scratch_arena(scratch_arena_t* arena);
+
+// Free the block and any overflow
+void cleanup_scratch_arena(scratch_arena_t* arena);
+
+#endif // SCRATCH_ARENA_H
@@ -15,11 +15,13 @@ typedef enum {
     SENSOR_ACCELEROMETER_Z
 } sensor_type_t;
 
+#define SENSOR_TYPE_COUNT 8
+
 // Sensor data structure
 typedef struct {
     sensor_type_t type;
     double value;
-    precise_time_t timestamp;
+    timestamp_ns_t timestamp;     // Monotonic nanoseconds (utils.h)
     char unit[16];
     char description[64];
 } sensor_data_t;
@@ -44,12 +46,19 @@ void configure_sensor(sensor_type_t type, sensor_config_t config);
 // Generate simulated sensor data
 sensor_data_t generate_sensor_data(sensor_type_t type);
 
+// Generate simulated sensor data stamped with a time the caller read once
+// for the whole acquisition batch
+sensor_data_t generate_sensor_data_at(sensor_type_t type, timestamp_ns_t timestamp);
+
 // Generate bridge vibration data (specialized for structural monitoring)
 sensor_data_t generate_bridge_vibration_data(void);
 
 // Generate environmental data set (temperature, humidity, pressure)
 void generate_environmental_data_set(sensor_data_t* data_array, int* count);
 
+// Look up sensor type by protocol name (TEMP, VIB, STRAIN, HUM, PRESS, ACCEL_X/Y/Z)
+int sensor_type_from_name(const char* name, sensor_type_t* type);
+
 // Cleanup simulator resources
 void cleanup_sensor_simulator(void);
 
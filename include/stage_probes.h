@@ -0,0 +1,95 @@
+#ifndef STAGE_PROBES_H
+#define STAGE_PROBES_H
+
+#include <stdint.h>
+#include "perf_counters.h"
+
+// Pipeline stages measured by the probes
+typedef enum {
+    STAGE_ACQUISITION,        // Reading or generating one sample set
+    STAGE_PARSE,              // parse_hardware_data
+    STAGE_UPDATE_STATISTICS,  // update_statistics
+    STAGE_DETECT_ANOMALY,     // detect_anomaly
+    STAGE_LOG_SAMPLE,         // log_sensor_data (includes flush when triggered)
+    STAGE_FLUSH,              // flush_logger_buffer (hand-off only with a writer pool)
+    STAGE_WRITE,              // write_logger_records (formatting and file I/O)
+    STAGE_COUNT
+} probe_stage_t;
+
+// Latency summary for one stage, in nanoseconds
+typedef struct {
+    long count;
+    double min_ns;
+    double mean_ns;
+    double p50_ns;
+    double p90_ns;
+    double p99_ns;
+    double p999_ns;
+    double max_ns;
+} stage_latency_t;
+
+// Start of a measured interval
+typedef struct {
+    uint64_t ticks;
+    perf_reading_t counters;  // Only read when stage perf counters are enabled
+} probe_point_t;
+
+// Hardware counter totals for one stage
+typedef struct {
+    long count;               // Intervals with counter readings
+    double per_call[PERF_COUNTER_COUNT];
+    int valid[PERF_COUNTER_COUNT];
+    double ipc;               // 0 when cycles or instructions are unavailable
+} stage_counters_t;
+
+// Probes compile to nothing unless built with -DENABLE_STAGE_PROBES (make probes)
+#ifdef ENABLE_STAGE_PROBES
+#define PROBE_BEGIN(name) probe_point_t name; probe_begin(&name)
+#define PROBE_END(stage, name) probe_end((stage), &name)
+#else
+#define PROBE_BEGIN(name) do { } while (0)
+#define PROBE_END(stage, name) do { } while (0)
+#endif
+
+// Calibrate the clock and clear all recorded latencies (call once before sampling)
+void init_stage_probes(void);
+
+// Select the clock and calibrate the TSC once per process (also used by tracing)
+void init_probe_clock(void);
+
+// Name of the clock source in use ("tsc" or "clock_monotonic")
+const char* probe_clock_source(void);
+
+// Current tick count (TSC cycles or nanoseconds)
+uint64_t probe_ticks(void);
+
+// Record a duration in ticks for a stage (lock-free)
+void probe_record(probe_stage_t stage, uint64_t ticks);
+
+// Mark the start and end of a measured interval (used by the macros)
+void probe_begin(probe_point_t* point);
+void probe_end(probe_stage_t stage, const probe_point_t* point);
+
+// Also collect hardware counters per stage. Each probe then costs two extra
+// read() calls; returns -1 when perf events are unavailable.
+int enable_stage_perf_counters(void);
+
+// Hardware counter summary for a stage; returns -1 if none were recorded
+int get_stage_counters(probe_stage_t stage, stage_counters_t* counters);
+
+// Convert ticks to nanoseconds
+double probe_ticks_to_ns(uint64_t ticks);
+
+// Stage name for reports
+const char* probe_stage_name(probe_stage_t stage);
+
+// Latency summary for a stage; returns -1 if nothing was recorded
+int get_stage_latency(probe_stage_t stage, stage_latency_t* latency);
+
+// Clear all recorded latencies
+void reset_stage_probes(void);
+
+// Print per-stage latency table
+void print_stage_latency_table(void);
+
+#endif // STAGE_PROBES_H
@@ -0,0 +1,70 @@
+#ifndef STATUS_RENDERER_H
+#define STATUS_RENDERER_H
+
+#include "data_analyzer.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#define STATUS_MAX_FIELDS 8
+#define STATUS_ANOMALY_QUEUE_SIZE 64  // Must be a power of two
+#define STATUS_DEFAULT_REFRESH_HZ 10
+
+// A value shown on the status line
+typedef struct {
+    char label[32];
+    char unit[16];
+    int precision;
+    _Atomic uint64_t value_bits;  // double stored as raw bits
+} status_field_t;
+
+// Status renderer state.
+// The sampling loop only performs relaxed atomic stores and a lock-free
+// queue push; all formatting and console I/O happen on the renderer thread.
+typedef struct {
+    status_field_t fields[STATUS_MAX_FIELDS];
+    int field_count;
+    int refresh_hz;
+    int headless;                // Anomaly reports only, no status line
+    char prefix[64];             // Printed before each anomaly report
+
+    atomic_long sample_count;
+    atomic_long anomaly_count;
+    atomic_long dropped_anomalies;
+
+    // Single-producer single-consumer anomaly queue
+    anomaly_result_t anomaly_queue[STATUS_ANOMALY_QUEUE_SIZE];
+    atomic_uint anomaly_head;  // Next slot to write (producer)
+    atomic_uint anomaly_tail;  // Next slot to read (consumer)
+
+    atomic_int running;
+    pthread_t thread;
+    int thread_started;
+} status_renderer_t;
+
+// Initialize renderer (refresh_hz <= 0 uses the default)
+void init_status_renderer(status_renderer_t* renderer, int refresh_hz);
+
+// Print only queued anomalies, each as "[prefix] report" (for headless runs,
+// where several renderers may share the console)
+void set_status_headless(status_renderer_t* renderer, const char* prefix);
+
+// Register a field shown on the status line, returns field index or -1
+int add_status_field(status_renderer_t* renderer, const char* label, const char* unit, int precision);
+
+// Start the renderer thread
+int start_status_renderer(status_renderer_t* renderer);
+
+// Publish latest value for a field (hot path, lock-free)
+void set_status_field(status_renderer_t* renderer, int field, double value);
+
+// Count a processed sample (hot path, lock-free)
+void count_status_sample(status_renderer_t* renderer);
+
+// Queue an anomaly for printing (hot path, lock-free, drops when full)
+void post_status_anomaly(status_renderer_t* renderer, const anomaly_result_t* anomaly);
+
+// Stop the renderer thread after a final refresh
+void stop_status_renderer(status_renderer_t* renderer);
+
+#endif // STATUS_RENDERER_H
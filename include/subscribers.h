@@ -0,0 +1,66 @@
+#ifndef SUBSCRIBERS_H
+#define SUBSCRIBERS_H
+
+#include "sensor_simulator.h"
+#include "overload.h"
+#include <stdint.h>
+
+#define SUBSCRIBERS_MAX 16
+#define SUBSCRIBER_POOL_MAX_THREADS 8
+#define SUBSCRIBER_DEFAULT_QUEUE 4096    // Samples buffered per subscriber
+#define SUBSCRIBER_DEFAULT_BATCH 64      // Largest batch passed to one callback
+
+// Channel set bit for a sensor type; a mask of 0 selects every channel
+#define SUBSCRIBE_CHANNEL(type) (1u << (type))
+
+// Receives a batch of samples on a subscriber pool thread. Batches for one
+// subscriber are delivered in order and never concurrently.
+typedef void (*subscriber_callback_t)(void* context, const sensor_data_t* samples, int count);
+
+// Subscription request from an analysis module
+typedef struct {
+    const char* name;
+    uint32_t channel_mask;          // SUBSCRIBE_CHANNEL bits, 0 = all channels
+    subscriber_callback_t callback; // NULL = queue only, drained with take_subscriber_samples
+    void* context;
+    int queue_capacity;             // 0 = SUBSCRIBER_DEFAULT_QUEUE
+    int batch_size;                 // 0 = SUBSCRIBER_DEFAULT_BATCH
+    overload_policy_t overload;     // OVERLOAD_DROP_OLDEST, otherwise arriving samples are dropped
+} subscriber_config_t;
+
+// Delivery statistics for one subscriber
+typedef struct {
+    char name[32];
+    long delivered;
+    long dropped;                   // Samples discarded because the queue was full
+    long batches;
+    int queue_depth;
+    double mean_lag_ms;             // Time from dispatch to callback start
+    double max_lag_ms;
+    double mean_callback_us;
+} subscriber_stats_t;
+
+// Register a subscriber; returns its id or -1. Call before or after the pool starts.
+int subscribe_samples(const subscriber_config_t* config);
+
+// Start the worker threads that run subscriber callbacks
+int start_subscriber_pool(int thread_count);
+
+// Deliver queued samples and stop the worker threads
+void stop_subscriber_pool(void);
+
+// Queue samples for every matching subscriber. Never blocks on a slow
+// subscriber: when its queue is full the arriving samples, or with
+// OVERLOAD_DROP_OLDEST the oldest queued ones, are counted as dropped.
+void dispatch_subscriber_samples(const sensor_data_t* samples, int count);
+
+// Copy up to max_samples queued samples of a queue-only subscriber; returns the count
+int take_subscriber_samples(int id, sensor_data_t* samples, int max_samples);
+
+// Current statistics for one subscriber
+int get_subscriber_stats(int id, subscriber_stats_t* stats);
+
+// Print per-subscriber delivery and lag statistics (nothing without subscribers)
+void print_subscriber_report(void);
+
+#endif // SUBSCRIBERS_H
@@ -0,0 +1,59 @@
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#include "scratch_arena.h"
+#include <stddef.h>
+
+#define TASK_POOL_MAX_THREADS 64
+#define TASK_POOL_MAX_CHUNKS 1024       // Larger inputs get a proportionally larger grain
+#define TASK_DEQUE_CAPACITY 64          // Pending ranges per worker before splitting stops
+
+// Runs [begin, end) of a parallel_for
+typedef void (*task_range_fn)(void* context, int begin, int end);
+
+// Folds [begin, end) into a partial result that starts as the identity
+typedef void (*task_reduce_fn)(void* context, int begin, int end, void* partial);
+
+// result = result (+) partial; the identity must be neutral
+typedef void (*task_combine_fn)(void* result, const void* partial);
+
+// Reduction over an index range
+typedef struct {
+    size_t result_size;
+    const void* identity;
+    task_reduce_fn map;
+    task_combine_fn combine;
+    void* context;
+} task_reduce_t;
+
+// Work-stealing pool for analysis over large arrays. An index range is cut
+// into fixed chunks of grain indices (chunk boundaries depend only on the
+// count and the grain). Each worker splits ranges in half onto its own deque
+// and runs the lower half; idle workers steal the largest pending range from
+// the other end of someone else's deque. The calling thread takes part until
+// its range is done. Reductions combine one partial per chunk in chunk order,
+// so a result is bit-identical for any thread count, including no pool.
+
+// Start the worker threads (0 = one per online CPU besides the caller)
+int start_task_pool(int thread_count);
+
+// Stop the worker threads (no parallel call may be in progress)
+void stop_task_pool(void);
+
+// Worker threads running, 0 when parallel calls run on the caller only
+int task_pool_threads(void);
+
+// Call fn over [0, count) in chunks of grain indices, in parallel when the
+// pool is running; returns when every chunk has run
+void parallel_for(int count, int grain, task_range_fn fn, void* context);
+
+// Reduce [0, count) into result. Partials come from scratch when given
+// (released before returning) and from the heap otherwise; a single chunk
+// needs none. Returns 0 or -1 when partials cannot be allocated.
+int parallel_reduce(const task_reduce_t* reduce, int count, int grain, void* result,
+                    scratch_arena_t* scratch);
+
+// Print tasks run and stolen (nothing when the pool never started)
+void print_task_pool_report(void);
+
+#endif // TASK_POOL_H
@@ -0,0 +1,30 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+#define TRACE_MAX_THREADS 32
+#define TRACE_RING_EVENTS 65536   // Per-thread ring (power of two); oldest events are overwritten
+
+// Start tracing; events are written to filename as Chrome/Perfetto JSON
+// on SIGUSR1 and when tracing stops
+int start_tracing(const char* filename);
+
+// Write the current trace file and stop tracing
+void stop_tracing(void);
+
+// Name the calling thread in the trace viewer
+void trace_set_thread_name(const char* name);
+
+// Begin and end a span on the calling thread. Names must be string literals
+// (only the pointer is stored). Both return immediately when tracing is off.
+void trace_begin(const char* name);
+void trace_end(const char* name);
+
+// Zero-length marker on the calling thread
+void trace_instant(const char* name);
+
+// Write all buffered events now (safe while tracing is running)
+int write_trace_file(const char* filename);
+
+#endif // TRACE_H
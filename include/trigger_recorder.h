@@ -0,0 +1,106 @@
+#ifndef TRIGGER_RECORDER_H
+#define TRIGGER_RECORDER_H
+
+#include "sensor_simulator.h"
+#include <stdint.h>
+#include <pthread.h>
+
+#define TRIGGER_EVENT_SLOTS 3           // Events being captured or written at once
+#define TRIGGER_MAX_EXTENSION 4         // An event grows to at most pre + 4 * post
+#define TRIGGER_RECENT_EVENTS 16
+
+// Black-box capture settings
+typedef struct {
+    int pre_ms;                 // Raw history written before a trigger (0 = off)
+    int post_ms;                // Raw samples written after a trigger
+    int interval_ms;            // Expected sample period per channel, sizes the buffers
+    int decimation;             // Main log keeps every Nth sample per channel
+    uint32_t channel_mask;      // SUBSCRIBE_CHANNEL-style bits, 0 = all channels
+} trigger_config_t;
+
+// Most recent raw samples of one channel
+typedef struct {
+    sensor_data_t* samples;
+    int capacity;
+    int head;                   // Next write position
+    int count;
+    long decimation_counter;
+} trigger_ring_t;
+
+typedef enum {
+    TRIGGER_SLOT_FREE,
+    TRIGGER_SLOT_CAPTURING,     // Owned by the acquisition thread
+    TRIGGER_SLOT_QUEUED         // Owned by the event writer
+} trigger_slot_state_t;
+
+// One event: pre-trigger history followed by post-trigger samples
+typedef struct {
+    trigger_slot_state_t state;
+    sensor_data_t* samples;
+    int capacity;
+    int count;
+    int64_t trigger_ns;
+    int64_t end_ns;             // Capture until the first sample past this time
+    int64_t limit_ns;           // Later triggers extend end_ns up to here
+    int triggers;               // Triggers merged into this event
+    int truncated;              // Samples that did not fit
+    char reason[128];
+    long sequence;
+} trigger_event_t;
+
+// Written event, for the summary
+typedef struct {
+    char filename[320];
+    char reason[128];
+    int samples;
+    int triggers;
+} trigger_event_record_t;
+
+// Keeps a pre-trigger ring per channel and, when fire_trigger is called, writes
+// the surrounding raw samples to a separate event file from its own thread.
+// The main log meanwhile only needs every Nth sample (record_trigger_sample).
+typedef struct {
+    trigger_config_t config;
+    char base_filename[128];
+    char directory[64];
+    trigger_ring_t rings[SENSOR_TYPE_COUNT];
+    trigger_event_t events[TRIGGER_EVENT_SLOTS];
+    trigger_event_t* capturing;     // Event receiving samples, or NULL
+    long next_sequence;
+
+    pthread_t writer_thread;
+    int writer_started;
+    int running;
+    pthread_mutex_t lock;
+    pthread_cond_t queued;
+    pthread_cond_t written;
+
+    long events_written;
+    long events_dropped;            // Triggers lost because every slot was busy
+    long samples_written;
+    long samples_seen;
+    long samples_kept;              // Passed on to the decimated main log
+    trigger_event_record_t recent[TRIGGER_RECENT_EVENTS];
+} trigger_recorder_t;
+
+// Allocate rings and event buffers and start the event writer
+int init_trigger_recorder(trigger_recorder_t* recorder, const char* base_filename,
+                          const trigger_config_t* config);
+
+// Add a raw sample. Returns 1 when the decimated main log should keep it.
+int record_trigger_sample(trigger_recorder_t* recorder, const sensor_data_t* sample);
+
+// Capture around a sample that was already recorded. A trigger during an open
+// capture extends it instead of starting a new event.
+void fire_trigger(trigger_recorder_t* recorder, const sensor_data_t* sample, const char* reason);
+
+// Write any open capture and wait until every queued event file is written
+void flush_trigger_recorder(trigger_recorder_t* recorder);
+
+// Print events written, dropped and the main log reduction
+void print_trigger_summary(trigger_recorder_t* recorder);
+
+// Flush, stop the writer and free buffers
+void cleanup_trigger_recorder(trigger_recorder_t* recorder);
+
+#endif // TRIGGER_RECORDER_H
@@ -0,0 +1,77 @@
+#ifndef UPLINK_H
+#define UPLINK_H
+
+#include "uplink_protocol.h"
+#include "sensor_simulator.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define UPLINK_MAX_STREAMS 16
+#define UPLINK_RETRY_MIN_MS 500         // First reconnect delay, doubled per failure
+#define UPLINK_RETRY_MAX_MS 30000
+#define UPLINK_ACK_TIMEOUT_MS 10000     // Connection is considered lost after this
+#define UPLINK_POLL_MS 200              // Wait for new records when caught up
+
+// Where and how fast to forward
+typedef struct {
+    char host[128];
+    int port;
+    int bandwidth_kbps;          // Wire budget in kilobits per second (0 = unlimited)
+    int batch_kb;                // Records per DATA frame before compression
+    int drain_ms;                // Time to forward the tail at shutdown
+} uplink_config_t;
+
+// Forwarding position of one logger's segments
+typedef struct {
+    char name[UPLINK_MAX_NAME];     // Log base name; segments are <name>_<utc stamp>_<seq>.csv
+    char segment[UPLINK_MAX_NAME];  // Segment being forwarded ("" = start with the oldest)
+    uint64_t offset;                // Bytes of it the collector holds
+    int missing_reported;           // Warned that the collector's segment is not on disk here
+} uplink_stream_t;
+
+// Store-and-forward uplink. One thread reads the loggers' own segment files
+// (complete lines only), compresses batches and sends them to a collector,
+// one acknowledged frame at a time. Positions come from the collector on
+// every connect, so nothing is lost or duplicated across reconnects or
+// restarts, and anything logged while the link is down is sent once it is
+// back. Sending is paced to the bandwidth budget.
+typedef struct {
+    uplink_config_t config;
+    char directory[256];
+    uplink_stream_t streams[UPLINK_MAX_STREAMS];
+    int stream_count;
+
+    pthread_t thread;
+    int thread_started;
+    atomic_int draining;         // Stop once caught up (or at drain_deadline)
+    timestamp_ns_t drain_deadline;
+    timestamp_ns_t next_send;    // Pacing: earliest time the next frame may go out
+
+    uint8_t* records;            // Batch read from a segment
+    uint8_t* frame_buffer;       // Compressed batch, then received payloads
+
+    long frames_sent;
+    long records_sent;
+    long raw_bytes;
+    long wire_bytes;
+    long connects;
+    long realigned;              // DATA frames the collector asked to resend from elsewhere
+} uplink_t;
+
+// Parse "host:port" (port defaults to UPLINK_DEFAULT_PORT)
+int parse_uplink_address(const char* value, uplink_config_t* config);
+
+// Fill in defaults (no host)
+void init_uplink_config(uplink_config_t* config);
+
+// Start forwarding the segments of the named logs in directory
+int start_uplink(uplink_t* uplink, const uplink_config_t* config, const char* directory,
+                 const char* const* names, int count);
+
+// Forward what is left for up to drain_ms, then stop
+void stop_uplink(uplink_t* uplink);
+
+// Print frames, records, compression and reconnects
+void print_uplink_report(const uplink_t* uplink);
+
+#endif // UPLINK_H
@@ -0,0 +1,64 @@
+#ifndef UPLINK_PROTOCOL_H
+#define UPLINK_PROTOCOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Store-and-forward protocol between the daemon's uplink and a collector.
+// Every frame is a 12-byte header (magic, type, flags, body length; network
+// byte order) followed by the stream name, the segment file name, a 64-bit
+// offset, the uncompressed record length and count, and the payload.
+//
+//   client                           collector
+//   HELLO  stream                ->
+//                                <-  RESUME stream, segment, bytes held
+//   DATA   stream, segment, at   ->
+//                                <-  ACK    stream, segment, bytes held
+//
+// A collector mirrors each segment byte for byte and only ever appends, so
+// "bytes held" of the newest segment is the whole resume state: after a
+// reconnect the client continues from there. A DATA frame that does not
+// start at that offset is not stored; its ACK tells the client where to go.
+
+#define UPLINK_MAGIC 0x444c5550u         // "DLUP"
+#define UPLINK_DEFAULT_PORT 9700
+#define UPLINK_MAX_NAME 128
+#define UPLINK_MAX_RECORDS (256 * 1024)  // Uncompressed payload of one DATA frame
+#define UPLINK_MAX_PAYLOAD (UPLINK_MAX_RECORDS + UPLINK_MAX_RECORDS / 255 + 16)
+#define UPLINK_FLAG_COMPRESSED 0x1
+
+typedef enum {
+    UPLINK_HELLO = 1,
+    UPLINK_RESUME = 2,
+    UPLINK_DATA = 3,
+    UPLINK_ACK = 4
+} uplink_frame_type_t;
+
+// One decoded frame; payload points into the caller's buffer
+typedef struct {
+    uplink_frame_type_t type;
+    uint16_t flags;
+    char stream[UPLINK_MAX_NAME];
+    char segment[UPLINK_MAX_NAME];      // "" = no segment yet
+    uint64_t offset;                    // DATA: first byte; RESUME/ACK: bytes held
+    uint32_t raw_length;                // DATA: records before compression
+    uint32_t record_count;              // DATA: lines in the records
+    const uint8_t* payload;
+    uint32_t payload_length;
+} uplink_frame_t;
+
+// Send one frame; returns 0 or -1 when the connection failed
+int send_uplink_frame(int fd, const uplink_frame_t* frame);
+
+// Receive one frame, its payload into buffer; returns 0 or -1 on a closed
+// connection, a timeout or a malformed frame
+int recv_uplink_frame(int fd, uplink_frame_t* frame, uint8_t* buffer, size_t capacity);
+
+// LZ77 compression of record text (byte-oriented, 64 KiB window). Returns the
+// compressed length, or 0 when it would not be smaller than the input.
+size_t compress_uplink_records(const uint8_t* input, size_t length, uint8_t* output, size_t capacity);
+
+// Decompress exactly expected bytes; returns 0 or -1 on corrupt input
+int decompress_uplink_records(const uint8_t* input, size_t length, uint8_t* output, size_t expected);
+
+#endif // UPLINK_PROTOCOL_H
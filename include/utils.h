@@ -4,29 +4,67 @@
 #include <time.h>
 #include <stdint.h>
 
-// Time utilities
-typedef struct {
-    time_t timestamp;
-    long nanoseconds;
-} precise_time_t;
+// Time base: 64-bit integer nanoseconds on CLOCK_MONOTONIC. Sample timestamps,
+// intervals and deadlines all use it, so wall-clock steps (NTP, manual changes)
+// never distort them; wall-clock time is derived from a realtime anchor taken
+// once at startup and is only needed for display.
+typedef int64_t timestamp_ns_t;
+
+#define NS_PER_US 1000LL
+#define NS_PER_MS 1000000LL
+#define NS_PER_SEC 1000000000LL
+
+// Current monotonic time
+timestamp_ns_t get_current_time(void);
+
+// Current monotonic time at scheduler-tick resolution (a few ms) for paths
+// that only compare against coarse intervals; cheaper than get_current_time
+timestamp_ns_t get_coarse_time(void);
 
-// Get current time with high precision
-precise_time_t get_current_time(void);
+// Wall-clock nanoseconds since the epoch for a monotonic timestamp
+int64_t timestamp_to_realtime_ns(timestamp_ns_t time);
 
-// Format timestamp for CSV output
-void format_timestamp(precise_time_t time, char* buffer, size_t buffer_size);
+// Absolute CLOCK_MONOTONIC timespec for clock_nanosleep
+struct timespec timestamp_to_timespec(timestamp_ns_t time);
+
+// Format timestamp for CSV output (local wall-clock time)
+void format_timestamp(timestamp_ns_t time, char* buffer, size_t buffer_size);
 
 // Sleep for specified milliseconds
 void sleep_ms(int milliseconds);
 
 // Calculate time difference in milliseconds
-double time_diff_ms(precise_time_t start, precise_time_t end);
+double time_diff_ms(timestamp_ns_t start, timestamp_ns_t end);
+
+// Extended runtime options
+typedef struct {
+    int realtime;          // Enable real-time execution mode
+    int rt_priority;       // SCHED_FIFO priority for acquisition
+    int acquisition_cpu;   // CPU to pin acquisition to (-1 = no pinning)
+    int writer_cpu;        // CPU to pin writer threads to (-1 = no pinning)
+    int status_hz;         // Console status refresh rate
+    char* config_file;     // Daemon configuration file (NULL = interactive)
+    int metrics_port;      // Local HTTP metrics port (0 = disabled)
+    int perf_counters;     // Collect hardware counters per probed stage
+    char* trace_file;      // Chrome trace output (NULL = tracing off)
+    char* bus_name;        // Shared-memory sample bus name (NULL = off)
+    int bus_slots;         // Sample bus ring size in samples
+    int subscriber_threads; // Worker threads for analysis subscribers
+    int analysis_threads;  // Task pool workers for batch analysis (-1 = off, 0 = one per CPU)
+    int history_seconds;   // Recent history kept in memory per channel (0 = off)
+    int history_mb;        // Memory bound for the history store
+    char* rules_file;      // Alert rules file (NULL = built-in limits only)
+    int trigger_pre_ms;    // Raw history written to an event file per anomaly (0 = off)
+    int trigger_post_ms;   // Raw samples written after an anomaly (-1 = same as before)
+    int log_decimation;    // Main log keeps every Nth sample while trigger capture is on
+} runtime_options_t;
 
 // String utilities
 void trim_whitespace(char* str);
 int parse_command_line_args(int argc, char* argv[], char** device_path, 
                            int* duration, int* interval, char** output_file, 
-                           double* threshold, int* hardware_mode);
+                           double* threshold, int* hardware_mode,
+                           runtime_options_t* options);
 
 // Math utilities
 double clamp(double value, double min, double max);
@@ -0,0 +1,52 @@
+#ifndef WRITER_POOL_H
+#define WRITER_POOL_H
+
+#include "data_logger.h"
+#include "metrics.h"
+#include <pthread.h>
+
+#define WRITER_POOL_MAX_THREADS 8
+#define WRITER_QUEUE_SIZE 64
+
+// A batch of records to append to a logger's file, either one array or a
+// list of pooled batches that the writer releases once written, preceded by
+// gap lines for samples shed under overload
+typedef struct {
+    data_logger_t* logger;
+    const sensor_data_t* records;
+    int count;
+    sample_batch_t* const* batches;
+    int batch_count;
+    sample_gap_t* gaps;       // Shed samples to note before the records, or NULL
+} writer_job_t;
+
+// Pool of writer threads shared by any number of loggers
+typedef struct writer_pool {
+    pthread_t threads[WRITER_POOL_MAX_THREADS];
+    int thread_count;
+    int writer_cpu;           // CPU to pin writers to (-1 = no pinning)
+
+    writer_job_t queue[WRITER_QUEUE_SIZE];
+    int head;
+    int tail;
+    int count;
+    int running;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+
+    long jobs_completed;
+    long records_written;
+    metrics_gauge_t* queue_depth_metric;
+} writer_pool_t;
+
+// Start writer threads (writer_cpu = -1 leaves them unpinned)
+int init_writer_pool(writer_pool_t* pool, int thread_count, int writer_cpu);
+
+// Queue a job, blocking while the queue is full. Returns -1 if the pool is stopped.
+int submit_writer_job(writer_pool_t* pool, const writer_job_t* job);
+
+// Drain queued jobs and stop writer threads
+void cleanup_writer_pool(writer_pool_t* pool);
+
+#endif // WRITER_POOL_H
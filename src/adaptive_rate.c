@@ -0,0 +1,188 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/adaptive_rate.h"
+#include "../include/metrics.h"
+#include <stdio.h>
+#include <math.h>
+#include <pthread.h>
+
+// Controller metrics (shared by all controllers in the process)
+static metrics_counter_t* rate_changes_metric;
+static metrics_counter_t* samples_skipped_metric;
+static pthread_once_t adaptive_metrics_once = PTHREAD_ONCE_INIT;
+
+static void register_adaptive_metrics(void) {
+    rate_changes_metric = register_counter("datalogger_adaptive_rate_changes_total",
+                                           "Channel interval changes by the adaptive rate controller");
+    samples_skipped_metric = register_counter("datalogger_adaptive_samples_skipped_total",
+                                              "Acquired samples between a channel's adaptive intervals");
+}
+
+static const char* channel_names[] = {
+    "Temperature", "Vibration", "Strain", "Humidity",
+    "Pressure", "Accel_X", "Accel_Y", "Accel_Z"
+};
+
+// Fill in the default thresholds
+void init_adaptive_config(adaptive_config_t* config) {
+    if (!config) return;
+
+    config->raise_score = ADAPTIVE_DEFAULT_RAISE;
+    config->lower_score = ADAPTIVE_DEFAULT_LOWER;
+    config->hold_ms = ADAPTIVE_DEFAULT_HOLD_MS;
+}
+
+// Start every channel at the initial interval, clamped to its bounds
+int init_adaptive_rate(adaptive_rate_t* rate, const adaptive_config_t* config,
+                       const adaptive_bounds_t* bounds, int channel_count, int initial_interval_ms) {
+    if (!rate || !config || !bounds || channel_count <= 0 || channel_count > ADAPTIVE_MAX_CHANNELS) {
+        return -1;
+    }
+
+    pthread_once(&adaptive_metrics_once, register_adaptive_metrics);
+
+    rate->config = *config;
+    rate->channel_count = channel_count;
+
+    for (int i = 0; i < channel_count; i++) {
+        adaptive_channel_t* channel = &rate->channels[i];
+        if (bounds[i].min_interval_ms <= 0 || bounds[i].max_interval_ms < bounds[i].min_interval_ms) {
+            return -1;
+        }
+
+        channel->bounds = bounds[i];
+        channel->interval_ms = initial_interval_ms;
+        if (channel->interval_ms < bounds[i].min_interval_ms) channel->interval_ms = bounds[i].min_interval_ms;
+        if (channel->interval_ms > bounds[i].max_interval_ms) channel->interval_ms = bounds[i].max_interval_ms;
+
+        channel->fast_mean = 0.0;
+        channel->fast_variance = 0.0;
+        channel->slow_mean = 0.0;
+        channel->slow_variance = 0.0;
+        channel->score = 0.0;
+        channel->samples = 0;
+        channel->quiet_since = 0;
+        channel->last_kept = 0;
+        channel->next_keep = 0;
+        channel->kept = 0;
+        channel->raises = 0;
+        channel->lowers = 0;
+        channel->fastest_ms = channel->interval_ms;
+    }
+
+    return 0;
+}
+
+// Exponentially weighted mean and variance
+static void update_moments(double* mean, double* variance, double weight, double value) {
+    double delta = value - *mean;
+    *mean += weight * delta;
+    *variance = (1.0 - weight) * (*variance + weight * delta * delta);
+}
+
+// Move to a new interval; the next kept sample is due one new interval after the last
+static void set_channel_interval(adaptive_channel_t* channel, int interval_ms) {
+    if (interval_ms == channel->interval_ms) return;
+
+    if (interval_ms < channel->interval_ms) {
+        channel->raises++;
+    } else {
+        channel->lowers++;
+    }
+    counter_add(rate_changes_metric, 1);
+
+    channel->interval_ms = interval_ms;
+    if (interval_ms < channel->fastest_ms) channel->fastest_ms = interval_ms;
+    channel->next_keep = channel->last_kept + (int64_t)interval_ms * NS_PER_MS;
+}
+
+// Feed one acquired sample of a channel
+int update_adaptive_rate(adaptive_rate_t* rate, int channel_index, const sensor_data_t* sample, int anomaly) {
+    if (!rate || !sample || channel_index < 0 || channel_index >= rate->channel_count) return 1;
+
+    adaptive_channel_t* channel = &rate->channels[channel_index];
+    const adaptive_config_t* config = &rate->config;
+
+    // The warmup samples are averaged plainly, so the baseline does not start
+    // biased towards zero; afterwards it moves slowly enough not to absorb a burst
+    double count_weight = 1.0 / (double)++channel->samples;
+    int warm = channel->samples > ADAPTIVE_WARMUP_SAMPLES;
+    update_moments(&channel->fast_mean, &channel->fast_variance,
+                   count_weight > ADAPTIVE_FAST_WEIGHT ? count_weight : ADAPTIVE_FAST_WEIGHT, sample->value);
+    update_moments(&channel->slow_mean, &channel->slow_variance,
+                   warm ? ADAPTIVE_SLOW_WEIGHT : count_weight, sample->value);
+
+    // A flat baseline would make any change look infinitely active
+    double baseline = sqrt(channel->slow_variance);
+    if (baseline < 1e-9) baseline = 1e-9;
+    double spread = sqrt(channel->fast_variance) / baseline;
+    double drift = fabs(channel->fast_mean - channel->slow_mean) / baseline;
+    channel->score = spread > drift ? spread : drift;
+
+    // Fast attack, slow release: halve on activity, double only after a quiet hold
+    if (anomaly) {
+        set_channel_interval(channel, channel->bounds.min_interval_ms);
+        channel->quiet_since = 0;
+    } else if (warm) {
+        if (channel->score >= config->raise_score) {
+            int interval = channel->interval_ms / 2;
+            set_channel_interval(channel, interval > channel->bounds.min_interval_ms
+                                          ? interval : channel->bounds.min_interval_ms);
+            channel->quiet_since = 0;
+        } else if (channel->score < config->lower_score) {
+            if (channel->quiet_since == 0) {
+                channel->quiet_since = sample->timestamp;
+            } else if (sample->timestamp - channel->quiet_since >= (int64_t)config->hold_ms * NS_PER_MS) {
+                int interval = channel->interval_ms * 2;
+                set_channel_interval(channel, interval < channel->bounds.max_interval_ms
+                                              ? interval : channel->bounds.max_interval_ms);
+                channel->quiet_since = sample->timestamp;
+            }
+        } else {
+            channel->quiet_since = 0;
+        }
+    }
+
+    // Keep samples on the channel's own grid; half an interval of tolerance
+    // absorbs acquisition jitter when the channel runs at the acquisition rate
+    int64_t interval_ns = (int64_t)channel->interval_ms * NS_PER_MS;
+    if (!anomaly && sample->timestamp < channel->next_keep - interval_ns / 2) {
+        counter_add(samples_skipped_metric, 1);
+        return 0;
+    }
+
+    channel->kept++;
+    channel->last_kept = sample->timestamp;
+    channel->next_keep += interval_ns;
+    if (channel->next_keep <= sample->timestamp) {
+        channel->next_keep = sample->timestamp + interval_ns;
+    }
+    return 1;
+}
+
+// Shortest current channel interval
+int adaptive_acquisition_interval_ms(const adaptive_rate_t* rate) {
+    if (!rate || rate->channel_count == 0) return 0;
+
+    int interval = rate->channels[0].interval_ms;
+    for (int i = 1; i < rate->channel_count; i++) {
+        if (rate->channels[i].interval_ms < interval) interval = rate->channels[i].interval_ms;
+    }
+    return interval;
+}
+
+// Print current and fastest interval, kept fraction and rate changes per channel
+void print_adaptive_summary(const adaptive_rate_t* rate, const sensor_type_t* types) {
+    if (!rate || !types) return;
+
+    for (int i = 0; i < rate->channel_count; i++) {
+        const adaptive_channel_t* channel = &rate->channels[i];
+        const char* name = (types[i] >= 0 && types[i] < SENSOR_TYPE_COUNT) ? channel_names[types[i]] : "Unknown";
+
+        printf("- Adaptive rate %s: %d-%d ms, now %d ms, fastest %d ms, kept %ld of %ld samples, "
+               "%ld raise(s), %ld lower(s)\n",
+               name, channel->bounds.min_interval_ms, channel->bounds.max_interval_ms,
+               channel->interval_ms, channel->fastest_ms, channel->kept, channel->samples,
+               channel->raises, channel->lowers);
+    }
+}
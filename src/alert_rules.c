@@ -0,0 +1,1063 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/alert_rules.h"
+#include "../include/subscribers.h"
+#include "../include/metrics.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <math.h>
+
+// Protocol names used in rule expressions and output
+static const char* channel_names[SENSOR_TYPE_COUNT] = {
+    "TEMP", "VIB", "STRAIN", "HUM", "PRESS", "ACCEL_X", "ACCEL_Y", "ACCEL_Z"
+};
+
+static metrics_counter_t* alert_hits_metric = NULL;
+static metrics_histogram_t* alert_frame_metric = NULL;
+static pthread_once_t alert_metrics_once = PTHREAD_ONCE_INIT;
+
+static void register_alert_metrics(void) {
+    alert_hits_metric = register_counter("datalogger_alert_hits_total",
+                                         "Debounced alert rule hits");
+    alert_frame_metric = register_histogram("datalogger_alert_frame_seconds",
+                                            "Time to evaluate every alert rule over one sample frame");
+}
+
+// Growable tables used while a rules file is compiled
+typedef struct {
+    alert_engine_t* engine;
+    int signal_capacity;
+    int condition_capacity;
+    int rule_capacity;
+    int program_capacity;
+    int* condition_hash;        // Open addressing over condition indices, -1 = empty
+    int hash_capacity;
+} alert_compiler_t;
+
+// Recursive descent parser emitting postfix instructions for one rule
+typedef struct {
+    const char* cursor;
+    alert_compiler_t* compiler;
+    uint32_t program[ALERT_MAX_PROGRAM];
+    int length;
+    int depth;
+    const char* error;
+} rule_parser_t;
+
+// Strip leading and trailing whitespace, returns start of text
+static char* trim_text(char* str) {
+    while (isspace((unsigned char)*str)) str++;
+    if (*str == '\0') return str;
+
+    char* end = str + strlen(str) - 1;
+    while (end > str && isspace((unsigned char)*end)) end--;
+    end[1] = '\0';
+
+    return str;
+}
+
+// Grow *items to hold at least needed entries
+static int ensure_capacity(void** items, int* capacity, int needed, size_t size) {
+    if (needed <= *capacity) return 0;
+
+    int grown = *capacity > 0 ? *capacity * 2 : 64;
+    while (grown < needed) grown *= 2;
+
+    void* resized = realloc(*items, (size_t)grown * size);
+    if (!resized) return -1;
+
+    *items = resized;
+    *capacity = grown;
+    return 0;
+}
+
+// Index of a signal, added on first use
+static int intern_signal(alert_compiler_t* compiler, alert_signal_kind_t kind, sensor_type_t channel, int window) {
+    alert_engine_t* engine = compiler->engine;
+
+    // Only the windowed signals depend on their window
+    if (kind != ALERT_SIGNAL_MEAN && kind != ALERT_SIGNAL_RMS && kind != ALERT_SIGNAL_PEAK) window = 0;
+
+    for (int i = 0; i < engine->signal_count; i++) {
+        const alert_signal_t* signal = &engine->signals[i];
+        if (signal->kind == kind && signal->channel == channel && signal->window == window) return i;
+    }
+
+    if (ensure_capacity((void**)&engine->signals, &compiler->signal_capacity,
+                        engine->signal_count + 1, sizeof(alert_signal_t)) != 0) {
+        return -1;
+    }
+
+    alert_signal_t* signal = &engine->signals[engine->signal_count];
+    memset(signal, 0, sizeof(*signal));
+    signal->kind = kind;
+    signal->channel = channel;
+    signal->window = window;
+    signal->alpha = window > 0 ? 2.0 / (window + 1.0) : 1.0;
+
+    return engine->signal_count++;
+}
+
+static uint64_t condition_hash(int signal, alert_compare_t op, double threshold, int64_t hold_ns) {
+    uint64_t bits;
+    memcpy(&bits, &threshold, sizeof(bits));
+
+    uint64_t hash = 1469598103934665603ULL;
+    uint64_t parts[4] = { (uint64_t)signal, (uint64_t)op, bits, (uint64_t)hold_ns };
+    for (int i = 0; i < 4; i++) {
+        hash ^= parts[i];
+        hash *= 1099511628211ULL;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+// Rebuild the condition hash at twice the size
+static int grow_condition_hash(alert_compiler_t* compiler) {
+    int capacity = compiler->hash_capacity > 0 ? compiler->hash_capacity * 2 : 1024;
+    int* table = malloc((size_t)capacity * sizeof(int));
+    if (!table) return -1;
+
+    for (int i = 0; i < capacity; i++) table[i] = -1;
+
+    const alert_engine_t* engine = compiler->engine;
+    for (int i = 0; i < engine->condition_count; i++) {
+        const alert_condition_t* c = &engine->conditions[i];
+        uint64_t slot = condition_hash(c->signal, c->op, c->threshold, c->hold_ns) & (uint64_t)(capacity - 1);
+        while (table[slot] >= 0) slot = (slot + 1) & (uint64_t)(capacity - 1);
+        table[slot] = i;
+    }
+
+    free(compiler->condition_hash);
+    compiler->condition_hash = table;
+    compiler->hash_capacity = capacity;
+    return 0;
+}
+
+// Index of a condition; identical comparisons share one entry
+static int intern_condition(alert_compiler_t* compiler, int signal, alert_compare_t op,
+                            double threshold, int64_t hold_ns) {
+    alert_engine_t* engine = compiler->engine;
+
+    // Keep the table at most half full
+    if (2 * (engine->condition_count + 1) > compiler->hash_capacity && grow_condition_hash(compiler) != 0) {
+        return -1;
+    }
+
+    uint64_t mask = (uint64_t)(compiler->hash_capacity - 1);
+    uint64_t slot = condition_hash(signal, op, threshold, hold_ns) & mask;
+    while (compiler->condition_hash[slot] >= 0) {
+        const alert_condition_t* c = &engine->conditions[compiler->condition_hash[slot]];
+        if (c->signal == signal && c->op == op && c->threshold == threshold && c->hold_ns == hold_ns) {
+            return compiler->condition_hash[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    if (ensure_capacity((void**)&engine->conditions, &compiler->condition_capacity,
+                        engine->condition_count + 1, sizeof(alert_condition_t)) != 0) {
+        return -1;
+    }
+
+    alert_condition_t* condition = &engine->conditions[engine->condition_count];
+    memset(condition, 0, sizeof(*condition));
+    condition->signal = signal;
+    condition->op = op;
+    condition->threshold = threshold;
+    condition->hold_ns = hold_ns;
+
+    compiler->condition_hash[slot] = engine->condition_count;
+    return engine->condition_count++;
+}
+
+static void skip_spaces(rule_parser_t* parser) {
+    while (isspace((unsigned char)*parser->cursor)) parser->cursor++;
+}
+
+// Read an identifier into buffer; returns its length (0 = none)
+static int read_identifier(rule_parser_t* parser, char* buffer, size_t size) {
+    skip_spaces(parser);
+
+    const char* start = parser->cursor;
+    if (!isalpha((unsigned char)*start) && *start != '_') return 0;
+
+    const char* end = start;
+    while (isalnum((unsigned char)*end) || *end == '_') end++;
+    if ((size_t)(end - start) >= size) return 0;
+
+    memcpy(buffer, start, end - start);
+    buffer[end - start] = '\0';
+    parser->cursor = end;
+    return (int)(end - start);
+}
+
+// Consume a keyword (case-insensitive, whole word only)
+static int match_keyword(rule_parser_t* parser, const char* keyword) {
+    skip_spaces(parser);
+
+    size_t length = strlen(keyword);
+    if (strncasecmp(parser->cursor, keyword, length) != 0) return 0;
+
+    char next = parser->cursor[length];
+    if (isalnum((unsigned char)next) || next == '_') return 0;
+
+    parser->cursor += length;
+    return 1;
+}
+
+static int match_char(rule_parser_t* parser, char c) {
+    skip_spaces(parser);
+    if (*parser->cursor != c) return 0;
+    parser->cursor++;
+    return 1;
+}
+
+static int read_number(rule_parser_t* parser, double* value) {
+    skip_spaces(parser);
+
+    char* end = NULL;
+    *value = strtod(parser->cursor, &end);
+    if (end == parser->cursor || !isfinite(*value)) return 0;
+
+    parser->cursor = end;
+    return 1;
+}
+
+// Append an instruction, tracking the evaluation stack depth
+static int emit(rule_parser_t* parser, uint32_t op, uint32_t operand) {
+    if (parser->length >= ALERT_MAX_PROGRAM) {
+        parser->error = "expression too long";
+        return -1;
+    }
+
+    if (op == ALERT_INSN_COND) {
+        if (++parser->depth > ALERT_STACK_DEPTH) {
+            parser->error = "expression nested too deeply";
+            return -1;
+        }
+    } else if (op != ALERT_INSN_NOT) {
+        parser->depth--;
+    }
+
+    parser->program[parser->length++] = ALERT_INSN(op, operand);
+    return 0;
+}
+
+// CHAN or function(CHAN[, window])
+static int parse_signal(rule_parser_t* parser) {
+    char name[16];
+    char channel_name[16];
+    alert_signal_kind_t kind = ALERT_SIGNAL_VALUE;
+    int window = ALERT_DEFAULT_WINDOW;
+
+    if (!read_identifier(parser, name, sizeof(name))) {
+        parser->error = "expected a channel or function";
+        return -1;
+    }
+
+    if (match_char(parser, '(')) {
+        if (strcasecmp(name, "abs") == 0) kind = ALERT_SIGNAL_ABS;
+        else if (strcasecmp(name, "rate") == 0) kind = ALERT_SIGNAL_RATE;
+        else if (strcasecmp(name, "mean") == 0) kind = ALERT_SIGNAL_MEAN;
+        else if (strcasecmp(name, "rms") == 0) kind = ALERT_SIGNAL_RMS;
+        else if (strcasecmp(name, "peak") == 0) kind = ALERT_SIGNAL_PEAK;
+        else {
+            parser->error = "unknown function";
+            return -1;
+        }
+
+        if (!read_identifier(parser, channel_name, sizeof(channel_name))) {
+            parser->error = "expected a channel";
+            return -1;
+        }
+
+        if (match_char(parser, ',')) {
+            double samples;
+            if (kind == ALERT_SIGNAL_ABS || kind == ALERT_SIGNAL_RATE || !read_number(parser, &samples) ||
+                samples < 1 || samples > ALERT_MAX_WINDOW) {
+                parser->error = "invalid window";
+                return -1;
+            }
+            window = (int)samples;
+        }
+
+        if (!match_char(parser, ')')) {
+            parser->error = "expected ')'";
+            return -1;
+        }
+    } else {
+        snprintf(channel_name, sizeof(channel_name), "%s", name);
+    }
+
+    sensor_type_t channel;
+    if (sensor_type_from_name(channel_name, &channel) != 0) {
+        parser->error = "unknown channel";
+        return -1;
+    }
+
+    int signal = intern_signal(parser->compiler, kind, channel, window);
+    if (signal < 0) parser->error = "out of memory";
+    return signal;
+}
+
+// Optional "for <duration>" with ms (default), s or min units
+static int parse_hold(rule_parser_t* parser, int64_t* hold_ns) {
+    *hold_ns = 0;
+    if (!match_keyword(parser, "for")) return 0;
+
+    double amount;
+    if (!read_number(parser, &amount) || amount < 0) {
+        parser->error = "expected a duration";
+        return -1;
+    }
+
+    double scale = 1e6;
+    if (strncmp(parser->cursor, "ms", 2) == 0) {
+        parser->cursor += 2;
+    } else if (strncmp(parser->cursor, "min", 3) == 0) {
+        parser->cursor += 3;
+        scale = 60e9;
+    } else if (*parser->cursor == 's') {
+        parser->cursor++;
+        scale = 1e9;
+    }
+
+    *hold_ns = (int64_t)(amount * scale);
+    return 0;
+}
+
+// signal (> | >= | < | <=) number [for duration]
+static int parse_comparison(rule_parser_t* parser) {
+    int signal = parse_signal(parser);
+    if (signal < 0) return -1;
+
+    skip_spaces(parser);
+    alert_compare_t op;
+    if (strncmp(parser->cursor, ">=", 2) == 0) {
+        op = ALERT_OP_GE;
+        parser->cursor += 2;
+    } else if (strncmp(parser->cursor, "<=", 2) == 0) {
+        op = ALERT_OP_LE;
+        parser->cursor += 2;
+    } else if (*parser->cursor == '>') {
+        op = ALERT_OP_GT;
+        parser->cursor++;
+    } else if (*parser->cursor == '<') {
+        op = ALERT_OP_LT;
+        parser->cursor++;
+    } else {
+        parser->error = "expected a comparison";
+        return -1;
+    }
+
+    double threshold;
+    if (!read_number(parser, &threshold)) {
+        parser->error = "expected a number";
+        return -1;
+    }
+
+    int64_t hold_ns;
+    if (parse_hold(parser, &hold_ns) != 0) return -1;
+
+    int condition = intern_condition(parser->compiler, signal, op, threshold, hold_ns);
+    if (condition < 0) {
+        parser->error = "out of memory";
+        return -1;
+    }
+
+    return emit(parser, ALERT_INSN_COND, (uint32_t)condition);
+}
+
+static int parse_or(rule_parser_t* parser);
+
+// not term | ( expression ) | comparison
+static int parse_term(rule_parser_t* parser) {
+    if (match_keyword(parser, "not")) {
+        if (parse_term(parser) != 0) return -1;
+        return emit(parser, ALERT_INSN_NOT, 0);
+    }
+
+    if (match_char(parser, '(')) {
+        if (parse_or(parser) != 0) return -1;
+        if (!match_char(parser, ')')) {
+            parser->error = "expected ')'";
+            return -1;
+        }
+        return 0;
+    }
+
+    return parse_comparison(parser);
+}
+
+static int parse_and(rule_parser_t* parser) {
+    if (parse_term(parser) != 0) return -1;
+
+    while (match_keyword(parser, "and")) {
+        if (parse_term(parser) != 0) return -1;
+        if (emit(parser, ALERT_INSN_AND, 0) != 0) return -1;
+    }
+    return 0;
+}
+
+static int parse_or(rule_parser_t* parser) {
+    if (parse_and(parser) != 0) return -1;
+
+    while (match_keyword(parser, "or")) {
+        if (parse_and(parser) != 0) return -1;
+        if (emit(parser, ALERT_INSN_OR, 0) != 0) return -1;
+    }
+    return 0;
+}
+
+// Compile a rule's expression into the shared program table
+static int compile_rule(alert_compiler_t* compiler, alert_rule_t* rule) {
+    rule_parser_t parser;
+    memset(&parser, 0, sizeof(parser));
+    parser.cursor = rule->expression;
+    parser.compiler = compiler;
+
+    if (parse_or(&parser) == 0) {
+        skip_spaces(&parser);
+        if (*parser.cursor != '\0') parser.error = "unexpected text";
+    }
+    if (parser.error) {
+        fprintf(stderr, "Error: Rule '%s': %s at '%s'\n", rule->name, parser.error, parser.cursor);
+        return -1;
+    }
+
+    alert_engine_t* engine = compiler->engine;
+    if (ensure_capacity((void**)&engine->program, &compiler->program_capacity,
+                        engine->program_length + parser.length, sizeof(uint32_t)) != 0) {
+        return -1;
+    }
+
+    rule->program_start = engine->program_length;
+    rule->program_length = parser.length;
+    memcpy(&engine->program[engine->program_length], parser.program, parser.length * sizeof(uint32_t));
+    engine->program_length += parser.length;
+    return 0;
+}
+
+// Build one per-channel index: start[c] .. start[c + 1] in *items
+static int build_channel_index(int** items, int* start, int count,
+                               int (*channel_of)(const alert_engine_t*, int), const alert_engine_t* engine) {
+    *items = malloc((size_t)(count > 0 ? count : 1) * sizeof(int));
+    if (!*items) return -1;
+
+    int position = 0;
+    for (int c = 0; c < SENSOR_TYPE_COUNT; c++) {
+        start[c] = position;
+        for (int i = 0; i < count; i++) {
+            if (channel_of(engine, i) == c) (*items)[position++] = i;
+        }
+    }
+    start[SENSOR_TYPE_COUNT] = position;
+    return 0;
+}
+
+static int signal_channel(const alert_engine_t* engine, int index) {
+    return engine->signals[index].channel;
+}
+
+static int condition_channel(const alert_engine_t* engine, int index) {
+    return engine->signals[engine->conditions[index].signal].channel;
+}
+
+// Index the rules that read each condition, each rule listed once per condition
+static int build_condition_rules(alert_engine_t* engine) {
+    int* start = calloc((size_t)engine->condition_count + 1, sizeof(int));
+    int* last_rule = malloc((size_t)(engine->condition_count > 0 ? engine->condition_count : 1) * sizeof(int));
+    engine->rule_start = start;
+    engine->condition_rules = malloc((size_t)(engine->program_length > 0 ? engine->program_length : 1) * sizeof(int));
+    engine->dirty_rules = malloc((size_t)(engine->rule_count > 0 ? engine->rule_count : 1) * sizeof(int));
+    if (!start || !last_rule || !engine->condition_rules || !engine->dirty_rules) {
+        free(last_rule);
+        return -1;
+    }
+
+    // Count distinct rules per condition, then fill in rule order
+    for (int pass = 0; pass < 2; pass++) {
+        for (int c = 0; c < engine->condition_count; c++) last_rule[c] = -1;
+
+        for (int r = 0; r < engine->rule_count; r++) {
+            const alert_rule_t* rule = &engine->rules[r];
+            for (int i = 0; i < rule->program_length; i++) {
+                uint32_t insn = engine->program[rule->program_start + i];
+                if ((insn >> 30) != ALERT_INSN_COND) continue;
+
+                int condition = (int)(insn & 0x3FFFFFFFu);
+                if (last_rule[condition] == r) continue;
+                last_rule[condition] = r;
+
+                if (pass == 0) {
+                    start[condition + 1]++;
+                } else {
+                    engine->condition_rules[start[condition + 1]++] = r;
+                }
+            }
+        }
+
+        if (pass == 0) {
+            for (int c = 0; c < engine->condition_count; c++) start[c + 1] += start[c];
+            // start[c + 1] becomes the fill position of c and ends as its end
+            for (int c = engine->condition_count; c > 0; c--) start[c] = start[c - 1];
+        }
+    }
+
+    free(last_rule);
+    return 0;
+}
+
+// Allocate peak rings and indexes once every rule is compiled
+static int finish_alert_tables(alert_engine_t* engine) {
+    for (int i = 0; i < engine->signal_count; i++) {
+        alert_signal_t* signal = &engine->signals[i];
+        if (signal->kind != ALERT_SIGNAL_PEAK) continue;
+
+        signal->peaks = calloc(signal->window, sizeof(alert_peak_entry_t));
+        if (!signal->peaks) return -1;
+    }
+
+    if (build_channel_index(&engine->channel_signals, engine->signal_start,
+                            engine->signal_count, signal_channel, engine) != 0 ||
+        build_channel_index(&engine->channel_conditions, engine->condition_start,
+                            engine->condition_count, condition_channel, engine) != 0 ||
+        build_condition_rules(engine) != 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int parse_severity(const char* value, alert_severity_t* severity) {
+    if (strcasecmp(value, "info") == 0) *severity = ALERT_INFO;
+    else if (strcasecmp(value, "warning") == 0) *severity = ALERT_WARNING;
+    else if (strcasecmp(value, "critical") == 0) *severity = ALERT_CRITICAL;
+    else return -1;
+    return 0;
+}
+
+// Apply one key/value pair of the [limits] section
+static int apply_limit_setting(alert_limits_t* limits, const char* key, const char* value) {
+    char* end = NULL;
+    double number = strtod(value, &end);
+    if (end == value || *end != '\0' || number <= 0) return -1;
+
+    if (strcmp(key, "bridge_rms_warning") == 0) {
+        limits->bridge.rms_warning = number;
+    } else if (strcmp(key, "bridge_rms_critical") == 0) {
+        limits->bridge.rms_critical = number;
+    } else if (strcmp(key, "bridge_peak_warning") == 0) {
+        limits->bridge.peak_warning = number;
+    } else if (strcmp(key, "bridge_peak_critical") == 0) {
+        limits->bridge.peak_critical = number;
+    } else if (strcmp(key, "absolute_threshold") == 0) {
+        limits->absolute_threshold = number;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+// Each warning level must be below its critical level
+static int check_alert_limits(const alert_limits_t* limits) {
+    if (limits->bridge.rms_warning >= limits->bridge.rms_critical) {
+        fprintf(stderr, "Error: [limits] bridge_rms_warning must be below bridge_rms_critical\n");
+        return -1;
+    }
+    if (limits->bridge.peak_warning >= limits->bridge.peak_critical) {
+        fprintf(stderr, "Error: [limits] bridge_peak_warning must be below bridge_peak_critical\n");
+        return -1;
+    }
+    return 0;
+}
+
+// Apply one key/value pair of a [rule] section
+static int apply_rule_setting(alert_rule_t* rule, const char* key, const char* value) {
+    if (strcmp(key, "when") == 0) {
+        if (strlen(value) >= sizeof(rule->expression)) return -1;
+        snprintf(rule->expression, sizeof(rule->expression), "%s", value);
+    } else if (strcmp(key, "severity") == 0) {
+        return parse_severity(value, &rule->severity);
+    } else if (strcmp(key, "debounce_ms") == 0) {
+        long ms = atol(value);
+        if (ms < 0) return -1;
+        rule->debounce_ns = (int64_t)ms * 1000000LL;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+// Compile the rule of the section just finished
+static int finish_rule(alert_compiler_t* compiler, alert_rule_t* rule) {
+    if (rule->expression[0] == '\0') {
+        fprintf(stderr, "Error: Rule '%s' has no 'when' expression\n", rule->name);
+        return -1;
+    }
+    return compile_rule(compiler, rule);
+}
+
+// Load and compile a rules file
+int load_alert_rules(const char* path, alert_engine_t* engine) {
+    if (!path || !engine) return -1;
+
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot open rules file '%s'\n", path);
+        return -1;
+    }
+
+    pthread_once(&alert_metrics_once, register_alert_metrics);
+
+    memset(engine, 0, sizeof(*engine));
+    engine->limits.bridge = get_bridge_safety_limits();
+    engine->limits.absolute_threshold = BRIDGE_DEFAULT_ABSOLUTE_LIMIT;
+    pthread_mutex_init(&engine->lock, NULL);
+
+    alert_compiler_t compiler;
+    memset(&compiler, 0, sizeof(compiler));
+    compiler.engine = engine;
+
+    alert_rule_t* rule = NULL;
+    int in_limits_section = 0;
+    int line_number = 0;
+    int result = 0;
+    char line[512];
+
+    while (result == 0 && fgets(line, sizeof(line), file)) {
+        line_number++;
+
+        char* comment = strpbrk(line, "#;");
+        if (comment) *comment = '\0';
+
+        char* text = trim_text(line);
+        if (*text == '\0') continue;
+
+        // Section header
+        if (*text == '[') {
+            char* close = strchr(text, ']');
+            if (!close) {
+                result = -1;
+                break;
+            }
+            *close = '\0';
+            char* section = trim_text(text + 1);
+
+            if (rule && finish_rule(&compiler, rule) != 0) {
+                result = -1;
+                break;
+            }
+            rule = NULL;
+            in_limits_section = 0;
+
+            if (strcmp(section, "limits") == 0) {
+                in_limits_section = 1;
+            } else if (strncmp(section, "rule", 4) == 0 && isspace((unsigned char)section[4])) {
+                if (engine->rule_count >= ALERT_MAX_RULES ||
+                    ensure_capacity((void**)&engine->rules, &compiler.rule_capacity,
+                                    engine->rule_count + 1, sizeof(alert_rule_t)) != 0) {
+                    fprintf(stderr, "Error: Too many rules (max %d)\n", ALERT_MAX_RULES);
+                    result = -1;
+                    break;
+                }
+                rule = &engine->rules[engine->rule_count++];
+                memset(rule, 0, sizeof(*rule));
+                snprintf(rule->name, sizeof(rule->name), "%s", trim_text(section + 5));
+                rule->severity = ALERT_WARNING;
+                rule->debounce_ns = 1000000000LL;
+            } else {
+                result = -1;
+            }
+            continue;
+        }
+
+        // key = value
+        char* equals = strchr(text, '=');
+        if (!equals) {
+            result = -1;
+            break;
+        }
+        *equals = '\0';
+        char* key = trim_text(text);
+        char* value = trim_text(equals + 1);
+
+        if (rule) {
+            result = apply_rule_setting(rule, key, value);
+        } else if (in_limits_section) {
+            result = apply_limit_setting(&engine->limits, key, value);
+        } else {
+            result = -1;
+        }
+    }
+
+    if (result == 0 && rule) {
+        result = finish_rule(&compiler, rule);
+    } else if (result != 0) {
+        fprintf(stderr, "Error: Invalid rules file '%s' at line %d\n", path, line_number);
+    }
+    if (result == 0) {
+        result = check_alert_limits(&engine->limits);
+    }
+
+    fclose(file);
+    free(compiler.condition_hash);
+
+    if (result == 0 && finish_alert_tables(engine) != 0) {
+        fprintf(stderr, "Error: Out of memory compiling rules\n");
+        result = -1;
+    }
+
+    if (result != 0) {
+        cleanup_alert_rules(engine);
+        return -1;
+    }
+
+    return 0;
+}
+
+// Bring a derived metric up to date with a new sample of its channel
+static void update_signal(alert_signal_t* signal, double value, int64_t now_ns) {
+    switch (signal->kind) {
+        case ALERT_SIGNAL_VALUE:
+            signal->value = value;
+            break;
+        case ALERT_SIGNAL_ABS:
+            signal->value = fabs(value);
+            break;
+        case ALERT_SIGNAL_RATE:
+            if (signal->samples > 0 && now_ns > signal->previous_ns) {
+                signal->value = (value - signal->state) * 1e9 / (double)(now_ns - signal->previous_ns);
+            }
+            signal->state = value;
+            signal->previous_ns = now_ns;
+            break;
+        case ALERT_SIGNAL_MEAN:
+            signal->state = signal->samples > 0 ? signal->state + signal->alpha * (value - signal->state) : value;
+            signal->value = signal->state;
+            break;
+        case ALERT_SIGNAL_RMS: {
+            double square = value * value;
+            signal->state = signal->samples > 0 ? signal->state + signal->alpha * (square - signal->state) : square;
+            signal->value = sqrt(signal->state);
+            break;
+        }
+        case ALERT_SIGNAL_PEAK: {
+            // Monotonic ring: values decrease from head to tail, expired entries leave at the head
+            double magnitude = fabs(value);
+            while (signal->peak_count > 0) {
+                int tail = (signal->peak_head + signal->peak_count - 1) % signal->window;
+                if (signal->peaks[tail].value > magnitude) break;
+                signal->peak_count--;
+            }
+            if (signal->peak_count > 0 && signal->peaks[signal->peak_head].index <= signal->samples - signal->window) {
+                signal->peak_head = (signal->peak_head + 1) % signal->window;
+                signal->peak_count--;
+            }
+            int tail = (signal->peak_head + signal->peak_count) % signal->window;
+            signal->peaks[tail].value = magnitude;
+            signal->peaks[tail].index = signal->samples;
+            signal->peak_count++;
+            signal->value = signal->peaks[signal->peak_head].value;
+            break;
+        }
+    }
+    signal->samples++;
+}
+
+static int compare_value(double value, alert_compare_t op, double threshold) {
+    switch (op) {
+        case ALERT_OP_GT: return value > threshold;
+        case ALERT_OP_GE: return value >= threshold;
+        case ALERT_OP_LT: return value < threshold;
+        case ALERT_OP_LE: return value <= threshold;
+    }
+    return 0;
+}
+
+// Run a rule program over the current condition states
+static int run_rule_program(const alert_engine_t* engine, const alert_rule_t* rule) {
+    int stack[ALERT_STACK_DEPTH];
+    int top = 0;
+
+    const uint32_t* program = &engine->program[rule->program_start];
+    for (int i = 0; i < rule->program_length; i++) {
+        uint32_t insn = program[i];
+        switch (insn >> 30) {
+            case ALERT_INSN_COND:
+                stack[top++] = engine->conditions[insn & 0x3FFFFFFFu].state;
+                break;
+            case ALERT_INSN_AND:
+                top--;
+                stack[top - 1] = stack[top - 1] && stack[top];
+                break;
+            case ALERT_INSN_OR:
+                top--;
+                stack[top - 1] = stack[top - 1] || stack[top];
+                break;
+            case ALERT_INSN_NOT:
+                stack[top - 1] = !stack[top - 1];
+                break;
+        }
+    }
+
+    return top > 0 ? stack[0] : 0;
+}
+
+// Record a debounced hit (caller holds the lock)
+static void record_alert_hit(alert_engine_t* engine, int index, const sensor_data_t* sample, int64_t now_ns) {
+    alert_rule_t* rule = &engine->rules[index];
+    rule->hits++;
+    rule->last_hit_ns = now_ns;
+    engine->total_hits++;
+    counter_add(alert_hits_metric, 1);
+
+    alert_hit_t* hit = &engine->recent[engine->recent_next];
+    engine->recent_next = (engine->recent_next + 1) % ALERT_RECENT_HITS;
+    hit->rule = index;
+    hit->severity = rule->severity;
+    hit->channel = sample->type;
+    hit->value = sample->value;
+    hit->timestamp_ns = now_ns;
+
+    if (engine->handler) {
+        engine->handler(engine->handler_context, rule, hit);
+    }
+}
+
+// Signals and conditions of the sample's channel, then the rules whose conditions changed
+static void evaluate_alert_sample(alert_engine_t* engine, const sensor_data_t* sample) {
+    int channel = sample->type;
+    if (channel < 0 || channel >= SENSOR_TYPE_COUNT) return;
+
+    int64_t now_ns = sample->timestamp;
+    long stamp = ++engine->dirty_stamp;
+    int dirty_count = 0;
+
+    for (int i = engine->signal_start[channel]; i < engine->signal_start[channel + 1]; i++) {
+        update_signal(&engine->signals[engine->channel_signals[i]], sample->value, now_ns);
+    }
+
+    for (int i = engine->condition_start[channel]; i < engine->condition_start[channel + 1]; i++) {
+        int index = engine->channel_conditions[i];
+        alert_condition_t* condition = &engine->conditions[index];
+        int raw = compare_value(engine->signals[condition->signal].value, condition->op, condition->threshold);
+        if (raw && !condition->raw) condition->true_since_ns = now_ns;
+        condition->raw = raw;
+
+        int state = raw && now_ns - condition->true_since_ns >= condition->hold_ns;
+        if (state == condition->state && condition->evaluated) continue;
+        condition->state = state;
+        condition->evaluated = 1;
+
+        for (int j = engine->rule_start[index]; j < engine->rule_start[index + 1]; j++) {
+            alert_rule_t* rule = &engine->rules[engine->condition_rules[j]];
+            if (rule->dirty_stamp == stamp) continue;
+            rule->dirty_stamp = stamp;
+            engine->dirty_rules[dirty_count++] = engine->condition_rules[j];
+        }
+    }
+
+    for (int i = 0; i < dirty_count; i++) {
+        int index = engine->dirty_rules[i];
+        alert_rule_t* rule = &engine->rules[index];
+        int active = run_rule_program(engine, rule);
+
+        // Hits fire on the rising edge, at most once per debounce period
+        if (active && !rule->active) {
+            if (rule->hits == 0 || now_ns - rule->last_hit_ns >= rule->debounce_ns) {
+                record_alert_hit(engine, index, sample, now_ns);
+            } else {
+                rule->suppressed++;
+            }
+        }
+        rule->active = active;
+    }
+}
+
+// Evaluate a frame of samples in timestamp order
+void evaluate_alert_frame(alert_engine_t* engine, const sensor_data_t* samples, int count) {
+    if (!engine || !engine->rules || !samples || count <= 0) return;
+
+    int64_t start_ns = metrics_now_ns();
+
+    pthread_mutex_lock(&engine->lock);
+    for (int i = 0; i < count; i++) {
+        evaluate_alert_sample(engine, &samples[i]);
+    }
+    engine->samples_evaluated += count;
+
+    int64_t elapsed_ns = metrics_now_ns() - start_ns;
+    engine->evaluate_ns += elapsed_ns;
+    pthread_mutex_unlock(&engine->lock);
+
+    histogram_observe_ns(alert_frame_metric, (long)elapsed_ns);
+}
+
+// Receive hits as they happen
+void set_alert_hit_handler(alert_engine_t* engine, alert_hit_handler_t handler, void* context) {
+    if (!engine) return;
+
+    pthread_mutex_lock(&engine->lock);
+    engine->handler = handler;
+    engine->handler_context = context;
+    pthread_mutex_unlock(&engine->lock);
+}
+
+// Subscriber callback: each delivered batch is one frame
+static void alert_subscriber(void* context, const sensor_data_t* samples, int count) {
+    evaluate_alert_frame(context, samples, count);
+}
+
+// Rule names come from the rules file, so quotes, backslashes and control
+// characters are escaped
+static void write_json_string(FILE* out, const char* text) {
+    fputc('"', out);
+    for (const unsigned char* p = (const unsigned char*)text; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fprintf(out, "\\%c", *p);
+        } else if (*p < 0x20) {
+            fprintf(out, "\\u%04x", *p);
+        } else {
+            fputc(*p, out);
+        }
+    }
+    fputc('"', out);
+}
+
+// GET /alerts: totals, rules that fired and the most recent hits
+static void handle_alerts_request(FILE* out, const char* query, void* context) {
+    (void)query;
+    alert_engine_t* engine = context;
+
+    pthread_mutex_lock(&engine->lock);
+
+    fprintf(out, "{\"rules\":%d,\"conditions\":%d,\"samples\":%ld,\"hits\":%ld,\"fired\":[",
+            engine->rule_count, engine->condition_count, engine->samples_evaluated, engine->total_hits);
+
+    int first = 1;
+    for (int i = 0; i < engine->rule_count; i++) {
+        const alert_rule_t* rule = &engine->rules[i];
+        if (rule->hits == 0) continue;
+        fprintf(out, "%s{\"rule\":", first ? "" : ",");
+        write_json_string(out, rule->name);
+        fprintf(out, ",\"severity\":\"%s\",\"hits\":%ld,\"suppressed\":%ld,\"active\":%s}",
+                alert_severity_name(rule->severity), rule->hits, rule->suppressed,
+                rule->active ? "true" : "false");
+        first = 0;
+    }
+
+    // Recent hits, newest first
+    fprintf(out, "],\"recent\":[");
+    long recent = engine->total_hits < ALERT_RECENT_HITS ? engine->total_hits : ALERT_RECENT_HITS;
+    for (long i = 0; i < recent; i++) {
+        int slot = (int)((engine->recent_next - 1 - i + ALERT_RECENT_HITS) % ALERT_RECENT_HITS);
+        const alert_hit_t* hit = &engine->recent[slot];
+        fprintf(out, "%s{\"rule\":", i == 0 ? "" : ",");
+        write_json_string(out, engine->rules[hit->rule].name);
+        fprintf(out, ",\"severity\":\"%s\",\"channel\":\"%s\",\"value\":%.9g,\"timestamp_ns\":%lld}",
+                alert_severity_name(hit->severity), channel_names[hit->channel], hit->value,
+                (long long)timestamp_to_realtime_ns(hit->timestamp_ns));
+    }
+    fprintf(out, "]}\n");
+
+    pthread_mutex_unlock(&engine->lock);
+}
+
+// Evaluate rules from the pipeline and serve hits over HTTP
+int attach_alert_rules(alert_engine_t* engine) {
+    if (!engine || !engine->rules) return -1;
+
+    uint32_t channels = 0;
+    for (int c = 0; c < SENSOR_TYPE_COUNT; c++) {
+        if (engine->condition_start[c + 1] > engine->condition_start[c]) channels |= SUBSCRIBE_CHANNEL(c);
+    }
+
+    subscriber_config_t config = {
+        .name = "alerts",
+        .channel_mask = channels,
+        .callback = alert_subscriber,
+        .context = engine,
+        .queue_capacity = 16384,
+        .batch_size = 256
+    };
+    if (subscribe_samples(&config) < 0) return -1;
+
+    register_http_route("/alerts", "application/json", handle_alerts_request, engine);
+
+    printf("Alert rules: %d rules compiled to %d conditions over %d signals (%d instructions)\n",
+           engine->rule_count, engine->condition_count, engine->signal_count, engine->program_length);
+    return 0;
+}
+
+// Severity name for output
+const char* alert_severity_name(alert_severity_t severity) {
+    switch (severity) {
+        case ALERT_INFO: return "info";
+        case ALERT_WARNING: return "warning";
+        case ALERT_CRITICAL: return "critical";
+        default: return "unknown";
+    }
+}
+
+// Print hit counts of every rule that fired and evaluation cost
+void print_alert_report(alert_engine_t* engine) {
+    if (!engine || !engine->rules) return;
+
+    pthread_mutex_lock(&engine->lock);
+
+    printf("\n=== Alert Rules ===\n");
+    printf("Rules: %d, conditions: %d, samples evaluated: %ld, hits: %ld\n",
+           engine->rule_count, engine->condition_count, engine->samples_evaluated, engine->total_hits);
+    if (engine->samples_evaluated > 0) {
+        printf("Evaluation: %.3f us per sample\n",
+               engine->evaluate_ns / 1000.0 / engine->samples_evaluated);
+    }
+
+    if (engine->total_hits > 0) {
+        printf("%-32s %-9s %8s %11s\n", "Rule", "Severity", "Hits", "Suppressed");
+        for (int i = 0; i < engine->rule_count; i++) {
+            const alert_rule_t* rule = &engine->rules[i];
+            if (rule->hits == 0) continue;
+            printf("%-32s %-9s %8ld %11ld\n", rule->name, alert_severity_name(rule->severity),
+                   rule->hits, rule->suppressed);
+        }
+    }
+
+    pthread_mutex_unlock(&engine->lock);
+}
+
+// Free the compiled tables
+void cleanup_alert_rules(alert_engine_t* engine) {
+    if (!engine) return;
+
+    for (int i = 0; i < engine->signal_count; i++) {
+        free(engine->signals[i].peaks);
+    }
+    free(engine->signals);
+    free(engine->conditions);
+    free(engine->rules);
+    free(engine->program);
+    free(engine->channel_signals);
+    free(engine->channel_conditions);
+    free(engine->condition_rules);
+    free(engine->rule_start);
+    free(engine->dirty_rules);
+
+    engine->signals = NULL;
+    engine->conditions = NULL;
+    engine->rules = NULL;
+    engine->program = NULL;
+    engine->channel_signals = NULL;
+    engine->channel_conditions = NULL;
+    engine->condition_rules = NULL;
+    engine->rule_start = NULL;
+    engine->dirty_rules = NULL;
+    engine->signal_count = 0;
+    engine->condition_count = 0;
+    engine->rule_count = 0;
+    engine->program_length = 0;
+}
@@ -0,0 +1,159 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/bus_publisher.h"
+#include "../include/metrics.h"
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static sample_bus_header_t* bus_header = NULL;
+static bus_slot_t* bus_slots = NULL;
+static uint64_t bus_mask = 0;
+static size_t bus_map_size = 0;
+static char bus_path[128];
+static atomic_int bus_enabled = 0;
+
+// Sources are registered even when the bus is off so indices stay stable
+static char source_names[SAMPLE_BUS_MAX_SOURCES][SAMPLE_BUS_NAME_LENGTH];
+static atomic_int source_count = 0;
+static pthread_mutex_t source_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static metrics_counter_t* published_metric = NULL;
+
+// Copy registered source names into the shared header
+static void export_source_names(void) {
+    int count = atomic_load(&source_count);
+    for (int i = 0; i < count; i++) {
+        memcpy(bus_header->source_names[i], source_names[i], SAMPLE_BUS_NAME_LENGTH);
+    }
+    atomic_store_explicit(&bus_header->source_count, (uint32_t)count, memory_order_release);
+}
+
+// Create the shared-memory ring
+int start_sample_bus(const char* name, int slot_count) {
+    if (!name || name[0] == '\0' || strchr(name, '/') || atomic_load(&bus_enabled)) return -1;
+
+    uint64_t slots = 1;
+    while (slots < (uint64_t)(slot_count > 0 ? slot_count : SAMPLE_BUS_DEFAULT_SLOTS)) slots <<= 1;
+
+    size_t slots_offset = (sizeof(sample_bus_header_t) + 63) & ~(size_t)63;
+    size_t size = slots_offset + slots * sizeof(bus_slot_t);
+
+    snprintf(bus_path, sizeof(bus_path), "/%s", name);
+
+    // A stale segment from an earlier run is replaced; open readers keep their old mapping
+    shm_unlink(bus_path);
+    int fd = shm_open(bus_path, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot create sample bus '%s'\n", name);
+        return -1;
+    }
+
+    if (ftruncate(fd, (off_t)size) != 0) {
+        fprintf(stderr, "Error: Cannot size sample bus '%s'\n", name);
+        close(fd);
+        shm_unlink(bus_path);
+        return -1;
+    }
+
+    void* map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Error: Cannot map sample bus '%s'\n", name);
+        shm_unlink(bus_path);
+        return -1;
+    }
+
+    // New pages are zero, so every slot starts with sequence 0 (nothing published)
+    bus_header = map;
+    bus_slots = (bus_slot_t*)((char*)map + slots_offset);
+    bus_mask = slots - 1;
+    bus_map_size = size;
+
+    bus_header->version = SAMPLE_BUS_VERSION;
+    bus_header->slot_count = (uint32_t)slots;
+    bus_header->slot_size = sizeof(bus_slot_t);
+    bus_header->slots_offset = slots_offset;
+    bus_header->publisher_pid = (int32_t)getpid();
+
+    bus_header->start_time_ns = timestamp_to_realtime_ns(get_current_time());
+
+    pthread_mutex_lock(&source_lock);
+    export_source_names();
+    pthread_mutex_unlock(&source_lock);
+
+    // Readers check the magic last, so it is published after the rest of the header
+    atomic_thread_fence(memory_order_release);
+    bus_header->magic = SAMPLE_BUS_MAGIC;
+
+    published_metric = register_counter("datalogger_bus_samples_published_total",
+                                        "Samples published on the shared-memory bus");
+    atomic_store(&bus_enabled, 1);
+
+    printf("Sample bus: /dev/shm%s (%lu slots, %.1f MB)\n", bus_path,
+           (unsigned long)slots, size / (1024.0 * 1024.0));
+    return 0;
+}
+
+// Mark the bus closed and remove it
+void stop_sample_bus(void) {
+    if (!atomic_exchange(&bus_enabled, 0)) return;
+
+    atomic_store_explicit(&bus_header->closed, 1, memory_order_release);
+    munmap(bus_header, bus_map_size);
+    shm_unlink(bus_path);
+
+    bus_header = NULL;
+    bus_slots = NULL;
+}
+
+// Register a named source
+int register_bus_source(const char* name) {
+    pthread_mutex_lock(&source_lock);
+
+    int index = atomic_load(&source_count);
+    if (index >= SAMPLE_BUS_MAX_SOURCES) {
+        pthread_mutex_unlock(&source_lock);
+        fprintf(stderr, "Warning: Sample bus source limit reached; '%s' shares source %d\n",
+                name ? name : "", SAMPLE_BUS_MAX_SOURCES - 1);
+        return SAMPLE_BUS_MAX_SOURCES - 1;
+    }
+
+    snprintf(source_names[index], SAMPLE_BUS_NAME_LENGTH, "%s", name ? name : "");
+    atomic_store(&source_count, index + 1);
+    if (atomic_load(&bus_enabled)) {
+        export_source_names();
+    }
+
+    pthread_mutex_unlock(&source_lock);
+    return index;
+}
+
+// Reserve a sequence number per sample and write it under the slot's seqlock
+void publish_bus_samples(int source, const sensor_data_t* samples, int count) {
+    if (!samples || count <= 0 || !atomic_load_explicit(&bus_enabled, memory_order_acquire)) return;
+
+    uint64_t first = atomic_fetch_add_explicit(&bus_header->write_sequence, (uint64_t)count,
+                                               memory_order_relaxed);
+
+    for (int i = 0; i < count; i++) {
+        uint64_t sequence = first + (uint64_t)i;
+        bus_slot_t* slot = &bus_slots[sequence & bus_mask];
+
+        atomic_store_explicit(&slot->sequence, 2 * sequence + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+
+        slot->sample.timestamp_ns = timestamp_to_realtime_ns(samples[i].timestamp);
+        slot->sample.value = samples[i].value;
+        slot->sample.source = (uint16_t)source;
+        slot->sample.type = (uint16_t)samples[i].type;
+        slot->sample.reserved = 0;
+
+        atomic_store_explicit(&slot->sequence, 2 * sequence + 2, memory_order_release);
+    }
+
+    counter_add(published_metric, count);
+}
@@ -0,0 +1,1069 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/daemon.h"
+#include "../include/data_logger.h"
+#include "../include/data_analyzer.h"
+#include "../include/hardware_interface.h"
+#include "../include/writer_pool.h"
+#include "../include/stage_probes.h"
+#include "../include/trace.h"
+#include "../include/bus_publisher.h"
+#include "../include/subscribers.h"
+#include "../include/reorder.h"
+#include "../include/trigger_recorder.h"
+#include "../include/sample_batch.h"
+#include "../include/metrics.h"
+#include "../include/status_renderer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <math.h>
+#include <pthread.h>
+
+#if SAMPLE_BATCH_CAPACITY < DAEMON_MAX_CHANNELS * DAEMON_MAX_DEVICES
+#error "A sample batch must hold one acquisition of every channel of every device"
+#endif
+
+// Batches one profile can hold: two logger reference lists (one being written),
+// the acquired batch and the reorder output
+#define DAEMON_BATCHES_PER_PROFILE (2 * LOGGER_MAX_BATCH_REFS + 2)
+
+// Serial device shared by the profiles that name it
+typedef struct {
+    char path[256];
+    hardware_interface_t hw;
+    pthread_mutex_t lock;
+    int is_open;
+} daemon_device_t;
+
+// Runtime state of one profile
+typedef struct {
+    const profile_config_t* config;
+    data_logger_t logger;
+    int logger_ready;
+    daemon_device_t* devices[DAEMON_MAX_DEVICES];
+    int device_count;
+    reorder_buffer_t reorder;    // Merges device streams by timestamp (multi-device profiles)
+    int reorder_ready;
+    trigger_recorder_t trigger;  // Pre/post-anomaly capture (trigger_pre_ms > 0)
+    int trigger_ready;
+    adaptive_rate_t adaptive;    // Per-channel logging interval (adaptive profiles)
+    int adaptive_ready;
+    status_renderer_t status;    // Prints anomalies off the reactor thread
+    int status_ready;
+    statistics_t stats[DAEMON_MAX_CHANNELS];
+    bridge_accumulator_t bridge_acc;
+    anomaly_config_t anomaly_config;
+    long sample_count;
+    long anomaly_count;
+    long empty_reads;            // Ticks on which no device delivered a sample
+    int bus_source;
+    timestamp_ns_t next_deadline;
+    sample_batch_pool_t* batches;  // Shared pool acquisition fills samples into
+} profile_state_t;
+
+// Acquisition reactor: one thread servicing several profiles by deadline
+typedef struct {
+    profile_state_t* profiles[DAEMON_MAX_PROFILES];
+    int profile_count;
+    volatile int* running;
+    int has_end_time;
+    timestamp_ns_t end_time;
+    realtime_report_t report;
+    pthread_t thread;
+    int thread_started;
+} reactor_t;
+
+// The simulator keeps global state, so reactors take turns using it
+static pthread_mutex_t simulator_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static metrics_counter_t* empty_reads_metric;
+static pthread_once_t daemon_metrics_once = PTHREAD_ONCE_INIT;
+
+static void register_daemon_metrics(void) {
+    empty_reads_metric = register_counter("datalogger_device_empty_reads_total",
+                                          "Acquisition ticks on which no device of a profile delivered a sample");
+}
+
+// Strip leading and trailing whitespace, returns start of text
+static char* trim_line(char* str) {
+    while (isspace((unsigned char)*str)) str++;
+    if (*str == '\0') return str;
+
+    char* end = str + strlen(str) - 1;
+    while (end > str && isspace((unsigned char)*end)) end--;
+    end[1] = '\0';
+
+    return str;
+}
+
+// Profile type name for output
+static const char* profile_type_name(profile_type_t type) {
+    switch (type) {
+        case PROFILE_BRIDGE: return "bridge";
+        case PROFILE_ENVIRONMENTAL: return "environmental";
+        case PROFILE_CUSTOM: return "custom";
+        default: return "unknown";
+    }
+}
+
+// Parse comma separated channel list (e.g. "ACCEL_X,ACCEL_Y,ACCEL_Z")
+static int parse_channel_list(char* value, profile_config_t* profile) {
+    profile->channel_count = 0;
+
+    char* saveptr = NULL;
+    for (char* token = strtok_r(value, ",", &saveptr); token; token = strtok_r(NULL, ",", &saveptr)) {
+        token = trim_line(token);
+        if (profile->channel_count >= DAEMON_MAX_CHANNELS) return -1;
+        if (sensor_type_from_name(token, &profile->channels[profile->channel_count]) != 0) {
+            return -1;
+        }
+        profile->channel_count++;
+    }
+
+    return profile->channel_count > 0 ? 0 : -1;
+}
+
+// Parse comma separated device list (e.g. "/dev/ttyUSB0, /dev/ttyUSB1")
+static int parse_device_list(char* value, profile_config_t* profile) {
+    profile->device_count = 0;
+
+    char* saveptr = NULL;
+    for (char* token = strtok_r(value, ",", &saveptr); token; token = strtok_r(NULL, ",", &saveptr)) {
+        token = trim_line(token);
+        if (*token == '\0') continue;
+        if (profile->device_count >= DAEMON_MAX_DEVICES) return -1;
+        snprintf(profile->devices[profile->device_count++], sizeof(profile->devices[0]), "%s", token);
+    }
+
+    return profile->device_count > 0 ? 0 : -1;
+}
+
+// Parse comma separated channel priorities (e.g. "TEMP:low, VIB:critical")
+static int parse_priority_list(char* value, profile_config_t* profile) {
+    char* saveptr = NULL;
+    for (char* token = strtok_r(value, ",", &saveptr); token; token = strtok_r(NULL, ",", &saveptr)) {
+        char* colon = strchr(token, ':');
+        if (!colon) return -1;
+        *colon = '\0';
+
+        sensor_type_t type;
+        if (sensor_type_from_name(trim_line(token), &type) != 0 ||
+            parse_sample_priority(trim_line(colon + 1), &profile->priorities[type]) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+// Parse an interval range in milliseconds (e.g. "10-1000")
+static int parse_interval_range(const char* value, adaptive_bounds_t* bounds) {
+    char* end = NULL;
+    long min = strtol(value, &end, 10);
+    if (end == value || *end != '-') return -1;
+
+    const char* max_text = end + 1;
+    long max = strtol(max_text, &end, 10);
+    if (end == max_text || *end != '\0' || min <= 0 || max < min || max > 3600000) return -1;
+
+    bounds->min_interval_ms = (int)min;
+    bounds->max_interval_ms = (int)max;
+    return 0;
+}
+
+// Parse comma separated per-channel interval ranges (e.g. "VIB:5-100, TEMP:1000-60000")
+static int parse_adaptive_list(char* value, profile_config_t* profile) {
+    char* saveptr = NULL;
+    for (char* token = strtok_r(value, ",", &saveptr); token; token = strtok_r(NULL, ",", &saveptr)) {
+        char* colon = strchr(token, ':');
+        if (!colon) return -1;
+        *colon = '\0';
+
+        sensor_type_t type;
+        if (sensor_type_from_name(trim_line(token), &type) != 0 ||
+            parse_interval_range(trim_line(colon + 1), &profile->adaptive_bounds[type]) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+// Apply one key/value pair of a [profile] section
+static int apply_profile_setting(profile_config_t* profile, const char* key, char* value) {
+    if (strcmp(key, "type") == 0) {
+        if (strcasecmp(value, "bridge") == 0) {
+            profile->type = PROFILE_BRIDGE;
+        } else if (strcasecmp(value, "environmental") == 0) {
+            profile->type = PROFILE_ENVIRONMENTAL;
+        } else if (strcasecmp(value, "custom") == 0) {
+            profile->type = PROFILE_CUSTOM;
+        } else {
+            return -1;
+        }
+    } else if (strcmp(key, "channels") == 0) {
+        return parse_channel_list(value, profile);
+    } else if (strcmp(key, "interval_ms") == 0) {
+        profile->interval_ms = atoi(value);
+        if (profile->interval_ms <= 0) return -1;
+    } else if (strcmp(key, "threshold") == 0) {
+        profile->threshold = atof(value);
+        if (profile->threshold <= 0) return -1;
+    } else if (strcmp(key, "absolute_threshold") == 0) {
+        profile->absolute_threshold = atof(value);
+        if (profile->absolute_threshold <= 0) return -1;
+    } else if (strcmp(key, "output") == 0) {
+        strncpy(profile->output, value, sizeof(profile->output) - 1);
+        profile->output[sizeof(profile->output) - 1] = '\0';
+    } else if (strcmp(key, "device") == 0 || strcmp(key, "devices") == 0) {
+        return parse_device_list(value, profile);
+    } else if (strcmp(key, "reorder_window_ms") == 0) {
+        profile->reorder_window_ms = atoi(value);
+        if (profile->reorder_window_ms < 0) return -1;
+    } else if (strcmp(key, "trigger_pre_ms") == 0) {
+        profile->trigger_pre_ms = atoi(value);
+        if (profile->trigger_pre_ms < 0) return -1;
+    } else if (strcmp(key, "trigger_post_ms") == 0) {
+        profile->trigger_post_ms = atoi(value);
+        if (profile->trigger_post_ms < 0) return -1;
+    } else if (strcmp(key, "log_decimation") == 0) {
+        profile->log_decimation = atoi(value);
+        if (profile->log_decimation < 1) return -1;
+    } else if (strcmp(key, "overload") == 0) {
+        return parse_overload_policy(value, &profile->overload);
+    } else if (strcmp(key, "priority") == 0 || strcmp(key, "priorities") == 0) {
+        return parse_priority_list(value, profile);
+    } else if (strcmp(key, "adaptive_interval_ms") == 0) {
+        profile->adaptive = 1;
+        return parse_interval_range(value, &profile->adaptive_default);
+    } else if (strcmp(key, "adaptive_channels") == 0) {
+        profile->adaptive = 1;
+        return parse_adaptive_list(value, profile);
+    } else if (strcmp(key, "adaptive_raise") == 0) {
+        profile->adaptive_config.raise_score = atof(value);
+        if (profile->adaptive_config.raise_score <= 0) return -1;
+    } else if (strcmp(key, "adaptive_lower") == 0) {
+        profile->adaptive_config.lower_score = atof(value);
+        if (profile->adaptive_config.lower_score <= 0) return -1;
+    } else if (strcmp(key, "adaptive_hold_ms") == 0) {
+        profile->adaptive_config.hold_ms = atoi(value);
+        if (profile->adaptive_config.hold_ms < 0) return -1;
+    } else {
+        return -1;
+    }
+
+    return 0;
+}
+
+// Apply one key/value pair of the [daemon] section
+static int apply_daemon_setting(daemon_config_t* config, const char* key, const char* value) {
+    if (strcmp(key, "reactors") == 0) {
+        config->reactor_count = atoi(value);
+        if (config->reactor_count <= 0 || config->reactor_count > DAEMON_MAX_REACTORS) return -1;
+    } else if (strcmp(key, "writer_threads") == 0) {
+        config->writer_threads = atoi(value);
+        if (config->writer_threads <= 0 || config->writer_threads > WRITER_POOL_MAX_THREADS) return -1;
+    } else if (strcmp(key, "duration") == 0) {
+        config->duration = atoi(value);
+        if (config->duration < 0) return -1;
+    } else {
+        return -1;
+    }
+
+    return 0;
+}
+
+// Apply one key/value pair of the [uplink] section
+static int apply_uplink_setting(uplink_config_t* uplink, const char* key, const char* value) {
+    if (strcmp(key, "collector") == 0) {
+        return parse_uplink_address(value, uplink);
+    } else if (strcmp(key, "bandwidth_kbps") == 0) {
+        uplink->bandwidth_kbps = atoi(value);
+        if (uplink->bandwidth_kbps < 0) return -1;
+    } else if (strcmp(key, "batch_kb") == 0) {
+        uplink->batch_kb = atoi(value);
+        if (uplink->batch_kb <= 0 || uplink->batch_kb * 1024 > UPLINK_MAX_RECORDS) return -1;
+    } else if (strcmp(key, "drain_ms") == 0) {
+        uplink->drain_ms = atoi(value);
+        if (uplink->drain_ms < 0) return -1;
+    } else {
+        return -1;
+    }
+
+    return 0;
+}
+
+// Fill in defaults that depend on the profile type
+static int finish_profile(profile_config_t* profile) {
+    switch (profile->type) {
+        case PROFILE_BRIDGE:
+            profile->channels[0] = SENSOR_VIBRATION;
+            profile->channel_count = 1;
+            break;
+        case PROFILE_ENVIRONMENTAL:
+            profile->channels[0] = SENSOR_TEMPERATURE;
+            profile->channels[1] = SENSOR_HUMIDITY;
+            profile->channels[2] = SENSOR_PRESSURE;
+            profile->channel_count = 3;
+            break;
+        case PROFILE_CUSTOM:
+            if (profile->channel_count == 0) {
+                fprintf(stderr, "Error: Custom profile '%s' needs a channels list\n", profile->name);
+                return -1;
+            }
+            break;
+    }
+
+    // Only statistical detection unless an absolute limit was configured; bridge
+    // profiles fall back to the daemon-wide limit when the reactors start
+    if (isnan(profile->absolute_threshold) && profile->type != PROFILE_BRIDGE) {
+        profile->absolute_threshold = INFINITY;
+    }
+    if (profile->output[0] == '\0') {
+        snprintf(profile->output, sizeof(profile->output), "%s", profile->name);
+    }
+
+    // Device streams may be up to two sample periods apart unless configured
+    if (profile->reorder_window_ms < 0) profile->reorder_window_ms = 2 * profile->interval_ms;
+
+    // Capture as much after an anomaly as before it unless configured
+    if (profile->trigger_post_ms < 0) profile->trigger_post_ms = profile->trigger_pre_ms;
+    if (profile->log_decimation > 1 && profile->trigger_pre_ms == 0) {
+        fprintf(stderr, "Error: Profile '%s' sets log_decimation without trigger_pre_ms\n", profile->name);
+        return -1;
+    }
+
+    // Channels without a range of their own keep the profile range, or the fixed interval
+    if (profile->adaptive) {
+        if (profile->adaptive_config.lower_score >= profile->adaptive_config.raise_score) {
+            fprintf(stderr, "Error: Profile '%s' needs adaptive_lower below adaptive_raise\n", profile->name);
+            return -1;
+        }
+        if (profile->log_decimation > 1) {
+            fprintf(stderr, "Error: Profile '%s' combines log_decimation with an adaptive rate\n", profile->name);
+            return -1;
+        }
+        for (int i = 0; i < profile->channel_count; i++) {
+            adaptive_bounds_t* bounds = &profile->adaptive_bounds[profile->channels[i]];
+            if (bounds->min_interval_ms > 0) continue;
+            if (profile->adaptive_default.min_interval_ms > 0) {
+                *bounds = profile->adaptive_default;
+            } else {
+                bounds->min_interval_ms = profile->interval_ms;
+                bounds->max_interval_ms = profile->interval_ms;
+            }
+        }
+    }
+
+    return 0;
+}
+
+// Load daemon configuration file
+int load_daemon_config(const char* path, daemon_config_t* config) {
+    if (!path || !config) return -1;
+
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot open config file '%s'\n", path);
+        return -1;
+    }
+
+    memset(config, 0, sizeof(*config));
+    config->reactor_count = 1;
+    config->writer_threads = 1;
+    config->bridge_absolute_limit = BRIDGE_DEFAULT_ABSOLUTE_LIMIT;
+    init_uplink_config(&config->uplink);
+
+    profile_config_t* profile = NULL;
+    int in_daemon_section = 0;
+    int in_uplink_section = 0;
+    int line_number = 0;
+    int result = 0;
+    char line[512];
+
+    while (result == 0 && fgets(line, sizeof(line), file)) {
+        line_number++;
+
+        char* comment = strpbrk(line, "#;");
+        if (comment) *comment = '\0';
+
+        char* text = trim_line(line);
+        if (*text == '\0') continue;
+
+        // Section header
+        if (*text == '[') {
+            char* close = strchr(text, ']');
+            if (!close) {
+                result = -1;
+                break;
+            }
+            *close = '\0';
+            char* section = trim_line(text + 1);
+
+            if (profile && finish_profile(profile) != 0) {
+                result = -1;
+                break;
+            }
+            profile = NULL;
+            in_daemon_section = 0;
+            in_uplink_section = 0;
+
+            if (strcmp(section, "daemon") == 0) {
+                in_daemon_section = 1;
+            } else if (strcmp(section, "uplink") == 0) {
+                in_uplink_section = 1;
+            } else if (strncmp(section, "profile", 7) == 0 && isspace((unsigned char)section[7])) {
+                if (config->profile_count >= DAEMON_MAX_PROFILES) {
+                    fprintf(stderr, "Error: Too many profiles (max %d)\n", DAEMON_MAX_PROFILES);
+                    result = -1;
+                    break;
+                }
+                profile = &config->profiles[config->profile_count++];
+                snprintf(profile->name, sizeof(profile->name), "%s", trim_line(section + 8));
+                profile->type = PROFILE_CUSTOM;
+                profile->interval_ms = 100;
+                profile->threshold = 3.0;
+                profile->absolute_threshold = NAN;
+                profile->reorder_window_ms = -1;
+                profile->trigger_post_ms = -1;
+                profile->log_decimation = 1;
+                profile->overload = OVERLOAD_BLOCK;
+                for (int type = 0; type < SENSOR_TYPE_COUNT; type++) {
+                    profile->priorities[type] = default_sample_priority((sensor_type_t)type);
+                }
+                init_adaptive_config(&profile->adaptive_config);
+            } else {
+                result = -1;
+            }
+            continue;
+        }
+
+        // key = value
+        char* equals = strchr(text, '=');
+        if (!equals) {
+            result = -1;
+            break;
+        }
+        *equals = '\0';
+        char* key = trim_line(text);
+        char* value = trim_line(equals + 1);
+
+        if (profile) {
+            result = apply_profile_setting(profile, key, value);
+        } else if (in_daemon_section) {
+            result = apply_daemon_setting(config, key, value);
+        } else if (in_uplink_section) {
+            result = apply_uplink_setting(&config->uplink, key, value);
+        } else {
+            result = -1;
+        }
+    }
+
+    if (result == 0 && profile) {
+        result = finish_profile(profile);
+    } else if (result != 0) {
+        fprintf(stderr, "Error: Invalid config file '%s' at line %d\n", path, line_number);
+    }
+
+    fclose(file);
+
+    if (result == 0 && config->profile_count == 0) {
+        fprintf(stderr, "Error: Config file '%s' defines no profiles\n", path);
+        result = -1;
+    }
+
+    // Profiles must not share a log file
+    for (int i = 0; result == 0 && i < config->profile_count; i++) {
+        for (int j = i + 1; j < config->profile_count; j++) {
+            if (strcmp(config->profiles[i].output, config->profiles[j].output) == 0) {
+                fprintf(stderr, "Error: Profiles '%s' and '%s' use the same output '%s'\n",
+                        config->profiles[i].name, config->profiles[j].name,
+                        config->profiles[i].output);
+                result = -1;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+// Print loaded configuration
+void print_daemon_config(const daemon_config_t* config) {
+    if (!config) return;
+
+    printf("Daemon: %d profile(s), %d reactor(s), %d writer thread(s), duration: ",
+           config->profile_count, config->reactor_count, config->writer_threads);
+    if (config->duration > 0) {
+        printf("%d s\n", config->duration);
+    } else {
+        printf("until stopped\n");
+    }
+
+    for (int i = 0; i < config->profile_count; i++) {
+        const profile_config_t* profile = &config->profiles[i];
+        printf("  [%s] %s, %d channel(s), every %d ms, source: ",
+               profile->name, profile_type_name(profile->type), profile->channel_count,
+               profile->interval_ms);
+        if (profile->device_count == 0) {
+            printf("simulated");
+        }
+        for (int d = 0; d < profile->device_count; d++) {
+            printf("%s%s", d ? ", " : "", profile->devices[d]);
+        }
+        if (profile->device_count > 1) {
+            printf(" (merged, %d ms window)", profile->reorder_window_ms);
+        }
+        if (profile->overload != OVERLOAD_BLOCK) {
+            printf(", overload: %s", overload_policy_name(profile->overload));
+        }
+        if (profile->adaptive) {
+            printf(", adaptive rate");
+        }
+        printf("\n");
+    }
+
+    if (config->uplink.host[0] != '\0') {
+        printf("  Uplink: %s:%d, %d KiB batches, ", config->uplink.host, config->uplink.port,
+               config->uplink.batch_kb);
+        if (config->uplink.bandwidth_kbps > 0) {
+            printf("%d kbit/s\n", config->uplink.bandwidth_kbps);
+        } else {
+            printf("unlimited bandwidth\n");
+        }
+    }
+}
+
+// Channel index of a sensor type within a profile (-1 if not part of it)
+static int profile_channel_index(const profile_config_t* config, sensor_type_t type) {
+    for (int i = 0; i < config->channel_count; i++) {
+        if (config->channels[i] == type) return i;
+    }
+    return -1;
+}
+
+// Generate simulated samples for a profile
+static int simulate_profile_samples(const profile_config_t* config, sensor_data_t* samples) {
+    int count = 0;
+
+    pthread_mutex_lock(&simulator_lock);
+    switch (config->type) {
+        case PROFILE_BRIDGE:
+            samples[0] = generate_bridge_vibration_data();
+            count = 1;
+            break;
+        case PROFILE_ENVIRONMENTAL:
+            generate_environmental_data_set(samples, &count);
+            break;
+        case PROFILE_CUSTOM: {
+            timestamp_ns_t now = get_current_time();
+            for (int i = 0; i < config->channel_count; i++) {
+                samples[count++] = generate_sensor_data_at(config->channels[i], now);
+            }
+            break;
+        }
+    }
+    pthread_mutex_unlock(&simulator_lock);
+
+    return count;
+}
+
+// Acquire one sample set for a profile; streams[i] is the device index of samples[i]
+static int acquire_profile_samples(profile_state_t* state, sensor_data_t* samples, int* streams) {
+    const profile_config_t* config = state->config;
+    int count = 0;
+
+    for (int d = 0; d < state->device_count; d++) {
+        daemon_device_t* device = state->devices[d];
+
+        // One read per device and tick; lines are timestamped by byte position
+        pthread_mutex_lock(&device->lock);
+        int parsed = read_sensor_batch_from_hardware(&device->hw, &samples[count],
+                                                     config->channel_count, 0);
+        pthread_mutex_unlock(&device->lock);
+
+        for (int i = 0; i < parsed; i++) {
+            streams[count++] = d;
+        }
+    }
+
+    if (count > 0) return count;
+
+    // Only a profile without devices is simulated; a silent device is a gap, not fake data
+    if (state->device_count > 0) {
+        if (state->empty_reads++ == 0) {
+            fprintf(stderr, "Warning: [%s] No samples from its devices; such ticks are counted and skipped\n",
+                    config->name);
+        }
+        counter_add(empty_reads_metric, 1);
+        return 0;
+    }
+
+    count = simulate_profile_samples(config, samples);
+    for (int i = 0; i < count; i++) {
+        streams[i] = 0;
+    }
+    return count;
+}
+
+// Analyze one sample (in timestamp order); returns 1 when the main log keeps it
+static int process_profile_sample(profile_state_t* state, const sensor_data_t* data) {
+    int channel = profile_channel_index(state->config, data->type);
+
+    // Raw samples go to the pre-trigger ring; the main log may keep only some
+    int keep = state->trigger_ready ? record_trigger_sample(&state->trigger, data) : 1;
+
+    if (channel >= 0) {
+        int is_anomaly = 0;
+        statistics_t* stats = &state->stats[channel];
+        update_statistics(stats, data->value);
+
+        if (state->config->type == PROFILE_BRIDGE) {
+            update_bridge_accumulator(&state->bridge_acc, data->value);
+        }
+
+        if (stats->sample_count > state->anomaly_config.min_samples_for_analysis) {
+            finalize_statistics(stats);
+            anomaly_result_t anomaly = detect_anomaly(data, stats, &state->anomaly_config);
+            if (anomaly.is_anomaly) {
+                is_anomaly = 1;
+                state->anomaly_count++;
+                post_status_anomaly(&state->status, &anomaly);
+                if (state->trigger_ready) fire_trigger(&state->trigger, data, anomaly.description);
+            }
+        }
+
+        // Every sample feeds the controller; the log keeps those on the channel's interval
+        if (state->adaptive_ready) {
+            keep &= update_adaptive_rate(&state->adaptive, channel, data, is_anomaly);
+        }
+    }
+
+    return keep;
+}
+
+// Hand timestamp-ordered samples to subscribers, analysis and the logger.
+// samples are batch->samples when batch is not NULL.
+static void process_ordered_samples(profile_state_t* state, sample_batch_t* batch,
+                                    const sensor_data_t* samples, int count) {
+    // Without decimation the logger keeps every sample, so it takes the batch by reference
+    int by_reference = batch && state->config->log_decimation <= 1 && !state->adaptive_ready;
+
+    dispatch_subscriber_samples(samples, count);
+    for (int i = 0; i < count; i++) {
+        int keep = process_profile_sample(state, &samples[i]);
+        if (keep && !by_reference) log_sensor_data(&state->logger, &samples[i]);
+    }
+
+    if (by_reference) {
+        batch->count = count;
+        log_sample_batch(&state->logger, batch);
+    }
+}
+
+// Merge, analyze and log one sample set (batch may be NULL if the pool ran dry)
+static void process_profile_samples(profile_state_t* state, sample_batch_t* batch,
+                                    const sensor_data_t* samples, const int* streams, int count) {
+    publish_bus_samples(state->bus_source, samples, count);
+
+    if (!state->reorder_ready) {
+        process_ordered_samples(state, batch, samples, count);
+        state->sample_count++;
+        return;
+    }
+
+    // Everything past the reorder stage sees one timestamp-ordered stream,
+    // popped straight into a batch of its own
+    sensor_data_t fallback[SAMPLE_BATCH_CAPACITY];
+    sample_batch_t* ordered_batch = acquire_sample_batch(state->batches);
+    sensor_data_t* ordered = ordered_batch ? ordered_batch->samples : fallback;
+    int ordered_count = 0;
+
+    for (int i = 0; i < count; i++) {
+        push_reorder_sample(&state->reorder, streams[i], &samples[i]);
+
+        while (pop_reorder_sample(&state->reorder, &ordered[ordered_count], 0)) {
+            if (++ordered_count == SAMPLE_BATCH_CAPACITY) {
+                process_ordered_samples(state, ordered_batch, ordered, ordered_count);
+                release_sample_batch(ordered_batch);
+
+                ordered_batch = acquire_sample_batch(state->batches);
+                ordered = ordered_batch ? ordered_batch->samples : fallback;
+                ordered_count = 0;
+            }
+        }
+    }
+
+    process_ordered_samples(state, ordered_batch, ordered, ordered_count);
+    release_sample_batch(ordered_batch);
+    state->sample_count++;
+}
+
+// Emit samples still held by the reorder stage at shutdown
+static void drain_profile_reorder(profile_state_t* state) {
+    if (!state->reorder_ready) return;
+
+    sensor_data_t data;
+    while (pop_reorder_sample(&state->reorder, &data, 1)) {
+        process_ordered_samples(state, NULL, &data, 1);
+    }
+}
+
+// Reactor thread: service the profile whose deadline comes first
+static void* reactor_thread(void* arg) {
+    reactor_t* reactor = arg;
+    sensor_data_t fallback[DAEMON_MAX_CHANNELS * DAEMON_MAX_DEVICES];
+    int streams[DAEMON_MAX_CHANNELS * DAEMON_MAX_DEVICES];
+
+    trace_set_thread_name("reactor");
+
+    while (*reactor->running) {
+        profile_state_t* next = reactor->profiles[0];
+        for (int i = 1; i < reactor->profile_count; i++) {
+            if (reactor->profiles[i]->next_deadline < next->next_deadline) {
+                next = reactor->profiles[i];
+            }
+        }
+
+        if (reactor->has_end_time && next->next_deadline >= reactor->end_time) {
+            break;
+        }
+
+        // Adaptive profiles acquire at the rate of their most active channel
+        int interval_ms = next->adaptive_ready ? adaptive_acquisition_interval_ms(&next->adaptive)
+                                               : next->config->interval_ms;
+        int64_t period_ns = (int64_t)interval_ms * NS_PER_MS;
+        trace_begin("wait");
+        wait_until_deadline(next->next_deadline, period_ns, &reactor->report);
+        trace_end("wait");
+        if (!*reactor->running) break;
+
+        // Samples are written once into a pooled batch and read in place downstream
+        sample_batch_t* batch = acquire_sample_batch(next->batches);
+        sensor_data_t* samples = batch ? batch->samples : fallback;
+
+        PROBE_BEGIN(probe_start);
+        trace_begin("acquire");
+        int count = acquire_profile_samples(next, samples, streams);
+        trace_end("acquire");
+        PROBE_END(STAGE_ACQUISITION, probe_start);
+        if (batch) batch->count = count;
+        if (count > 0) {
+            trace_begin("analyze");
+            process_profile_samples(next, batch, samples, streams, count);
+            trace_end("analyze");
+        }
+        release_sample_batch(batch);
+
+        // Schedule next sample, skipping periods that were missed entirely
+        timestamp_ns_t now = get_current_time();
+        next->next_deadline += period_ns;
+        if (next->next_deadline < now) {
+            next->next_deadline = now + period_ns;
+        }
+    }
+
+    return NULL;
+}
+
+// Find or open the shared device for a path
+static daemon_device_t* open_shared_device(daemon_device_t* devices, int* device_count, const char* path) {
+    for (int i = 0; i < *device_count; i++) {
+        if (strcmp(devices[i].path, path) == 0) {
+            return devices[i].is_open ? &devices[i] : NULL;
+        }
+    }
+
+    daemon_device_t* device = &devices[(*device_count)++];
+    snprintf(device->path, sizeof(device->path), "%s", path);
+    pthread_mutex_init(&device->lock, NULL);
+    device->is_open = init_hardware_interface(&device->hw, path) == 0;
+
+    if (!device->is_open) {
+        fprintf(stderr, "Warning: Device '%s' unavailable, using simulated data\n", path);
+        return NULL;
+    }
+
+    return device;
+}
+
+// Print final results for one profile
+static void print_profile_summary(profile_state_t* state) {
+    const profile_config_t* config = state->config;
+
+    printf("\n##### Profile '%s' (%s) #####\n", config->name, profile_type_name(config->type));
+
+    static const char* channel_names[] = {
+        "Temperature", "Vibration", "Strain", "Humidity",
+        "Pressure", "Accel_X", "Accel_Y", "Accel_Z"
+    };
+
+    for (int i = 0; i < config->channel_count; i++) {
+        char name[96];
+        snprintf(name, sizeof(name), "%s / %s", config->name,
+                 config->type == PROFILE_BRIDGE ? "Bridge Vibration" : channel_names[config->channels[i]]);
+        finalize_statistics(&state->stats[i]);
+        print_statistics(&state->stats[i], name);
+    }
+
+    if (config->type == PROFILE_BRIDGE) {
+        bridge_analysis_t analysis = finalize_bridge_accumulator(&state->bridge_acc);
+        print_bridge_analysis(&analysis);
+    }
+
+    printf("\nSummary:\n");
+    printf("- Sample sets: %ld\n", state->sample_count);
+    printf("- Anomalies detected: %ld\n", state->anomaly_count);
+    if (state->empty_reads > 0) {
+        printf("- Ticks without device data: %ld\n", state->empty_reads);
+    }
+    if (state->reorder_ready) {
+        printf("- Devices merged: %d, late samples dropped: %ld", state->device_count, state->reorder.late);
+        for (int d = 0; d < state->device_count; d++) {
+            printf("%s%s: %ld", d ? ", " : " (", state->config->devices[d], state->reorder.streams[d].late);
+        }
+        printf(")\n");
+    }
+    printf("- Data logged to: %s\n", state->logger.current_filename);
+
+    if (state->adaptive_ready) print_adaptive_summary(&state->adaptive, config->channels);
+    if (state->trigger_ready) print_trigger_summary(&state->trigger);
+}
+
+// Run all profiles concurrently
+int run_daemon(const daemon_config_t* config, const realtime_config_t* rt_config,
+               volatile int* running, realtime_report_t* rt_report) {
+    if (!config || !running || config->profile_count == 0) return -1;
+
+    printf("\n=== Multi-Profile Daemon Mode ===\n");
+    print_daemon_config(config);
+
+    profile_state_t* states = calloc(config->profile_count, sizeof(profile_state_t));
+    daemon_device_t* devices = calloc(config->profile_count * DAEMON_MAX_DEVICES, sizeof(daemon_device_t));
+    reactor_t* reactors = calloc(config->reactor_count, sizeof(reactor_t));
+    writer_pool_t writer_pool;
+    sample_batch_pool_t batch_pool;
+    uplink_t uplink;
+    int uplink_started = 0;
+    int device_count = 0;
+    int result = 0;
+
+    if (!states || !devices || !reactors) {
+        fprintf(stderr, "Memory allocation failed\n");
+        free(states);
+        free(devices);
+        free(reactors);
+        return -1;
+    }
+
+    // Writers are shared by every profile so disk access is serialized here
+    int writer_cpu = rt_config && rt_config->enabled ? rt_config->writer_cpu : -1;
+    if (init_writer_pool(&writer_pool, config->writer_threads, writer_cpu) != 0) {
+        fprintf(stderr, "Failed to start writer pool\n");
+        free(states);
+        free(devices);
+        free(reactors);
+        return -1;
+    }
+
+    // Every batch a profile can hold at once, so acquisition never allocates
+    if (init_sample_batch_pool(&batch_pool, config->profile_count * DAEMON_BATCHES_PER_PROFILE) != 0) {
+        cleanup_writer_pool(&writer_pool);
+        free(states);
+        free(devices);
+        free(reactors);
+        return -1;
+    }
+
+    init_sensor_simulator();
+    pthread_once(&daemon_metrics_once, register_daemon_metrics);
+
+    timestamp_ns_t start = get_current_time();
+
+    for (int i = 0; i < config->profile_count; i++) {
+        profile_state_t* state = &states[i];
+        state->config = &config->profiles[i];
+        state->batches = &batch_pool;
+
+        if (init_data_logger(&state->logger, state->config->output) != 0) {
+            fprintf(stderr, "Failed to initialize data logger for profile '%s'\n", state->config->name);
+            result = -1;
+            break;
+        }
+        state->logger_ready = 1;
+        attach_writer_pool(&state->logger, &writer_pool);
+        set_logger_overload_policy(&state->logger, state->config->overload, state->config->priorities);
+
+        for (int d = 0; d < state->config->device_count; d++) {
+            daemon_device_t* device = open_shared_device(devices, &device_count, state->config->devices[d]);
+            if (device) state->devices[state->device_count++] = device;
+        }
+
+        // Devices are read one after another, so their samples must be merged by timestamp
+        if (state->device_count > 1) {
+            if (init_reorder_buffer(&state->reorder, state->device_count,
+                                    state->config->reorder_window_ms, 0) != 0) {
+                fprintf(stderr, "Failed to initialize reorder buffer for profile '%s'\n", state->config->name);
+                result = -1;
+                break;
+            }
+            state->reorder_ready = 1;
+        }
+
+        // Full-rate context around anomalies, decimated main log otherwise
+        if (state->config->trigger_pre_ms > 0) {
+            trigger_config_t trigger_config;
+            trigger_config.pre_ms = state->config->trigger_pre_ms;
+            trigger_config.post_ms = state->config->trigger_post_ms;
+            trigger_config.interval_ms = state->config->interval_ms;
+            for (int c = 0; state->config->adaptive && c < state->config->channel_count; c++) {
+                int fastest = state->config->adaptive_bounds[state->config->channels[c]].min_interval_ms;
+                if (fastest < trigger_config.interval_ms) trigger_config.interval_ms = fastest;
+            }
+            trigger_config.decimation = state->config->log_decimation;
+            trigger_config.channel_mask = 0;
+            for (int c = 0; c < state->config->channel_count; c++) {
+                trigger_config.channel_mask |= 1u << state->config->channels[c];
+            }
+            if (init_trigger_recorder(&state->trigger, state->config->output, &trigger_config) != 0) {
+                fprintf(stderr, "Failed to initialize trigger capture for profile '%s'\n", state->config->name);
+                result = -1;
+                break;
+            }
+            state->trigger_ready = 1;
+        }
+
+        for (int c = 0; c < state->config->channel_count; c++) {
+            init_statistics(&state->stats[c]);
+        }
+
+        if (state->config->adaptive) {
+            adaptive_bounds_t bounds[DAEMON_MAX_CHANNELS];
+            for (int c = 0; c < state->config->channel_count; c++) {
+                bounds[c] = state->config->adaptive_bounds[state->config->channels[c]];
+            }
+            if (init_adaptive_rate(&state->adaptive, &state->config->adaptive_config, bounds,
+                                   state->config->channel_count, state->config->interval_ms) != 0) {
+                fprintf(stderr, "Failed to initialize adaptive rate for profile '%s'\n", state->config->name);
+                result = -1;
+                break;
+            }
+            state->adaptive_ready = 1;
+        }
+        init_bridge_accumulator(&state->bridge_acc);
+
+        // Reactors only queue anomaly reports; console output happens on the renderer
+        init_status_renderer(&state->status, 0);
+        set_status_headless(&state->status, state->config->name);
+        if (start_status_renderer(&state->status) != 0) {
+            result = -1;
+            break;
+        }
+        state->status_ready = 1;
+        state->bus_source = register_bus_source(state->config->name);
+
+        state->anomaly_config.threshold_multiplier = state->config->threshold;
+        state->anomaly_config.absolute_threshold = isnan(state->config->absolute_threshold)
+            ? config->bridge_absolute_limit : state->config->absolute_threshold;
+        state->anomaly_config.window_size = 50;
+        state->anomaly_config.min_samples_for_analysis = 20;
+
+        state->next_deadline = start;
+
+        // Assign profiles to reactors round-robin
+        reactor_t* reactor = &reactors[i % config->reactor_count];
+        reactor->profiles[reactor->profile_count++] = state;
+    }
+
+    // The uplink forwards the loggers' own segment files, so it only needs their names
+    if (result == 0 && config->uplink.host[0] != '\0') {
+        const char* names[DAEMON_MAX_PROFILES];
+        for (int i = 0; i < config->profile_count; i++) {
+            names[i] = config->profiles[i].output;
+        }
+        if (start_uplink(&uplink, &config->uplink, states[0].logger.config.directory,
+                         names, config->profile_count) != 0) {
+            fprintf(stderr, "Failed to start uplink\n");
+            result = -1;
+        } else {
+            uplink_started = 1;
+        }
+    }
+
+    // Start reactors (they inherit real-time policy and pinning from this thread)
+    for (int r = 0; result == 0 && r < config->reactor_count; r++) {
+        reactor_t* reactor = &reactors[r];
+        if (reactor->profile_count == 0) continue;
+
+        reactor->running = running;
+        init_realtime_report(&reactor->report);
+        if (config->duration > 0) {
+            reactor->has_end_time = 1;
+            reactor->end_time = start + (int64_t)config->duration * NS_PER_SEC;
+        }
+
+        if (pthread_create(&reactor->thread, NULL, reactor_thread, reactor) != 0) {
+            fprintf(stderr, "Error: Cannot start reactor thread %d\n", r);
+            *running = 0;
+            result = -1;
+            break;
+        }
+        reactor->thread_started = 1;
+    }
+
+    if (result == 0) {
+        printf("Daemon running. Press Ctrl+C or send SIGTERM to stop\n\n");
+    }
+
+    for (int r = 0; r < config->reactor_count; r++) {
+        if (reactors[r].thread_started) {
+            pthread_join(reactors[r].thread, NULL);
+            if (rt_report) merge_realtime_report(rt_report, &reactors[r].report);
+        }
+    }
+
+    printf("\nAll profiles stopped.\n");
+
+    // Loggers drain through the pool before the pool shuts down
+    for (int i = 0; i < config->profile_count; i++) {
+        if (states[i].logger_ready) {
+            drain_profile_reorder(&states[i]);
+            flush_trigger_recorder(&states[i].trigger);
+            // Anomaly reports still queued come out before the summary
+            if (states[i].status_ready) stop_status_renderer(&states[i].status);
+            if (result == 0) print_profile_summary(&states[i]);
+            cleanup_data_logger(&states[i].logger);
+        }
+        if (states[i].reorder_ready) {
+            cleanup_reorder_buffer(&states[i].reorder);
+        }
+        if (states[i].trigger_ready) {
+            cleanup_trigger_recorder(&states[i].trigger);
+        }
+    }
+    cleanup_writer_pool(&writer_pool);
+    if (result == 0) print_sample_batch_report(&batch_pool);
+
+    // Everything is on disk now; forward the tail while the drain time lasts
+    if (uplink_started) {
+        stop_uplink(&uplink);
+        if (result == 0) print_uplink_report(&uplink);
+    }
+    cleanup_sample_batch_pool(&batch_pool);
+
+    for (int d = 0; d < device_count; d++) {
+        if (devices[d].is_open) cleanup_hardware_interface(&devices[d].hw);
+        pthread_mutex_destroy(&devices[d].lock);
+    }
+
+    cleanup_sensor_simulator();
+
+    free(states);
+    free(devices);
+    free(reactors);
+
+    return result;
+}
@@ -1,8 +1,25 @@
 #include "../include/data_analyzer.h"
+#include "../include/metrics.h"
+#include "../include/stage_probes.h"
+#include "../include/task_pool.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <pthread.h>
+
+// Analyzer metrics
+static metrics_counter_t* anomaly_checks_metric;
+static metrics_counter_t* anomalies_metric;
+static pthread_once_t analyzer_metrics_once = PTHREAD_ONCE_INIT;
+
+// Register analyzer metrics
+static void register_analyzer_metrics(void) {
+    anomaly_checks_metric = register_counter("datalogger_anomaly_checks_total",
+                                             "Samples evaluated by detect_anomaly");
+    anomalies_metric = register_counter("datalogger_anomalies_total",
+                                        "Samples flagged as anomalies");
+}
 
 // Initialize statistics structure
 void init_statistics(statistics_t* stats) {
@@ -23,12 +40,16 @@ void init_statistics(statistics_t* stats) {
 void update_statistics(statistics_t* stats, double value) {
     if (!stats) return;
     
+    PROBE_BEGIN(probe_start);
+    
     stats->sample_count++;
     stats->sum += value;
     stats->sum_squares += value * value;
     
     if (value < stats->min) stats->min = value;
     if (value > stats->max) stats->max = value;
+    
+    PROBE_END(STAGE_UPDATE_STATISTICS, probe_start);
 }
 
 // Calculate final statistics (call after all data points added)
@@ -47,13 +68,76 @@ void finalize_statistics(statistics_t* stats) {
     stats->median = stats->mean;
 }
 
-// Initialize moving average filter
-int init_moving_average(moving_average_t* ma, int window_size) {
-    if (!ma || window_size <= 0) return -1;
+// Initialize analysis context
+int init_analysis_context(analysis_context_t* context, size_t scratch_bytes) {
+    if (!context) return -1;
+    
+    if (scratch_bytes == 0) scratch_bytes = ANALYSIS_SCRATCH_BYTES;
     
-    ma->buffer = malloc(window_size * sizeof(double));
-    if (!ma->buffer) return -1;
+    if (init_scratch_arena(&context->persistent, ANALYSIS_PERSISTENT_BYTES) != 0) {
+        return -1;
+    }
+    if (init_scratch_arena(&context->scratch, scratch_bytes) != 0) {
+        cleanup_scratch_arena(&context->persistent);
+        return -1;
+    }
+    context->cycles = 0;
     
+    return 0;
+}
+
+// Release the previous cycle's temporaries
+void begin_analysis_cycle(analysis_context_t* context) {
+    if (!context) return;
+    
+    reset_scratch_arena(&context->scratch);
+    context->cycles++;
+}
+
+// Free both arenas
+void cleanup_analysis_context(analysis_context_t* context) {
+    if (!context) return;
+    
+    cleanup_scratch_arena(&context->scratch);
+    cleanup_scratch_arena(&context->persistent);
+}
+
+// Per-thread contexts, freed by the key destructor when their thread exits
+static pthread_key_t thread_context_key;
+static pthread_once_t thread_context_once = PTHREAD_ONCE_INIT;
+static __thread analysis_context_t* thread_context = NULL;
+
+static void free_thread_context(void* context) {
+    cleanup_analysis_context(context);
+    free(context);
+}
+
+static void create_thread_context_key(void) {
+    pthread_key_create(&thread_context_key, free_thread_context);
+}
+
+// Context of the calling thread, created on first use
+analysis_context_t* thread_analysis_context(void) {
+    if (thread_context) return thread_context;
+    
+    pthread_once(&thread_context_once, create_thread_context_key);
+    
+    analysis_context_t* context = malloc(sizeof(analysis_context_t));
+    if (!context) return NULL;
+    if (init_analysis_context(context, 0) != 0) {
+        free(context);
+        return NULL;
+    }
+    
+    pthread_setspecific(thread_context_key, context);
+    thread_context = context;
+    return context;
+}
+
+// Set up a moving average over a caller-provided buffer
+static void setup_moving_average(moving_average_t* ma, double* buffer, int window_size, int owns_buffer) {
+    ma->buffer = buffer;
+    ma->owns_buffer = owns_buffer;
     ma->buffer_size = window_size;
     ma->current_index = 0;
     ma->sample_count = 0;
@@ -63,7 +147,27 @@ int init_moving_average(moving_average_t* ma, int window_size) {
     for (int i = 0; i < window_size; i++) {
         ma->buffer[i] = 0.0;
     }
+}
+
+// Initialize moving average filter
+int init_moving_average(moving_average_t* ma, int window_size) {
+    if (!ma || window_size <= 0) return -1;
     
+    double* buffer = malloc(window_size * sizeof(double));
+    if (!buffer) return -1;
+    
+    setup_moving_average(ma, buffer, window_size, 1);
+    return 0;
+}
+
+// Initialize moving average filter in a context's persistent arena
+int init_moving_average_in(moving_average_t* ma, int window_size, analysis_context_t* context) {
+    if (!ma || !context || window_size <= 0) return -1;
+    
+    double* buffer = scratch_alloc(&context->persistent, window_size * sizeof(double));
+    if (!buffer) return -1;
+    
+    setup_moving_average(ma, buffer, window_size, 0);
     return 0;
 }
 
@@ -98,10 +202,10 @@ double get_moving_average(moving_average_t* ma) {
 void cleanup_moving_average(moving_average_t* ma) {
     if (!ma) return;
     
-    if (ma->buffer) {
+    if (ma->buffer && ma->owns_buffer) {
         free(ma->buffer);
-        ma->buffer = NULL;
     }
+    ma->buffer = NULL;
     
     ma->buffer_size = 0;
     ma->current_index = 0;
@@ -122,6 +226,10 @@ anomaly_result_t detect_anomaly(const sensor_data_t* data, const statistics_t* b
         return result;
     }
     
+    PROBE_BEGIN(probe_start);
+    pthread_once(&analyzer_metrics_once, register_analyzer_metrics);
+    counter_add(anomaly_checks_metric, 1);
+    
     double deviation = fabs(data->value - baseline_stats->mean);
     double threshold = config->threshold_multiplier * baseline_stats->std_deviation;
     
@@ -143,30 +251,96 @@ anomaly_result_t detect_anomaly(const sensor_data_t* data, const statistics_t* b
         }
     }
     
+    if (result.is_anomaly) {
+        counter_add(anomalies_metric, 1);
+    }
+    
+    PROBE_END(STAGE_DETECT_ANOMALY, probe_start);
+    
     return result;
 }
 
+// Statistics of a range of samples
+static void reduce_statistics(void* context, int begin, int end, void* partial) {
+    const sensor_data_t* data_array = context;
+    
+    for (int i = begin; i < end; i++) {
+        update_statistics(partial, data_array[i].value);
+    }
+}
+
+// Merge the statistics of the following range
+static void combine_statistics(void* result, const void* partial) {
+    statistics_t* stats = result;
+    const statistics_t* range = partial;
+    
+    stats->sample_count += range->sample_count;
+    stats->sum += range->sum;
+    stats->sum_squares += range->sum_squares;
+    if (range->min < stats->min) stats->min = range->min;
+    if (range->max > stats->max) stats->max = range->max;
+}
+
+// Samples checked against one baseline
+typedef struct {
+    const sensor_data_t* data_array;
+    const statistics_t* baseline;
+    const anomaly_config_t* config;
+    anomaly_result_t* results;
+} anomaly_batch_t;
+
+// Check a range of samples and count its anomalies
+static void reduce_anomalies(void* context, int begin, int end, void* partial) {
+    const anomaly_batch_t* batch = context;
+    int* anomaly_count = partial;
+    
+    for (int i = begin; i < end; i++) {
+        batch->results[i] = detect_anomaly(&batch->data_array[i], batch->baseline, batch->config);
+        if (batch->results[i].is_anomaly) {
+            (*anomaly_count)++;
+        }
+    }
+}
+
+static void combine_counts(void* result, const void* partial) {
+    *(int*)result += *(const int*)partial;
+}
+
+// Partials of parallel reductions come from the calling thread's scratch arena
+static scratch_arena_t* thread_scratch(void) {
+    analysis_context_t* context = thread_analysis_context();
+    return context ? &context->scratch : NULL;
+}
+
 // Detect anomalies in a data array
 int detect_anomalies_batch(const sensor_data_t* data_array, int count, 
                           const anomaly_config_t* config, anomaly_result_t* results) {
     if (!data_array || !config || !results || count <= 0) return -1;
     
+    scratch_arena_t* scratch = count > ANALYSIS_PARALLEL_GRAIN ? thread_scratch() : NULL;
+    
     // Calculate baseline statistics
-    statistics_t baseline;
-    init_statistics(&baseline);
+    statistics_t identity;
+    init_statistics(&identity);
     
-    for (int i = 0; i < count; i++) {
-        update_statistics(&baseline, data_array[i].value);
+    task_reduce_t statistics_reduce = {
+        sizeof(statistics_t), &identity, reduce_statistics, combine_statistics, (void*)data_array
+    };
+    statistics_t baseline;
+    if (parallel_reduce(&statistics_reduce, count, ANALYSIS_PARALLEL_GRAIN, &baseline, scratch) != 0) {
+        return -1;
     }
     finalize_statistics(&baseline);
     
     // Detect anomalies
-    int anomaly_count = 0;
-    for (int i = 0; i < count; i++) {
-        results[i] = detect_anomaly(&data_array[i], &baseline, config);
-        if (results[i].is_anomaly) {
-            anomaly_count++;
-        }
+    anomaly_batch_t batch = { data_array, &baseline, config, results };
+    int no_anomalies = 0;
+    task_reduce_t anomaly_reduce = {
+        sizeof(int), &no_anomalies, reduce_anomalies, combine_counts, &batch
+    };
+    int anomaly_count;
+    if (parallel_reduce(&anomaly_reduce, count, ANALYSIS_PARALLEL_GRAIN, &anomaly_count, scratch) != 0) {
+        return -1;
     }
     
     return anomaly_count;
@@ -250,12 +424,41 @@ double calculate_rate_of_change(const sensor_data_t* data_array, int count, int
     if (start_idx >= end_idx) return 0.0;
     
     double value_change = data_array[end_idx].value - data_array[start_idx].value;
-    double time_change = time_diff_ms(data_array[start_idx].timestamp, 
-                                     data_array[end_idx].timestamp) / 1000.0; // Convert to seconds
+    double time_change = (double)(data_array[end_idx].timestamp -
+                                  data_array[start_idx].timestamp) / NS_PER_SEC;
     
     return (time_change > 0) ? value_change / time_change : 0.0;
 }
 
+// Local maxima among interior points
+typedef struct {
+    long peak_count;
+    double amplitude;       // Highest peak, at least 0
+} spectrum_peaks_t;
+
+// Find the peaks of a range of interior points (index 0 is values[1])
+static void reduce_spectrum_peaks(void* context, int begin, int end, void* partial) {
+    const double* values = context;
+    spectrum_peaks_t* peaks = partial;
+    
+    for (int i = begin + 1; i < end + 1; i++) {
+        if (values[i] > values[i-1] && values[i] > values[i+1]) {
+            peaks->peak_count++;
+            if (values[i] > peaks->amplitude) {
+                peaks->amplitude = values[i];
+            }
+        }
+    }
+}
+
+static void combine_spectrum_peaks(void* result, const void* partial) {
+    spectrum_peaks_t* peaks = result;
+    const spectrum_peaks_t* range = partial;
+    
+    peaks->peak_count += range->peak_count;
+    if (range->amplitude > peaks->amplitude) peaks->amplitude = range->amplitude;
+}
+
 // Simplified frequency analysis (peak detection)
 int analyze_frequency_spectrum(const double* values, int count, double* dominant_frequency, 
                               double* amplitude) {
@@ -265,27 +468,107 @@ int analyze_frequency_spectrum(const double* values, int count, double* dominant
     *amplitude = 0.0;
     
     // Simple peak detection approach
-    int peak_count = 0;
     double total_time = count * 0.1; // Assuming 100ms intervals
     
-    for (int i = 1; i < count - 1; i++) {
-        if (values[i] > values[i-1] && values[i] > values[i+1]) {
-            peak_count++;
-            if (values[i] > *amplitude) {
-                *amplitude = values[i];
-            }
-        }
+    static const spectrum_peaks_t no_peaks = { 0, 0.0 };
+    task_reduce_t peaks_reduce = {
+        sizeof(spectrum_peaks_t), &no_peaks, reduce_spectrum_peaks, combine_spectrum_peaks, (void*)values
+    };
+    spectrum_peaks_t peaks;
+    scratch_arena_t* scratch = count - 2 > ANALYSIS_PARALLEL_GRAIN ? thread_scratch() : NULL;
+    if (parallel_reduce(&peaks_reduce, count - 2, ANALYSIS_PARALLEL_GRAIN, &peaks, scratch) != 0) {
+        return -1;
     }
     
-    if (peak_count > 0 && total_time > 0) {
-        *dominant_frequency = peak_count / total_time;
+    *amplitude = peaks.amplitude;
+    if (peaks.peak_count > 0 && total_time > 0) {
+        *dominant_frequency = peaks.peak_count / total_time;
     }
     
     return 0;
 }
 
-// Bridge vibration specific analysis
+// Typical bridge vibration limits unless an alert rules file overrides them
+static bridge_safety_limits_t bridge_limits = {
+    BRIDGE_DEFAULT_RMS_WARNING, BRIDGE_DEFAULT_RMS_CRITICAL,
+    BRIDGE_DEFAULT_PEAK_WARNING, BRIDGE_DEFAULT_PEAK_CRITICAL
+};
+
+// Replace the limits used by analyze_bridge_vibration and finalize_bridge_accumulator
+void set_bridge_safety_limits(const bridge_safety_limits_t* limits) {
+    if (limits) bridge_limits = *limits;
+}
+
+// Limits currently in use
+bridge_safety_limits_t get_bridge_safety_limits(void) {
+    return bridge_limits;
+}
+
+// Safety assessment against the configured bridge vibration limits
+static void assess_bridge_safety(bridge_analysis_t* analysis) {
+    if (analysis->rms_amplitude < bridge_limits.rms_warning &&
+        analysis->peak_amplitude < bridge_limits.peak_warning) {
+        analysis->safety_status = 0;  // Safe
+        strcpy(analysis->safety_message, "Normal vibration levels - Bridge is safe");
+    } else if (analysis->rms_amplitude < bridge_limits.rms_critical &&
+               analysis->peak_amplitude < bridge_limits.peak_critical) {
+        analysis->safety_status = 1;  // Warning
+        strcpy(analysis->safety_message, "Elevated vibration levels - Monitor closely");
+    } else {
+        analysis->safety_status = 2;  // Critical
+        strcpy(analysis->safety_message, "CRITICAL: Excessive vibration - Immediate inspection required");
+    }
+}
+
+// Sum of squares and peak of a range of vibration samples
+typedef struct {
+    double sum_squares;
+    double peak_amplitude;  // Highest value, at least 0
+} vibration_sums_t;
+
+static void reduce_vibration(void* context, int begin, int end, void* partial) {
+    const sensor_data_t* vibration_data = context;
+    vibration_sums_t* sums = partial;
+    
+    for (int i = begin; i < end; i++) {
+        double value = vibration_data[i].value;
+        sums->sum_squares += value * value;
+        if (value > sums->peak_amplitude) {
+            sums->peak_amplitude = value;
+        }
+    }
+}
+
+static void combine_vibration(void* result, const void* partial) {
+    vibration_sums_t* sums = result;
+    const vibration_sums_t* range = partial;
+    
+    sums->sum_squares += range->sum_squares;
+    if (range->peak_amplitude > sums->peak_amplitude) sums->peak_amplitude = range->peak_amplitude;
+}
+
+// Samples copied into a value array
+typedef struct {
+    const sensor_data_t* samples;
+    double* values;
+} value_copy_t;
+
+static void copy_sample_values(void* context, int begin, int end) {
+    const value_copy_t* copy = context;
+    
+    for (int i = begin; i < end; i++) {
+        copy->values[i] = copy->samples[i].value;
+    }
+}
+
+// Bridge vibration specific analysis (temporaries from the thread's context)
 bridge_analysis_t analyze_bridge_vibration(const sensor_data_t* vibration_data, int count) {
+    return analyze_bridge_vibration_in(thread_analysis_context(), vibration_data, count);
+}
+
+// Bridge vibration analysis with temporaries from a context's scratch arena
+bridge_analysis_t analyze_bridge_vibration_in(analysis_context_t* context,
+                                              const sensor_data_t* vibration_data, int count) {
     bridge_analysis_t analysis;
     analysis.rms_amplitude = 0.0;
     analysis.peak_amplitude = 0.0;
@@ -298,52 +581,167 @@ bridge_analysis_t analyze_bridge_vibration(const sensor_data_t* vibration_data,
     }
     
     // Calculate RMS amplitude
-    double sum_squares = 0.0;
-    analysis.peak_amplitude = 0.0;
+    static const vibration_sums_t no_vibration = { 0.0, 0.0 };
+    task_reduce_t vibration_reduce = {
+        sizeof(vibration_sums_t), &no_vibration, reduce_vibration, combine_vibration, (void*)vibration_data
+    };
+    vibration_sums_t sums;
+    scratch_arena_t* scratch = context && count > ANALYSIS_PARALLEL_GRAIN ? &context->scratch : NULL;
+    if (parallel_reduce(&vibration_reduce, count, ANALYSIS_PARALLEL_GRAIN, &sums, scratch) != 0) {
+        return analysis;
+    }
     
-    for (int i = 0; i < count; i++) {
-        double value = vibration_data[i].value;
-        sum_squares += value * value;
-        if (value > analysis.peak_amplitude) {
-            analysis.peak_amplitude = value;
+    analysis.peak_amplitude = sums.peak_amplitude;
+    analysis.rms_amplitude = sqrt(sums.sum_squares / count);
+    
+    // Extract values for frequency analysis; scoped so repeated calls within
+    // one cycle reuse the same scratch space
+    if (context) {
+        scratch_mark_t mark = mark_scratch_arena(&context->scratch);
+        double* values = scratch_alloc(&context->scratch, count * sizeof(double));
+        if (values) {
+            value_copy_t copy = { vibration_data, values };
+            parallel_for(count, ANALYSIS_PARALLEL_GRAIN, copy_sample_values, &copy);
+            
+            double amplitude;
+            analyze_frequency_spectrum(values, count, &analysis.dominant_frequency, &amplitude);
         }
+        release_scratch_arena(&context->scratch, mark);
     }
     
-    analysis.rms_amplitude = sqrt(sum_squares / count);
+    assess_bridge_safety(&analysis);
     
-    // Extract values for frequency analysis
-    double* values = malloc(count * sizeof(double));
-    if (values) {
-        for (int i = 0; i < count; i++) {
-            values[i] = vibration_data[i].value;
-        }
-        
-        double amplitude;
-        analyze_frequency_spectrum(values, count, &analysis.dominant_frequency, &amplitude);
-        free(values);
-    }
-    
-    // Safety assessment based on typical bridge vibration limits
-    if (analysis.rms_amplitude < 0.1 && analysis.peak_amplitude < 0.3) {
-        analysis.safety_status = 0;  // Safe
-        strcpy(analysis.safety_message, "Normal vibration levels - Bridge is safe");
-    } else if (analysis.rms_amplitude < 0.3 && analysis.peak_amplitude < 0.8) {
-        analysis.safety_status = 1;  // Warning
-        strcpy(analysis.safety_message, "Elevated vibration levels - Monitor closely");
-    } else {
-        analysis.safety_status = 2;  // Critical
-        strcpy(analysis.safety_message, "CRITICAL: Excessive vibration - Immediate inspection required");
+    return analysis;
+}
+
+// Initialize streaming bridge accumulator
+void init_bridge_accumulator(bridge_accumulator_t* acc) {
+    if (!acc) return;
+    
+    acc->count = 0;
+    acc->sum_squares = 0.0;
+    acc->peak_amplitude = 0.0;
+    acc->peak_count = 0;
+    acc->prev_value = 0.0;
+    acc->prev_prev_value = 0.0;
+}
+
+// Add vibration sample to accumulator
+void update_bridge_accumulator(bridge_accumulator_t* acc, double value) {
+    if (!acc) return;
+    
+    acc->sum_squares += value * value;
+    if (value > acc->peak_amplitude) {
+        acc->peak_amplitude = value;
     }
     
+    // The previous sample is a local maximum once its right neighbour is known
+    if (acc->count >= 2 && acc->prev_value > acc->prev_prev_value && acc->prev_value > value) {
+        acc->peak_count++;
+    }
+    
+    acc->prev_prev_value = acc->prev_value;
+    acc->prev_value = value;
+    acc->count++;
+}
+
+// Produce the same result analyze_bridge_vibration would give over all samples
+bridge_analysis_t finalize_bridge_accumulator(const bridge_accumulator_t* acc) {
+    bridge_analysis_t analysis;
+    analysis.rms_amplitude = 0.0;
+    analysis.peak_amplitude = 0.0;
+    analysis.dominant_frequency = 0.0;
+    analysis.safety_status = 0;
+    strcpy(analysis.safety_message, "Insufficient data");
+    
+    if (!acc || acc->count < 10) {
+        return analysis;
+    }
+    
+    analysis.rms_amplitude = sqrt(acc->sum_squares / acc->count);
+    analysis.peak_amplitude = acc->peak_amplitude;
+    
+    // Matches analyze_frequency_spectrum (assumes 100ms intervals)
+    double total_time = acc->count * 0.1;
+    if (acc->peak_count > 0) {
+        analysis.dominant_frequency = acc->peak_count / total_time;
+    }
+    
+    assess_bridge_safety(&analysis);
+    
     return analysis;
 }
 
+// Initialize sample window
+int init_sample_window(sample_window_t* window, int capacity) {
+    if (!window || capacity <= 0) return -1;
+    
+    window->samples = malloc(2 * (size_t)capacity * sizeof(sensor_data_t));
+    if (!window->samples) return -1;
+    
+    window->owns_samples = 1;
+    window->capacity = capacity;
+    window->head = 0;
+    window->count = 0;
+    
+    return 0;
+}
+
+// Initialize sample window in a context's persistent arena
+int init_sample_window_in(sample_window_t* window, int capacity, analysis_context_t* context) {
+    if (!window || !context || capacity <= 0) return -1;
+    
+    window->samples = scratch_alloc(&context->persistent, 2 * (size_t)capacity * sizeof(sensor_data_t));
+    if (!window->samples) return -1;
+    
+    window->owns_samples = 0;
+    window->capacity = capacity;
+    window->head = 0;
+    window->count = 0;
+    
+    return 0;
+}
+
+// Append sample, overwriting the oldest when full
+void push_sample_window(sample_window_t* window, const sensor_data_t* sample) {
+    if (!window || !window->samples || !sample) return;
+    
+    window->samples[window->head] = *sample;
+    window->samples[window->head + window->capacity] = *sample;
+    window->head = (window->head + 1) % window->capacity;
+    
+    if (window->count < window->capacity) {
+        window->count++;
+    }
+}
+
+// Contiguous view of the window, oldest first
+const sensor_data_t* sample_window_data(const sample_window_t* window) {
+    if (!window || !window->samples) return NULL;
+    
+    return &window->samples[window->head + window->capacity - window->count];
+}
+
+// Cleanup sample window
+void cleanup_sample_window(sample_window_t* window) {
+    if (!window) return;
+    
+    if (window->samples && window->owns_samples) {
+        free(window->samples);
+    }
+    window->samples = NULL;
+    
+    window->capacity = 0;
+    window->head = 0;
+    window->count = 0;
+}
+
 // Print analysis results
 void print_statistics(const statistics_t* stats, const char* sensor_name) {
     if (!stats || !sensor_name) return;
     
     printf("\n=== %s Statistics ===\n", sensor_name);
-    printf("Samples: %d\n", stats->sample_count);
+    printf("Samples: %ld\n", stats->sample_count);
     printf("Mean: %.6f\n", stats->mean);
     printf("Min: %.6f\n", stats->min);
     printf("Max: %.6f\n", stats->max);
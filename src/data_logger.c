@@ -1,10 +1,133 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "../include/data_logger.h"
+#include "../include/writer_pool.h"
+#include "../include/metrics.h"
+#include "../include/stage_probes.h"
+#include "../include/trace.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <errno.h>
 #include <time.h>
+#include <ctype.h>
+#include <dirent.h>
+
+// Logger metrics (shared by all loggers in the process)
+static metrics_counter_t* samples_logged_metric;
+static metrics_counter_t* bytes_written_metric;
+static metrics_counter_t* flushes_metric;
+static metrics_counter_t* write_errors_metric;
+static metrics_counter_t* rotations_metric;
+static metrics_counter_t* samples_shed_metric;
+static metrics_counter_t* rotations_skipped_metric;
+static metrics_histogram_t* flush_latency_metric;
+static pthread_once_t logger_metrics_once = PTHREAD_ONCE_INIT;
+
+static const char* sensor_type_names[] = {
+    "Temperature", "Vibration", "Strain", "Humidity", 
+    "Pressure", "Accel_X", "Accel_Y", "Accel_Z"
+};
+
+// Register logger metrics
+static void register_logger_metrics(void) {
+    samples_logged_metric = register_counter("datalogger_samples_logged_total",
+                                             "Samples written to log files");
+    bytes_written_metric = register_counter("datalogger_bytes_written_total",
+                                            "CSV bytes written to log files");
+    flushes_metric = register_counter("datalogger_flushes_total",
+                                      "Buffered batches written to log files");
+    write_errors_metric = register_counter("datalogger_write_errors_total",
+                                           "Failed CSV record writes");
+    rotations_metric = register_counter("datalogger_rotations_total",
+                                        "Log file rotations");
+    rotations_skipped_metric = register_counter("datalogger_log_rotations_skipped_total",
+                                                "Log rotations skipped because no newer segment name was left");
+    samples_shed_metric = register_counter("datalogger_samples_shed_total",
+                                           "Samples discarded by a logger overload policy");
+    flush_latency_metric = register_histogram("datalogger_flush_latency_seconds",
+                                              "Time to format and write one buffered batch");
+}
+
+// Stamp and sequence of a segment name of base (<base>_YYYYMMDD_HHMMSS_NNNN.csv);
+// 1 if it is one. Names of older versions (local time, no sequence) do not
+// count: their stamps are not comparable with UTC ones.
+static int parse_segment_name(const char* file, const char* base, char* stamp, int* sequence) {
+    size_t length = strlen(base);
+    if (strncmp(file, base, length) != 0 || file[length] != '_') return 0;
+    
+    const char* p = file + length + 1;
+    for (int i = 0; i < 20; i++) {
+        if (i == 8 || i == 15 ? p[i] != '_' : !isdigit((unsigned char)p[i])) return 0;
+    }
+    if (strcmp(p + 20, ".csv") != 0) return 0;
+    
+    *sequence = atoi(p + 16);
+    memcpy(stamp, p, 15);
+    stamp[15] = '\0';
+    return 1;
+}
+
+// Continue naming after the newest segment already on disk, so that a
+// restart never creates a name that sorts before an earlier one
+static void find_newest_segment(data_logger_t* logger) {
+    logger->segment_stamp[0] = '\0';
+    logger->segment_sequence = -1;
+    
+    DIR* dir = opendir(logger->config.directory);
+    if (!dir) return;
+    
+    struct dirent* entry;
+    char stamp[16];
+    int sequence;
+    while ((entry = readdir(dir)) != NULL) {
+        if (!parse_segment_name(entry->d_name, logger->config.filename, stamp, &sequence)) continue;
+        int order = strcmp(stamp, logger->segment_stamp);
+        if (order > 0 || (order == 0 && sequence > logger->segment_sequence)) {
+            strcpy(logger->segment_stamp, stamp);
+            logger->segment_sequence = sequence;
+        }
+    }
+    closedir(dir);
+}
+
+// current_filename of the segment named by segment_stamp and segment_sequence
+static int format_segment_name(data_logger_t* logger) {
+    int length = snprintf(logger->current_filename, sizeof(logger->current_filename),
+                          "%s/%s_%s_%04d.csv",
+                          logger->config.directory,
+                          logger->config.filename,
+                          logger->segment_stamp,
+                          logger->segment_sequence);
+    return length < (int)sizeof(logger->current_filename) ? 0 : -1;
+}
+
+// Name the next segment. Stamps are UTC, so DST changes do not matter, and
+// never go back: when the clock has not moved past the previous stamp (two
+// rotations in one second, or a clock stepped back) the previous stamp is
+// kept and the sequence counts up. Names therefore sort in the order the
+// segments were written, which is how the uplink and its collector order them.
+// Returns 1 when every name of the stamp is taken (the name is left as it
+// was) and -1 when the name does not fit.
+static int next_segment_name(data_logger_t* logger) {
+    char stamp[16];
+    time_t now = time(NULL);
+    struct tm tm_info;
+    gmtime_r(&now, &tm_info);
+    strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", &tm_info);
+    
+    if (strcmp(stamp, logger->segment_stamp) > 0) {
+        strcpy(logger->segment_stamp, stamp);
+        logger->segment_sequence = 0;
+    } else if (logger->segment_sequence < LOGGER_MAX_SEGMENT_SEQUENCE) {
+        logger->segment_sequence++;
+    } else {
+        return 1;
+    }
+    
+    return format_segment_name(logger);
+}
 
 // Initialize data logger
 int init_data_logger(data_logger_t* logger, const char* base_filename) {
@@ -12,38 +135,39 @@ int init_data_logger(data_logger_t* logger, const char* base_filename) {
         return -1;
     }
     
+    pthread_once(&logger_metrics_once, register_logger_metrics);
+    
     // Set default configuration
     logger->config.max_file_size_mb = 10;
     logger->config.auto_rotate = 1;
     logger->config.buffer_size = 100;
     logger->config.flush_interval_ms = 1000;
     strcpy(logger->config.directory, "data");
+    snprintf(logger->config.filename, sizeof(logger->config.filename), "%s", base_filename);
     
     // Create data directory if it doesn't exist
     create_data_directory(logger->config.directory);
     
     // Generate filename with timestamp
-    time_t now = time(NULL);
-    struct tm* tm_info = localtime(&now);
-    
-    snprintf(logger->current_filename, sizeof(logger->current_filename),
-             "%s/%s_%04d%02d%02d_%02d%02d%02d.csv",
-             logger->config.directory,
-             base_filename,
-             tm_info->tm_year + 1900,
-             tm_info->tm_mon + 1,
-             tm_info->tm_mday,
-             tm_info->tm_hour,
-             tm_info->tm_min,
-             tm_info->tm_sec);
-    
-    // Open file for writing
-    logger->file = fopen(logger->current_filename, "w");
+    find_newest_segment(logger);
+    int named = next_segment_name(logger);
+    if (named < 0 || (named > 0 && format_segment_name(logger) != 0)) {
+        fprintf(stderr, "Error: Cannot name a log file for '%s'\n", base_filename);
+        return -1;
+    }
+    
+    // Open file for writing. With the clock far behind the newest segment and
+    // its every successor name taken, that segment is continued instead.
+    logger->file = fopen(logger->current_filename, named > 0 ? "a" : "w");
     if (!logger->file) {
         fprintf(stderr, "Error: Cannot create log file '%s': %s\n", 
                 logger->current_filename, strerror(errno));
         return -1;
     }
+    if (named > 0) {
+        fprintf(stderr, "Warning: No newer log file name before %s; appending to %s\n",
+                logger->segment_stamp, logger->current_filename);
+    }
     
     // Initialize buffer
     logger->buffer = malloc(logger->config.buffer_size * sizeof(sensor_data_t));
@@ -53,13 +177,32 @@ int init_data_logger(data_logger_t* logger, const char* base_filename) {
     }
     
     // Initialize state
-    logger->current_file_size = 0;
+    fseek(logger->file, 0, SEEK_END);
+    logger->current_file_size = ftell(logger->file);
     logger->sample_count = 0;
     logger->buffer_index = 0;
-    logger->last_flush = get_current_time();
+    logger->last_flush = get_coarse_time();
+    logger->active_refs = 0;
+    logger->batch_ref_count = 0;
+    logger->batch_ref_samples = 0;
+    
+    // Synchronous until a writer pool is attached
+    logger->writer_pool = NULL;
+    logger->spare_buffer = NULL;
+    logger->write_pending = 0;
+    pthread_mutex_init(&logger->pending_lock, NULL);
+    pthread_cond_init(&logger->pending_cond, NULL);
+    
+    // Full buffers wait for the writer unless an overload policy is set
+    set_logger_overload_policy(logger, OVERLOAD_BLOCK, NULL);
+    memset(logger->gaps, 0, sizeof(logger->gaps));
+    logger->active_gaps = 0;
+    logger->gaps_pending = 0;
+    logger->samples_shed = 0;
+    logger->rotations_skipped = 0;
     
     // Write CSV header
-    write_csv_header(logger);
+    if (named == 0) write_csv_header(logger);
     
     printf("Data logger initialized: %s\n", logger->current_filename);
     return 0;
@@ -94,52 +237,369 @@ int write_csv_header(data_logger_t* logger) {
     return bytes_written > 0 ? 0 : -1;
 }
 
-// Log single sensor data point
-int log_sensor_data(data_logger_t* logger, const sensor_data_t* data) {
-    if (!logger || !data) return -1;
+// Choose what a full buffer does while the writer is busy
+void set_logger_overload_policy(data_logger_t* logger, overload_policy_t policy,
+                                const sample_priority_t* priorities) {
+    if (!logger) return;
+    
+    logger->overload_policy = policy;
+    for (int type = 0; type < SENSOR_TYPE_COUNT; type++) {
+        logger->priorities[type] = priorities ? priorities[type] : default_sample_priority((sensor_type_t)type);
+    }
+}
+
+// Shed instead of waiting: an overload policy is set and the writer still
+// owns the previous batch. Only this thread submits the logger's writes, so
+// the answer can only change from busy to idle behind its back.
+static int logger_overloaded(data_logger_t* logger) {
+    if (!logger->writer_pool || logger->overload_policy == OVERLOAD_BLOCK) return 0;
+    
+    pthread_mutex_lock(&logger->pending_lock);
+    int pending = logger->write_pending;
+    pthread_mutex_unlock(&logger->pending_lock);
+    return pending;
+}
+
+// Count a sample as shed in the active gap set
+static void shed_sample(data_logger_t* logger, const sensor_data_t* sample) {
+    record_sample_gap(&logger->gaps[logger->active_gaps][sample->type], sample);
+    logger->gaps_pending = 1;
+    logger->samples_shed++;
+    counter_add(samples_shed_metric, 1);
+}
+
+// Make room in a full buffer while the writer is busy by shedding samples of
+// the lowest priority present, at most a quarter of the buffer at a time.
+// Buffered samples are only shed for an arriving sample of at least their
+// priority; otherwise the arriving one goes. Returns 1 when the arriving
+// sample was shed, 0 when there is room and -1 when everything buffered and
+// the arriving sample are critical.
+static int shed_logger_samples(data_logger_t* logger, const sensor_data_t* arriving) {
+    sample_priority_t arriving_priority = logger->priorities[arriving->type];
+    sample_priority_t level = SAMPLE_PRIORITY_CRITICAL;
+    int matches = 0;
+    
+    for (int i = 0; i < logger->buffer_index; i++) {
+        sample_priority_t priority = logger->priorities[logger->buffer[i].type];
+        if (priority < level) {
+            level = priority;
+            matches = 0;
+        }
+        if (priority == level) matches++;
+    }
+    
+    // A lower priority never displaces a higher one, under any policy; drop
+    // newest also keeps out arriving samples of the buffer's lowest priority
+    if (level == SAMPLE_PRIORITY_CRITICAL || arriving_priority < level ||
+        (logger->overload_policy == OVERLOAD_DROP_NEWEST && arriving_priority == level)) {
+        if (arriving_priority == SAMPLE_PRIORITY_CRITICAL) return -1;
+        shed_sample(logger, arriving);
+        return 1;
+    }
+    
+    int limit = logger->config.buffer_size / 4 > 0 ? logger->config.buffer_size / 4 : 1;
+    int keep_first = logger->overload_policy == OVERLOAD_DROP_NEWEST && matches > limit ? matches - limit : 0;
+    int pair_position[SENSOR_TYPE_COUNT] = { 0 };
+    int seen = 0;
+    int shed = 0;
+    int kept = 0;
+    
+    for (int i = 0; i < logger->buffer_index; i++) {
+        const sensor_data_t* sample = &logger->buffer[i];
+        int drop = 0;
+        
+        if (logger->priorities[sample->type] == level) {
+            switch (logger->overload_policy) {
+                case OVERLOAD_DECIMATE:
+                    drop = !(pair_position[sample->type]++ & 1);   // First of each pair per channel
+                    break;
+                case OVERLOAD_DROP_NEWEST:
+                    drop = seen++ >= keep_first;
+                    break;
+                default:
+                    drop = shed < limit;
+                    break;
+            }
+        }
+        
+        if (drop) {
+            shed_sample(logger, sample);
+            shed++;
+        } else {
+            logger->buffer[kept++] = *sample;
+        }
+    }
+    
+    logger->buffer_index = kept;
+    logger->sample_count -= shed;
+    return 0;
+}
+
+// Add one sample to the copy buffer. A full buffer is written, or while an
+// overloaded writer is busy, thinned by the overload policy.
+static int append_logger_sample(data_logger_t* logger, const sensor_data_t* data) {
+    if (logger->buffer_index >= logger->config.buffer_size) {
+        int shed = logger_overloaded(logger) ? shed_logger_samples(logger, data) : -1;
+        if (shed == 1) return 0;
+        if (shed == -1) {
+            int result = flush_logger_buffer(logger);
+            if (result != 0) return result;
+        }
+    }
     
-    // Add to buffer
     logger->buffer[logger->buffer_index] = *data;
     logger->buffer_index++;
     logger->sample_count++;
     
-    // Check if buffer is full or flush interval reached
-    precise_time_t current_time = get_current_time();
-    double time_since_flush = time_diff_ms(logger->last_flush, current_time);
-    
-    if (logger->buffer_index >= logger->config.buffer_size || 
-        time_since_flush >= logger->config.flush_interval_ms) {
+    if (logger->buffer_index >= logger->config.buffer_size && !logger_overloaded(logger)) {
         return flush_logger_buffer(logger);
     }
+    return 0;
+}
+
+// Flush when the flush interval has passed. The interval is milliseconds or
+// more, so the coarse clock is precise enough and cheaper than a full read.
+// A busy writer under an overload policy is never waited for here.
+static int flush_if_due(data_logger_t* logger) {
+    if (logger_overloaded(logger)) return 0;
     
+    timestamp_ns_t time_since_flush = get_coarse_time() - logger->last_flush;
+    
+    if (time_since_flush >= (int64_t)logger->config.flush_interval_ms * NS_PER_MS) {
+        return flush_logger_buffer(logger);
+    }
     return 0;
 }
 
-// Log multiple sensor data points
+// Log single sensor data point
+int log_sensor_data(data_logger_t* logger, const sensor_data_t* data) {
+    if (!logger || !data) return -1;
+    
+    // Batches logged by reference come first
+    if (logger->batch_ref_count > 0 && flush_logger_buffer(logger) != 0) return -1;
+    
+    PROBE_BEGIN(probe_start);
+    
+    // Add to buffer, then check the flush interval
+    int result = append_logger_sample(logger, data);
+    if (result == 0) {
+        result = flush_if_due(logger);
+    }
+    
+    PROBE_END(STAGE_LOG_SAMPLE, probe_start);
+    return result;
+}
+
+// Log multiple sensor data points; the flush interval is checked once per batch
 int log_sensor_data_batch(data_logger_t* logger, const sensor_data_t* data_array, int count) {
     if (!logger || !data_array || count <= 0) return -1;
     
-    for (int i = 0; i < count; i++) {
-        if (log_sensor_data(logger, &data_array[i]) != 0) {
-            return -1;
-        }
+    if (logger->batch_ref_count > 0 && flush_logger_buffer(logger) != 0) return -1;
+    
+    PROBE_BEGIN(probe_start);
+    
+    int result = 0;
+    for (int i = 0; i < count && result == 0; i++) {
+        result = append_logger_sample(logger, &data_array[i]);
+    }
+    
+    if (result == 0) {
+        result = flush_if_due(logger);
+    }
+    
+    PROBE_END(STAGE_LOG_SAMPLE, probe_start);
+    return result;
+}
+
+// Log a pooled batch by reference
+int log_sample_batch(data_logger_t* logger, sample_batch_t* batch) {
+    if (!logger || !batch) return -1;
+    if (batch->count <= 0) return 0;
+    
+    // Shared batches cannot be thinned, so overload goes through the copy buffer
+    if (logger_overloaded(logger)) {
+        return log_sensor_data_batch(logger, batch->samples, batch->count);
+    }
+    
+    // Copied samples came first
+    if (logger->buffer_index > 0 && flush_logger_buffer(logger) != 0) return -1;
+    
+    PROBE_BEGIN(probe_start);
+    
+    retain_sample_batch(batch);
+    logger->batch_refs[logger->active_refs][logger->batch_ref_count++] = batch;
+    logger->batch_ref_samples += batch->count;
+    logger->sample_count += batch->count;
+    
+    int result;
+    if (logger->batch_ref_samples >= logger->config.buffer_size ||
+        logger->batch_ref_count == LOGGER_MAX_BATCH_REFS) {
+        result = flush_logger_buffer(logger);
+    } else {
+        result = flush_if_due(logger);
     }
     
+    PROBE_END(STAGE_LOG_SAMPLE, probe_start);
+    return result;
+}
+
+// Attach a writer pool so flushes happen off the caller's thread
+int attach_writer_pool(data_logger_t* logger, struct writer_pool* pool) {
+    if (!logger || !pool) return -1;
+    
+    if (!logger->spare_buffer) {
+        logger->spare_buffer = malloc(logger->config.buffer_size * sizeof(sensor_data_t));
+        if (!logger->spare_buffer) return -1;
+    }
+    
+    logger->writer_pool = pool;
     return 0;
 }
 
+// Wait until the previous asynchronous batch has been written
+static void wait_for_pending_write(data_logger_t* logger) {
+    pthread_mutex_lock(&logger->pending_lock);
+    while (logger->write_pending) {
+        pthread_cond_wait(&logger->pending_cond, &logger->pending_lock);
+    }
+    pthread_mutex_unlock(&logger->pending_lock);
+}
+
+// Mark an asynchronous batch as written (called by writer threads)
+void complete_logger_write(data_logger_t* logger) {
+    if (!logger) return;
+    
+    pthread_mutex_lock(&logger->pending_lock);
+    logger->write_pending = 0;
+    pthread_cond_signal(&logger->pending_cond);
+    pthread_mutex_unlock(&logger->pending_lock);
+}
+
+// Hand the active gap set to a write and switch sets (NULL when nothing was
+// shed). The other set was cleared by the previous write.
+static sample_gap_t* take_logger_gaps(data_logger_t* logger) {
+    if (!logger->gaps_pending) return NULL;
+    
+    sample_gap_t* gaps = logger->gaps[logger->active_gaps];
+    logger->active_gaps ^= 1;
+    logger->gaps_pending = 0;
+    return gaps;
+}
+
+// Swap buffers and hand the full one to the writer pool
+static int submit_logger_buffer(data_logger_t* logger) {
+    wait_for_pending_write(logger);
+    
+    sample_gap_t* gaps = take_logger_gaps(logger);
+    sensor_data_t* full_buffer = logger->buffer;
+    int count = logger->buffer_index;
+    
+    logger->buffer = logger->spare_buffer;
+    logger->spare_buffer = full_buffer;
+    logger->buffer_index = 0;
+    logger->last_flush = get_coarse_time();
+    
+    pthread_mutex_lock(&logger->pending_lock);
+    logger->write_pending = 1;
+    pthread_mutex_unlock(&logger->pending_lock);
+    
+    writer_job_t job;
+    job.logger = logger;
+    job.records = full_buffer;
+    job.count = count;
+    job.batches = NULL;
+    job.batch_count = 0;
+    job.gaps = gaps;
+    
+    if (submit_writer_job(logger->writer_pool, &job) != 0) {
+        // Pool is shutting down, write on this thread instead
+        if (gaps) write_logger_gaps(logger, gaps);
+        int result = write_logger_records(logger, full_buffer, count);
+        complete_logger_write(logger);
+        return result;
+    }
+    
+    return 0;
+}
+
+// Switch reference arrays and write or hand off the full one
+static int flush_batch_refs(data_logger_t* logger) {
+    if (logger->writer_pool) wait_for_pending_write(logger);
+    
+    sample_gap_t* gaps = take_logger_gaps(logger);
+    sample_batch_t* const* batches = logger->batch_refs[logger->active_refs];
+    int count = logger->batch_ref_count;
+    int samples = logger->batch_ref_samples;
+    
+    logger->active_refs ^= 1;
+    logger->batch_ref_count = 0;
+    logger->batch_ref_samples = 0;
+    logger->last_flush = get_coarse_time();
+    
+    if (logger->writer_pool) {
+        pthread_mutex_lock(&logger->pending_lock);
+        logger->write_pending = 1;
+        pthread_mutex_unlock(&logger->pending_lock);
+        
+        writer_job_t job;
+        job.logger = logger;
+        job.records = NULL;
+        job.count = samples;
+        job.batches = batches;
+        job.batch_count = count;
+        job.gaps = gaps;
+        
+        if (submit_writer_job(logger->writer_pool, &job) == 0) {
+            return 0;
+        }
+        
+        // Pool is shutting down, write on this thread instead
+        if (gaps) write_logger_gaps(logger, gaps);
+        int result = write_logger_batches(logger, batches, count);
+        complete_logger_write(logger);
+        return result;
+    }
+    
+    if (gaps) write_logger_gaps(logger, gaps);
+    return write_logger_batches(logger, batches, count);
+}
+
 // Flush buffered data to file
 int flush_logger_buffer(data_logger_t* logger) {
-    if (!logger || !logger->file || logger->buffer_index == 0) return 0;
+    if (!logger || (logger->buffer_index == 0 && logger->batch_ref_count == 0)) return 0;
+    
+    PROBE_BEGIN(probe_start);
+    trace_begin("flush");
+    int result = 0;
+    
+    // The file belongs to the writer thread while a pool is attached
+    if (logger->batch_ref_count > 0) {
+        result = flush_batch_refs(logger);
+    } else if (logger->writer_pool) {
+        result = submit_logger_buffer(logger);
+    } else if (logger->file) {
+        int count = logger->buffer_index;
+        logger->buffer_index = 0;
+        logger->last_flush = get_coarse_time();
+        
+        sample_gap_t* gaps = take_logger_gaps(logger);
+        if (gaps) write_logger_gaps(logger, gaps);
+        result = write_logger_records(logger, logger->buffer, count);
+    }
     
+    trace_end("flush");
+    PROBE_END(STAGE_FLUSH, probe_start);
+    return result;
+}
+
+// Append CSV lines for records; returns the bytes written
+static long format_logger_records(data_logger_t* logger, const sensor_data_t* records, int count) {
+    long batch_bytes = 0;
+    long written = 0;
     char timestamp_str[64];
-    const char* sensor_type_names[] = {
-        "Temperature", "Vibration", "Strain", "Humidity", 
-        "Pressure", "Accel_X", "Accel_Y", "Accel_Z"
-    };
     
-    for (int i = 0; i < logger->buffer_index; i++) {
-        const sensor_data_t* data = &logger->buffer[i];
+    for (int i = 0; i < count; i++) {
+        const sensor_data_t* data = &records[i];
         
         // Format timestamp
         format_timestamp(data->timestamp, timestamp_str, sizeof(timestamp_str));
@@ -158,15 +618,26 @@ int flush_logger_buffer(data_logger_t* logger) {
         
         if (bytes_written > 0) {
             logger->current_file_size += bytes_written;
+            batch_bytes += bytes_written;
+            written++;
+        } else {
+            counter_add(write_errors_metric, 1);
         }
     }
     
+    // Counted only here, so samples shed from the buffer never show as logged
+    counter_add(samples_logged_metric, written);
+    return batch_bytes;
+}
+
+// Flush written lines to disk, record metrics and rotate if needed
+static int finish_logger_write(data_logger_t* logger, long batch_bytes, int64_t start_ns) {
     // Flush to disk
     fflush(logger->file);
     
-    // Reset buffer
-    logger->buffer_index = 0;
-    logger->last_flush = get_current_time();
+    counter_add(bytes_written_metric, batch_bytes);
+    counter_add(flushes_metric, 1);
+    histogram_observe_ns(flush_latency_metric, (long)(metrics_now_ns() - start_ns));
     
     // Check if file rotation is needed
     if (logger->config.auto_rotate && 
@@ -177,46 +648,105 @@ int flush_logger_buffer(data_logger_t* logger) {
     return 0;
 }
 
+// Write records to the current file and rotate if needed
+int write_logger_records(data_logger_t* logger, const sensor_data_t* records, int count) {
+    if (!logger || !logger->file || !records) return -1;
+    
+    PROBE_BEGIN(probe_start);
+    trace_begin("write");
+    int64_t start_ns = metrics_now_ns();
+    long batch_bytes = format_logger_records(logger, records, count);
+    int result = finish_logger_write(logger, batch_bytes, start_ns);
+    trace_end("write");
+    PROBE_END(STAGE_WRITE, probe_start);
+    
+    return result;
+}
+
+// Write pooled batches in order with one flush and release them
+int write_logger_batches(data_logger_t* logger, sample_batch_t* const* batches, int count) {
+    if (!logger || !batches) return -1;
+    
+    int result = -1;
+    if (logger->file) {
+        PROBE_BEGIN(probe_start);
+        trace_begin("write");
+        int64_t start_ns = metrics_now_ns();
+        long batch_bytes = 0;
+        for (int i = 0; i < count; i++) {
+            batch_bytes += format_logger_records(logger, batches[i]->samples, batches[i]->count);
+        }
+        result = finish_logger_write(logger, batch_bytes, start_ns);
+        trace_end("write");
+        PROBE_END(STAGE_WRITE, probe_start);
+    }
+    
+    for (int i = 0; i < count; i++) {
+        release_sample_batch(batches[i]);
+    }
+    
+    return result;
+}
+
+// Write one gap line per channel with shed samples and clear the set
+int write_logger_gaps(data_logger_t* logger, sample_gap_t* gaps) {
+    if (!logger || !logger->file || !gaps) return -1;
+    
+    char first_str[64];
+    char last_str[64];
+    long gap_bytes = 0;
+    
+    for (int type = 0; type < SENSOR_TYPE_COUNT; type++) {
+        sample_gap_t* gap = &gaps[type];
+        if (gap->dropped == 0) continue;
+        
+        format_timestamp(gap->first, first_str, sizeof(first_str));
+        format_timestamp(gap->last, last_str, sizeof(last_str));
+        
+        // Value is the number of samples missing from the channel
+        int bytes_written = fprintf(logger->file, "%s,Gap,%ld,samples,%s shed through %s (%s)\n",
+                                   first_str, gap->dropped, sensor_type_names[type], last_str,
+                                   overload_policy_name(logger->overload_policy));
+        if (bytes_written > 0) {
+            logger->current_file_size += bytes_written;
+            gap_bytes += bytes_written;
+        } else {
+            counter_add(write_errors_metric, 1);
+        }
+        gap->dropped = 0;
+    }
+    
+    counter_add(bytes_written_metric, gap_bytes);
+    return 0;
+}
+
 // Rotate log file (create new file when current gets too large)
 int rotate_log_file(data_logger_t* logger) {
     if (!logger) return -1;
     
+    // A clock stepped far back can exhaust the names; keep writing until it catches up
+    char previous_filename[sizeof(logger->current_filename)];
+    strcpy(previous_filename, logger->current_filename);
+    if (next_segment_name(logger) != 0) {
+        strcpy(logger->current_filename, previous_filename);
+        if (logger->rotations_skipped++ == 0) {
+            fprintf(stderr, "Warning: No newer log file name before %s; %s keeps growing\n",
+                    logger->segment_stamp, logger->current_filename);
+        }
+        counter_add(rotations_skipped_metric, 1);
+        return 0;
+    }
+    
+    trace_instant("rotate");
+    
     // Close current file
     if (logger->file) {
         fclose(logger->file);
         printf("Rotated log file: %s (%.2f MB)\n", 
-               logger->current_filename, 
+               previous_filename, 
                logger->current_file_size / (1024.0 * 1024.0));
     }
     
-    // Generate new filename
-    time_t now = time(NULL);
-    struct tm* tm_info = localtime(&now);
-    
-    char base_name[256];
-    // Extract base name from current filename
-    char* last_slash = strrchr(logger->current_filename, '/');
-    if (last_slash) {
-        strcpy(base_name, last_slash + 1);
-        char* first_underscore = strchr(base_name, '_');
-        if (first_underscore) {
-            *first_underscore = '\0';
-        }
-    } else {
-        strcpy(base_name, "sensor_data");
-    }
-    
-    snprintf(logger->current_filename, sizeof(logger->current_filename),
-             "%s/%s_%04d%02d%02d_%02d%02d%02d.csv",
-             logger->config.directory,
-             base_name,
-             tm_info->tm_year + 1900,
-             tm_info->tm_mon + 1,
-             tm_info->tm_mday,
-             tm_info->tm_hour,
-             tm_info->tm_min,
-             tm_info->tm_sec);
-    
     // Open new file
     logger->file = fopen(logger->current_filename, "w");
     if (!logger->file) {
@@ -228,13 +758,14 @@ int rotate_log_file(data_logger_t* logger) {
     // Reset file size and write header
     logger->current_file_size = 0;
     write_csv_header(logger);
+    counter_add(rotations_metric, 1);
     
     printf("New log file created: %s\n", logger->current_filename);
     return 0;
 }
 
 // Get current log file statistics
-void get_logger_stats(data_logger_t* logger, int* sample_count, long* file_size, char* filename) {
+void get_logger_stats(data_logger_t* logger, long* sample_count, long* file_size, char* filename) {
     if (!logger) return;
     
     if (sample_count) *sample_count = logger->sample_count;
@@ -248,6 +779,10 @@ void cleanup_data_logger(data_logger_t* logger) {
     
     // Flush any remaining buffered data
     flush_logger_buffer(logger);
+    if (logger->writer_pool) {
+        wait_for_pending_write(logger);
+        logger->writer_pool = NULL;
+    }
     
     // Close file
     if (logger->file) {
@@ -260,8 +795,19 @@ void cleanup_data_logger(data_logger_t* logger) {
         free(logger->buffer);
         logger->buffer = NULL;
     }
+    if (logger->spare_buffer) {
+        free(logger->spare_buffer);
+        logger->spare_buffer = NULL;
+    }
     
-    printf("Data logger closed. Total samples logged: %d\n", logger->sample_count);
+    pthread_mutex_destroy(&logger->pending_lock);
+    pthread_cond_destroy(&logger->pending_cond);
+    
+    printf("Data logger closed. Total samples logged: %ld\n", logger->sample_count);
+    if (logger->samples_shed > 0) {
+        printf("Samples shed under overload (%s): %ld, written as gap lines\n",
+               overload_policy_name(logger->overload_policy), logger->samples_shed);
+    }
 }
 
 // Create data directory if it doesn't exist
@@ -2,6 +2,9 @@
 #define _BSD_SOURCE
 
 #include "../include/hardware_interface.h"
+#include "../include/metrics.h"
+#include "../include/stage_probes.h"
+#include "../include/trace.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -9,6 +12,29 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <sys/select.h>
+#include <pthread.h>
+
+// Hardware metrics
+static metrics_counter_t* bytes_read_metric;
+static metrics_counter_t* read_errors_metric;
+static metrics_counter_t* read_timeouts_metric;
+static metrics_counter_t* parse_errors_metric;
+static metrics_counter_t* hardware_samples_metric;
+static pthread_once_t hardware_metrics_once = PTHREAD_ONCE_INIT;
+
+// Register hardware metrics
+static void register_hardware_metrics(void) {
+    bytes_read_metric = register_counter("datalogger_hw_bytes_read_total",
+                                         "Bytes read from hardware devices");
+    read_errors_metric = register_counter("datalogger_hw_read_errors_total",
+                                          "Failed hardware reads");
+    read_timeouts_metric = register_counter("datalogger_hw_read_timeouts_total",
+                                            "Hardware reads that timed out without data");
+    parse_errors_metric = register_counter("datalogger_parse_errors_total",
+                                           "Hardware lines no parser understood");
+    hardware_samples_metric = register_counter("datalogger_hw_samples_total",
+                                               "Samples parsed from hardware");
+}
 
 // Initialize hardware interface
 int init_hardware_interface(hardware_interface_t* hw, const char* device_path) {
@@ -16,6 +42,8 @@ int init_hardware_interface(hardware_interface_t* hw, const char* device_path) {
         return -1;
     }
     
+    pthread_once(&hardware_metrics_once, register_hardware_metrics);
+    
     // Initialize configuration with defaults
     strcpy(hw->config.device_path, device_path);
     hw->config.baud_rate = B9600;
@@ -26,6 +54,9 @@ int init_hardware_interface(hardware_interface_t* hw, const char* device_path) {
     
     hw->is_connected = 0;
     hw->fd = -1;
+    hw->byte_time_ns = 0;
+    hw->line_length = 0;
+    hw->line_buffer_time = 0;
     
     // Open serial port
     hw->fd = open(device_path, O_RDWR | O_NOCTTY | O_NONBLOCK);
@@ -56,6 +87,24 @@ int init_hardware_interface(hardware_interface_t* hw, const char* device_path) {
     return 0;
 }
 
+// Line rate of a termios speed constant (0 if unknown)
+static long baud_bits_per_second(speed_t speed) {
+    switch (speed) {
+        case B1200: return 1200;
+        case B2400: return 2400;
+        case B4800: return 4800;
+        case B9600: return 9600;
+        case B19200: return 19200;
+        case B38400: return 38400;
+        case B57600: return 57600;
+        case B115200: return 115200;
+#ifdef B230400
+        case B230400: return 230400;
+#endif
+        default: return 0;
+    }
+}
+
 // Configure serial port parameters
 int configure_serial_port(hardware_interface_t* hw, int baud_rate) {
     if (!hw || hw->fd == -1) {
@@ -105,6 +154,11 @@ int configure_serial_port(hardware_interface_t* hw, int baud_rate) {
     }
     
     hw->config.baud_rate = baud_rate;
+    
+    // Start bit, data bits, parity and stop bits per character
+    long bits_per_second = baud_bits_per_second((speed_t)baud_rate);
+    int character_bits = 1 + hw->config.data_bits + (hw->config.parity != 'N') + hw->config.stop_bits;
+    hw->byte_time_ns = bits_per_second > 0 ? character_bits * NS_PER_SEC / bits_per_second : 0;
     return 0;
 }
 
@@ -128,9 +182,11 @@ int read_hardware_data(hardware_interface_t* hw, char* buffer, size_t buffer_siz
     
     if (select_result == -1) {
         fprintf(stderr, "Error in select(): %s\n", strerror(errno));
+        counter_add(read_errors_metric, 1);
         return -1;
     } else if (select_result == 0) {
         // Timeout
+        counter_add(read_timeouts_metric, 1);
         return 0;
     }
     
@@ -139,8 +195,10 @@ int read_hardware_data(hardware_interface_t* hw, char* buffer, size_t buffer_siz
     
     if (bytes_read == -1) {
         fprintf(stderr, "Error reading from device: %s\n", strerror(errno));
+        counter_add(read_errors_metric, 1);
         return -1;
     }
+    counter_add(bytes_read_metric, (long)bytes_read);
     
     // Null-terminate the buffer
     buffer[bytes_read] = '\0';
@@ -202,41 +260,103 @@ int parse_hardware_data(const char* raw_data, sensor_data_t* sensor_data) {
         return -1;
     }
     
+    pthread_once(&hardware_metrics_once, register_hardware_metrics);
+    
     // Try different parsing methods
     if (parse_arduino_sensor_data(raw_data, sensor_data) == 0) {
+        counter_add(hardware_samples_metric, 1);
         return 0;
     }
     
     if (parse_modbus_sensor_data(raw_data, sensor_data) == 0) {
+        counter_add(hardware_samples_metric, 1);
         return 0;
     }
     
     // If no parser worked, return error
+    counter_add(parse_errors_metric, 1);
     return -1;
 }
 
 // Read sensor data from hardware (high-level function)
 int read_sensor_from_hardware(hardware_interface_t* hw, sensor_data_t* data) {
-    if (!hw || !data || !hw->is_connected) {
+    return read_sensor_batch_from_hardware(hw, data, 1, 0) == 1 ? 0 : -1;
+}
+
+// Parse buffered lines, reading the device only when no complete line is left
+int read_sensor_batch_from_hardware(hardware_interface_t* hw, sensor_data_t* data,
+                                    int max_samples, int64_t sample_interval_ns) {
+    if (!hw || !data || max_samples <= 0 || !hw->is_connected) {
         return -1;
     }
     
-    char buffer[256];
-    int bytes_read = read_hardware_data(hw, buffer, sizeof(buffer));
+    if (!memchr(hw->line_buffer, '\n', hw->line_length)) {
+        // A full buffer without a line break is noise, not a sample
+        if (hw->line_length >= HARDWARE_LINE_BUFFER_SIZE - 1) {
+            counter_add(parse_errors_metric, 1);
+            hw->line_length = 0;
+        }
+        
+        trace_begin("read");
+        int bytes_read = read_hardware_data(hw, hw->line_buffer + hw->line_length,
+                                            HARDWARE_LINE_BUFFER_SIZE - hw->line_length);
+        trace_end("read");
+        
+        if (bytes_read <= 0) {
+            return -1;
+        }
+        
+        // The only clock read for every line in this batch
+        hw->line_length += bytes_read;
+        hw->line_buffer_time = get_current_time();
+    }
     
-    if (bytes_read <= 0) {
-        return -1;
+    int total_lines = 0;
+    for (int i = 0; i < hw->line_length; i++) {
+        if (hw->line_buffer[i] == '\n') total_lines++;
     }
     
-    // Parse the received data
-    if (parse_hardware_data(buffer, data) != 0) {
-        return -1;
+    // Parse the received lines
+    PROBE_BEGIN(probe_start);
+    trace_begin("parse");
+    int count = 0;
+    int line = 0;
+    int start = 0;
+    for (int i = 0; i < hw->line_length && count < max_samples; i++) {
+        if (hw->line_buffer[i] != '\n') continue;
+        
+        int length = i - start;
+        if (length > 0 && hw->line_buffer[start + length - 1] == '\r') length--;
+        
+        if (length > 0) {
+            char text[256];
+            if (length > (int)sizeof(text) - 1) length = (int)sizeof(text) - 1;
+            memcpy(text, hw->line_buffer + start, length);
+            text[length] = '\0';
+            
+            if (parse_hardware_data(text, &data[count]) == 0) {
+                if (sample_interval_ns > 0) {
+                    data[count].timestamp = hw->line_buffer_time -
+                                            (int64_t)(total_lines - 1 - line) * sample_interval_ns;
+                } else {
+                    data[count].timestamp = hw->line_buffer_time -
+                                            (int64_t)(hw->line_length - (i + 1)) * hw->byte_time_ns;
+                }
+                count++;
+            }
+        }
+        
+        line++;
+        start = i + 1;
     }
+    trace_end("parse");
+    PROBE_END(STAGE_PARSE, probe_start);
     
-    // Set timestamp
-    data->timestamp = get_current_time();
+    // Keep unparsed lines and any partial line for the next call
+    hw->line_length -= start;
+    memmove(hw->line_buffer, hw->line_buffer + start, hw->line_length);
     
-    return 0;
+    return count;
 }
 
 // Arduino sensor data parser
@@ -268,23 +388,7 @@ int parse_arduino_sensor_data(const char* raw_data, sensor_data_t* sensor_data)
     token = strtok(NULL, ":");
     if (!token) return -1;
     
-    if (strcmp(token, "TEMP") == 0) {
-        sensor_data->type = SENSOR_TEMPERATURE;
-    } else if (strcmp(token, "VIB") == 0) {
-        sensor_data->type = SENSOR_VIBRATION;
-    } else if (strcmp(token, "STRAIN") == 0) {
-        sensor_data->type = SENSOR_STRAIN;
-    } else if (strcmp(token, "HUM") == 0) {
-        sensor_data->type = SENSOR_HUMIDITY;
-    } else if (strcmp(token, "PRESS") == 0) {
-        sensor_data->type = SENSOR_PRESSURE;
-    } else if (strcmp(token, "ACCEL_X") == 0) {
-        sensor_data->type = SENSOR_ACCELEROMETER_X;
-    } else if (strcmp(token, "ACCEL_Y") == 0) {
-        sensor_data->type = SENSOR_ACCELEROMETER_Y;
-    } else if (strcmp(token, "ACCEL_Z") == 0) {
-        sensor_data->type = SENSOR_ACCELEROMETER_Z;
-    } else {
+    if (sensor_type_from_name(token, &sensor_data->type) != 0) {
         return -1;
     }
     
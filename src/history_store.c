@@ -0,0 +1,585 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/history_store.h"
+#include "../include/subscribers.h"
+#include "../include/metrics.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Worst-case encoded size of one sample after the first (timestamp + value)
+#define HISTORY_MAX_SAMPLE_BITS (4 + 64 + 2 + 5 + 6 + 64)
+#define HISTORY_CHUNK_BITS (HISTORY_CHUNK_BYTES * 8)
+#define HISTORY_NO_WINDOW 0xFF
+
+// Protocol names used by the /history query
+static const char* channel_names[SENSOR_TYPE_COUNT] = {
+    "TEMP", "VIB", "STRAIN", "HUM", "PRESS", "ACCEL_X", "ACCEL_Y", "ACCEL_Z"
+};
+
+// Sequential reader over one chunk's bit stream
+typedef struct {
+    const history_chunk_t* chunk;
+    uint32_t position;
+    uint32_t index;
+    int64_t time_us;
+    int64_t delta;
+    uint64_t bits;
+    int leading;
+    int trailing;
+} chunk_reader_t;
+
+static uint64_t double_to_bits(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static double bits_to_double(uint64_t bits) {
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Signed to unsigned so small negative and positive values both stay small
+static uint64_t zigzag_encode(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t zigzag_decode(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+// Append the low 'bits' bits of value, most significant first
+static void write_bits(history_chunk_t* chunk, uint64_t value, int bits) {
+    while (bits > 0) {
+        int offset = chunk->bit_length & 7;
+        int space = 8 - offset;
+        int take = bits < space ? bits : space;
+        uint8_t part = (uint8_t)((value >> (bits - take)) & ((1u << take) - 1));
+
+        chunk->data[chunk->bit_length >> 3] |= (uint8_t)(part << (space - take));
+        chunk->bit_length += take;
+        bits -= take;
+    }
+}
+
+static uint64_t read_bits(chunk_reader_t* reader, int bits) {
+    uint64_t result = 0;
+
+    while (bits > 0) {
+        int offset = reader->position & 7;
+        int space = 8 - offset;
+        int take = bits < space ? bits : space;
+        uint8_t part = (uint8_t)((reader->chunk->data[reader->position >> 3] >> (space - take)) &
+                                 ((1u << take) - 1));
+
+        result = (result << take) | part;
+        reader->position += take;
+        bits -= take;
+    }
+
+    return result;
+}
+
+// Encode one sample into a chunk that has room for it
+static void encode_sample(history_chunk_t* chunk, int64_t time_us, double value) {
+    uint64_t bits = double_to_bits(value);
+
+    if (chunk->count == 0) {
+        write_bits(chunk, (uint64_t)time_us, 64);
+        write_bits(chunk, bits, 64);
+        chunk->first_us = time_us;
+        chunk->first_value = value;
+        chunk->min = value;
+        chunk->max = value;
+    } else {
+        // Timestamp: delta-of-delta, zero for perfectly periodic sampling
+        int64_t delta = time_us - chunk->last_us;
+        uint64_t dod = zigzag_encode(delta - chunk->previous_delta);
+        if (dod == 0) {
+            write_bits(chunk, 0x0, 1);
+        } else if (dod < (1u << 7)) {
+            write_bits(chunk, 0x2, 2);
+            write_bits(chunk, dod, 7);
+        } else if (dod < (1u << 12)) {
+            write_bits(chunk, 0x6, 3);
+            write_bits(chunk, dod, 12);
+        } else if (dod < (1u << 20)) {
+            write_bits(chunk, 0xE, 4);
+            write_bits(chunk, dod, 20);
+        } else {
+            write_bits(chunk, 0xF, 4);
+            write_bits(chunk, dod, 64);
+        }
+        chunk->previous_delta = delta;
+
+        // Value: XOR with the previous value, storing only the meaningful bits
+        uint64_t xor_bits = bits ^ chunk->previous_bits;
+        if (xor_bits == 0) {
+            write_bits(chunk, 0x0, 1);
+        } else {
+            int leading = __builtin_clzll(xor_bits);
+            int trailing = __builtin_ctzll(xor_bits);
+            if (leading > 31) leading = 31;
+
+            if (chunk->previous_leading != HISTORY_NO_WINDOW &&
+                leading >= chunk->previous_leading && trailing >= chunk->previous_trailing) {
+                write_bits(chunk, 0x2, 2);
+                write_bits(chunk, xor_bits >> chunk->previous_trailing,
+                           64 - chunk->previous_leading - chunk->previous_trailing);
+            } else {
+                int length = 64 - leading - trailing;
+                write_bits(chunk, 0x3, 2);
+                write_bits(chunk, (uint64_t)leading, 5);
+                write_bits(chunk, (uint64_t)(length - 1), 6);
+                write_bits(chunk, xor_bits >> trailing, length);
+                chunk->previous_leading = (uint8_t)leading;
+                chunk->previous_trailing = (uint8_t)trailing;
+            }
+        }
+
+        if (value < chunk->min) chunk->min = value;
+        if (value > chunk->max) chunk->max = value;
+    }
+
+    chunk->previous_bits = bits;
+    chunk->last_us = time_us;
+    chunk->last_value = value;
+    chunk->sum += value;
+    chunk->count++;
+}
+
+// Decode the next sample of a chunk
+static void decode_sample(chunk_reader_t* reader, int64_t* time_us, double* value) {
+    if (reader->index == 0) {
+        reader->time_us = (int64_t)read_bits(reader, 64);
+        reader->bits = read_bits(reader, 64);
+        reader->leading = HISTORY_NO_WINDOW;
+    } else {
+        uint64_t dod = 0;
+        if (read_bits(reader, 1)) {
+            if (!read_bits(reader, 1)) {
+                dod = read_bits(reader, 7);
+            } else if (!read_bits(reader, 1)) {
+                dod = read_bits(reader, 12);
+            } else if (!read_bits(reader, 1)) {
+                dod = read_bits(reader, 20);
+            } else {
+                dod = read_bits(reader, 64);
+            }
+        }
+        reader->delta += zigzag_decode(dod);
+        reader->time_us += reader->delta;
+
+        if (read_bits(reader, 1)) {
+            if (!read_bits(reader, 1)) {
+                int length = 64 - reader->leading - reader->trailing;
+                reader->bits ^= read_bits(reader, length) << reader->trailing;
+            } else {
+                reader->leading = (int)read_bits(reader, 5);
+                int length = (int)read_bits(reader, 6) + 1;
+                reader->trailing = 64 - reader->leading - length;
+                reader->bits ^= read_bits(reader, length) << reader->trailing;
+            }
+        }
+    }
+
+    reader->index++;
+    *time_us = reader->time_us;
+    *value = bits_to_double(reader->bits);
+}
+
+// Return a channel's oldest chunk to the pool (caller holds the lock)
+static void evict_oldest_chunk(history_store_t* store, history_channel_t* channel) {
+    history_chunk_t* chunk = channel->oldest;
+
+    channel->oldest = chunk->next;
+    if (channel->newest == chunk) channel->newest = NULL;
+    channel->chunk_count--;
+    channel->sample_count -= chunk->count;
+
+    store->samples_evicted += chunk->count;
+    store->chunks_evicted++;
+    store->chunks_used--;
+
+    chunk->next = store->free_chunks;
+    store->free_chunks = chunk;
+}
+
+// Take a chunk from the pool, evicting the oldest sealed chunk of any channel when it is empty
+static history_chunk_t* allocate_chunk(history_store_t* store) {
+    if (!store->free_chunks) {
+        history_channel_t* victim = NULL;
+        for (int i = 0; i < SENSOR_TYPE_COUNT; i++) {
+            history_channel_t* channel = &store->channels[i];
+            if (channel->oldest && channel->oldest != channel->newest &&
+                (!victim || channel->oldest->first_us < victim->oldest->first_us)) {
+                victim = channel;
+            }
+        }
+        if (!victim) return NULL;
+        evict_oldest_chunk(store, victim);
+    }
+
+    history_chunk_t* chunk = store->free_chunks;
+    store->free_chunks = chunk->next;
+    memset(chunk, 0, sizeof(*chunk));
+    chunk->previous_leading = HISTORY_NO_WINDOW;
+    store->chunks_used++;
+
+    return chunk;
+}
+
+// Keep horizon_seconds per channel within memory_mb of chunks
+int init_history_store(history_store_t* store, int horizon_seconds, int memory_mb) {
+    if (!store || horizon_seconds <= 0 || memory_mb <= 0) return -1;
+
+    memset(store, 0, sizeof(*store));
+    store->horizon_us = (int64_t)horizon_seconds * 1000000LL;
+    store->chunk_total = (int)(((size_t)memory_mb * 1024 * 1024) / sizeof(history_chunk_t));
+
+    // Every channel needs an open chunk plus one that can be evicted
+    if (store->chunk_total < 2 * SENSOR_TYPE_COUNT) {
+        store->chunk_total = 2 * SENSOR_TYPE_COUNT;
+    }
+
+    store->chunks = calloc(store->chunk_total, sizeof(history_chunk_t));
+    if (!store->chunks) {
+        fprintf(stderr, "Error: Cannot allocate %d MB for the history store\n", memory_mb);
+        return -1;
+    }
+
+    for (int i = store->chunk_total - 1; i >= 0; i--) {
+        store->chunks[i].next = store->free_chunks;
+        store->free_chunks = &store->chunks[i];
+    }
+
+    pthread_mutex_init(&store->lock, NULL);
+    return 0;
+}
+
+// Append one sample (caller holds the lock)
+static int append_sample_locked(history_store_t* store, const sensor_data_t* sample) {
+    if (sample->type < 0 || sample->type >= SENSOR_TYPE_COUNT) return -1;
+
+    history_channel_t* channel = &store->channels[sample->type];
+    int64_t time_us = sample->timestamp / NS_PER_US;
+
+    history_chunk_t* chunk = channel->newest;
+    if (!chunk || chunk->bit_length + HISTORY_MAX_SAMPLE_BITS > HISTORY_CHUNK_BITS) {
+        history_chunk_t* fresh = allocate_chunk(store);
+        if (!fresh) return -1;
+
+        // Allocation may have evicted this channel's only sealed chunk
+        if (channel->newest) {
+            channel->newest->next = fresh;
+        } else {
+            channel->oldest = fresh;
+        }
+        channel->newest = fresh;
+        channel->chunk_count++;
+        chunk = fresh;
+    }
+
+    encode_sample(chunk, time_us, sample->value);
+    channel->sample_count++;
+    store->samples_stored++;
+
+    // Sealed chunks that ended before the horizon are no longer needed
+    while (channel->oldest != channel->newest &&
+           channel->oldest->last_us < time_us - store->horizon_us) {
+        evict_oldest_chunk(store, channel);
+    }
+
+    return 0;
+}
+
+// Append one sample
+int append_history_sample(history_store_t* store, const sensor_data_t* sample) {
+    if (!store || !store->chunks || !sample) return -1;
+
+    pthread_mutex_lock(&store->lock);
+    int result = append_sample_locked(store, sample);
+    pthread_mutex_unlock(&store->lock);
+
+    return result;
+}
+
+// Visit samples of a channel within a range
+long scan_history_range(history_store_t* store, sensor_type_t type, int64_t from_ns, int64_t to_ns,
+                        history_visitor_t visitor, void* context) {
+    if (!store || !store->chunks || type < 0 || type >= SENSOR_TYPE_COUNT) return 0;
+
+    int64_t from_us = (from_ns + 999) / 1000;   // Stored timestamps are whole microseconds
+    int64_t to_us = to_ns / 1000;
+    long count = 0;
+
+    pthread_mutex_lock(&store->lock);
+
+    for (const history_chunk_t* chunk = store->channels[type].oldest; chunk; chunk = chunk->next) {
+        if (chunk->last_us < from_us) continue;
+        if (chunk->first_us > to_us) break;
+
+        chunk_reader_t reader = { .chunk = chunk };
+        for (uint32_t i = 0; i < chunk->count; i++) {
+            int64_t time_us;
+            double value;
+            decode_sample(&reader, &time_us, &value);
+            if (time_us < from_us || time_us > to_us) continue;
+
+            if (visitor) visitor(context, time_us * 1000, value);
+            count++;
+        }
+    }
+
+    pthread_mutex_unlock(&store->lock);
+    return count;
+}
+
+// Range scan into an array
+typedef struct {
+    history_point_t* points;
+    int max_points;
+    int count;
+} point_collector_t;
+
+static void collect_point(void* context, int64_t timestamp_ns, double value) {
+    point_collector_t* collector = context;
+    if (collector->count < collector->max_points) {
+        collector->points[collector->count].timestamp_ns = timestamp_ns;
+        collector->points[collector->count].value = value;
+        collector->count++;
+    }
+}
+
+// Copy up to max_points samples of a range
+int query_history_range(history_store_t* store, sensor_type_t type, int64_t from_ns, int64_t to_ns,
+                        history_point_t* points, int max_points) {
+    if (!points || max_points <= 0) return 0;
+
+    point_collector_t collector = { points, max_points, 0 };
+    scan_history_range(store, type, from_ns, to_ns, collect_point, &collector);
+    return collector.count;
+}
+
+// Merge one sample into an aggregate
+static void aggregate_point(history_aggregate_t* aggregate, int64_t time_us, double value) {
+    if (aggregate->count == 0) {
+        aggregate->min = value;
+        aggregate->max = value;
+        aggregate->first = value;
+        aggregate->first_ns = time_us * 1000;
+    }
+    if (value < aggregate->min) aggregate->min = value;
+    if (value > aggregate->max) aggregate->max = value;
+    aggregate->last = value;
+    aggregate->last_ns = time_us * 1000;
+    aggregate->mean += value;   // Running sum until the end of the query
+    aggregate->count++;
+}
+
+// Count, min, max, mean, first and last over a range
+int query_history_aggregate(history_store_t* store, sensor_type_t type, int64_t from_ns, int64_t to_ns,
+                            history_aggregate_t* aggregate) {
+    if (!aggregate) return -1;
+    memset(aggregate, 0, sizeof(*aggregate));
+    if (!store || !store->chunks || type < 0 || type >= SENSOR_TYPE_COUNT) return -1;
+
+    int64_t from_us = (from_ns + 999) / 1000;   // Stored timestamps are whole microseconds
+    int64_t to_us = to_ns / 1000;
+
+    pthread_mutex_lock(&store->lock);
+
+    for (const history_chunk_t* chunk = store->channels[type].oldest; chunk; chunk = chunk->next) {
+        if (chunk->last_us < from_us) continue;
+        if (chunk->first_us > to_us) break;
+
+        if (chunk->first_us >= from_us && chunk->last_us <= to_us) {
+            // Whole chunk in range: use its summary
+            if (aggregate->count == 0) {
+                aggregate->min = chunk->min;
+                aggregate->max = chunk->max;
+                aggregate->first = chunk->first_value;
+                aggregate->first_ns = chunk->first_us * 1000;
+            }
+            if (chunk->min < aggregate->min) aggregate->min = chunk->min;
+            if (chunk->max > aggregate->max) aggregate->max = chunk->max;
+            aggregate->last = chunk->last_value;
+            aggregate->last_ns = chunk->last_us * 1000;
+            aggregate->mean += chunk->sum;
+            aggregate->count += chunk->count;
+            continue;
+        }
+
+        chunk_reader_t reader = { .chunk = chunk };
+        for (uint32_t i = 0; i < chunk->count; i++) {
+            int64_t time_us;
+            double value;
+            decode_sample(&reader, &time_us, &value);
+            if (time_us >= from_us && time_us <= to_us) {
+                aggregate_point(aggregate, time_us, value);
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&store->lock);
+
+    if (aggregate->count > 0) {
+        aggregate->mean /= aggregate->count;
+    }
+    return 0;
+}
+
+// Subscriber callback: store a batch under one lock
+static void history_subscriber(void* context, const sensor_data_t* samples, int count) {
+    history_store_t* store = context;
+
+    pthread_mutex_lock(&store->lock);
+    for (int i = 0; i < count; i++) {
+        append_sample_locked(store, &samples[i]);
+    }
+    pthread_mutex_unlock(&store->lock);
+}
+
+// Value of key in a URL query ("a=1&b=2"), or NULL
+static const char* query_value(const char* query, const char* key, char* buffer, size_t buffer_size) {
+    size_t key_length = strlen(key);
+
+    for (const char* p = query; p && *p; ) {
+        if (strncmp(p, key, key_length) == 0 && p[key_length] == '=') {
+            const char* value = p + key_length + 1;
+            size_t length = strcspn(value, "&");
+            if (length >= buffer_size) length = buffer_size - 1;
+            memcpy(buffer, value, length);
+            buffer[length] = '\0';
+            return buffer;
+        }
+        p = strchr(p, '&');
+        if (p) p++;
+    }
+
+    return NULL;
+}
+
+// Decimating writer for the /history response
+typedef struct {
+    FILE* out;
+    long stride;
+    long seen;
+    int written;
+} history_json_writer_t;
+
+static void write_history_point(void* context, int64_t timestamp_ns, double value) {
+    history_json_writer_t* writer = context;
+    if (writer->seen++ % writer->stride != 0) return;
+
+    fprintf(writer->out, "%s[%lld,%.9g]", writer->written++ ? "," : "", (long long)timestamp_to_realtime_ns(timestamp_ns), value);
+}
+
+// GET /history?channel=VIB&seconds=600&points=500
+static void handle_history_request(FILE* out, const char* query, void* context) {
+    history_store_t* store = context;
+    char buffer[32];
+
+    sensor_type_t type;
+    const char* channel = query_value(query, "channel", buffer, sizeof(buffer));
+    if (!channel || sensor_type_from_name(channel, &type) != 0) {
+        fprintf(out, "{\"error\":\"channel must be one of TEMP, VIB, STRAIN, HUM, PRESS, ACCEL_X, ACCEL_Y, ACCEL_Z\"}\n");
+        return;
+    }
+
+    long seconds = query_value(query, "seconds", buffer, sizeof(buffer)) ? atol(buffer) : 0;
+    long points = query_value(query, "points", buffer, sizeof(buffer)) ? atol(buffer) : 500;
+    if (seconds <= 0) seconds = (long)(store->horizon_us / 1000000LL);
+    if (points <= 0) points = 500;
+
+    int64_t to_ns = get_current_time();
+    int64_t from_ns = to_ns - (int64_t)seconds * NS_PER_SEC;
+
+    history_aggregate_t aggregate;
+    query_history_aggregate(store, type, from_ns, to_ns, &aggregate);
+
+    fprintf(out, "{\"channel\":\"%s\",\"from_ns\":%lld,\"to_ns\":%lld,\"count\":%ld",
+            channel_names[type], (long long)timestamp_to_realtime_ns(from_ns),
+            (long long)timestamp_to_realtime_ns(to_ns), aggregate.count);
+    if (aggregate.count > 0) {
+        fprintf(out, ",\"min\":%.9g,\"max\":%.9g,\"mean\":%.9g,\"first\":%.9g,\"last\":%.9g",
+                aggregate.min, aggregate.max, aggregate.mean, aggregate.first, aggregate.last);
+    }
+
+    // Evenly decimated to at most 'points' samples
+    history_json_writer_t writer = { out, (aggregate.count + points - 1) / points, 0, 0 };
+    if (writer.stride < 1) writer.stride = 1;
+    fprintf(out, ",\"stride\":%ld,\"points\":[", writer.stride);
+    scan_history_range(store, type, from_ns, to_ns, write_history_point, &writer);
+    fprintf(out, "]}\n");
+}
+
+// Feed the store from the pipeline and serve it over HTTP
+int attach_history_store(history_store_t* store) {
+    if (!store || !store->chunks) return -1;
+
+    subscriber_config_t config = {
+        .name = "history",
+        .channel_mask = 0,
+        .callback = history_subscriber,
+        .context = store,
+        .queue_capacity = 16384,
+        .batch_size = 256,
+        .overload = OVERLOAD_DROP_OLDEST    // Recent history favours the newest samples
+    };
+    if (subscribe_samples(&config) < 0) return -1;
+
+    register_http_route("/history", "application/json", handle_history_request, store);
+
+    printf("History store: %ld s per channel in %.1f MB (%d chunks of %d bytes)\n",
+           (long)(store->horizon_us / 1000000LL),
+           store->chunk_total * sizeof(history_chunk_t) / (1024.0 * 1024.0),
+           store->chunk_total, HISTORY_CHUNK_BYTES);
+    return 0;
+}
+
+// Print memory use, compression and per-channel coverage
+void print_history_summary(history_store_t* store) {
+    if (!store || !store->chunks) return;
+
+    pthread_mutex_lock(&store->lock);
+
+    long bits = 0;
+    long samples = 0;
+    printf("\n=== History Store ===\n");
+    printf("%-10s %10s %8s %12s\n", "Channel", "Samples", "Chunks", "Covers s");
+
+    for (int i = 0; i < SENSOR_TYPE_COUNT; i++) {
+        const history_channel_t* channel = &store->channels[i];
+        if (!channel->oldest) continue;
+
+        for (const history_chunk_t* chunk = channel->oldest; chunk; chunk = chunk->next) {
+            bits += chunk->bit_length;
+        }
+        samples += channel->sample_count;
+
+        printf("%-10s %10ld %8ld %12.1f\n", channel_names[i], channel->sample_count, channel->chunk_count,
+               (channel->newest->last_us - channel->oldest->first_us) / 1e6);
+    }
+
+    printf("Chunks used: %d of %d, evicted: %ld (%ld samples)\n",
+           store->chunks_used, store->chunk_total, store->chunks_evicted, store->samples_evicted);
+    if (samples > 0) {
+        printf("Encoded size: %.2f bytes/sample (raw 16)\n", bits / 8.0 / samples);
+    }
+
+    pthread_mutex_unlock(&store->lock);
+}
+
+// Free the chunk pool
+void cleanup_history_store(history_store_t* store) {
+    if (!store || !store->chunks) return;
+
+    free(store->chunks);
+    store->chunks = NULL;
+    store->free_chunks = NULL;
+    pthread_mutex_destroy(&store->lock);
+}
@@ -1,3 +1,5 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <signal.h>
@@ -9,30 +11,99 @@
 #include "../include/hardware_interface.h"
 #include "../include/data_logger.h"
 #include "../include/data_analyzer.h"
+#include "../include/realtime.h"
+#include "../include/status_renderer.h"
+#include "../include/daemon.h"
+#include "../include/metrics.h"
+#include "../include/stage_probes.h"
+#include "../include/trace.h"
+#include "../include/bus_publisher.h"
+#include "../include/subscribers.h"
+#include "../include/task_pool.h"
+#include "../include/history_store.h"
+#include "../include/alert_rules.h"
+#include "../include/trigger_recorder.h"
 
 // Global variables for signal handling
 static volatile int running = 1;
 static data_logger_t* global_logger = NULL;
 static hardware_interface_t* global_hw = NULL;
 
+// Bridge analysis windows
+#define BRIDGE_RECENT_WINDOW 256   // Recent samples kept in memory
+#define BRIDGE_TREND_WINDOW 50     // Samples used for final trend analysis
+
+// Real-time execution state
+static realtime_config_t rt_config;
+static realtime_report_t rt_report;
+
+// Console status refresh rate
+static int status_refresh_hz = STATUS_DEFAULT_REFRESH_HZ;
+
+// Recent sample history (--history)
+static history_store_t history_store;
+static int history_enabled = 0;
+
+// Alert rules and limits (--rules)
+static alert_engine_t alert_engine;
+static int alerts_enabled = 0;
+static double absolute_limit = BRIDGE_DEFAULT_ABSOLUTE_LIMIT;
+
+// Pre/post-anomaly capture (--trigger-pre, --trigger-post, --log-decimation)
+static int trigger_pre_ms = 0;
+static int trigger_post_ms = 0;
+static int log_decimation = 1;
+
 // Signal handler for graceful shutdown
 void signal_handler(int signal) {
     printf("\nReceived signal %d. Shutting down gracefully...\n", signal);
     running = 0;
 }
 
-// Print real-time status
-void print_status(int sample_count, double current_value, const char* sensor_type, 
-                 const statistics_t* stats, const anomaly_result_t* anomaly) {
-    printf("\r[%d] %s: %.3f | Mean: %.3f | StdDev: %.3f", 
-           sample_count, sensor_type, current_value, stats->mean, stats->std_deviation);
-    
-    if (anomaly && anomaly->is_anomaly) {
-        printf(" | ANOMALY! (%.1f)", anomaly->severity);
+// Enter real-time mode if requested (before monitoring buffers are allocated)
+static void setup_realtime_mode(const runtime_options_t* options) {
+    init_realtime_config(&rt_config);
+    init_realtime_report(&rt_report);
+    
+    if (options->realtime) {
+        rt_config.enabled = 1;
+        rt_config.priority = options->rt_priority;
+        rt_config.acquisition_cpu = options->acquisition_cpu;
+        rt_config.writer_cpu = options->writer_cpu;
+        enable_realtime_mode(&rt_config, &rt_report);
+    }
+}
+
+// Stop optional background services; reports are printed after a completed run
+static void stop_background_services(int print_reports) {
+    stop_metrics_server();
+    stop_subscriber_pool();
+    stop_task_pool();
+    if (print_reports) {
+        print_subscriber_report();
+        print_task_pool_report();
+    }
+    if (alerts_enabled) {
+        if (print_reports) print_alert_report(&alert_engine);
+        cleanup_alert_rules(&alert_engine);
+        alerts_enabled = 0;
+    }
+    if (history_enabled) {
+        if (print_reports) print_history_summary(&history_store);
+        cleanup_history_store(&history_store);
+        history_enabled = 0;
+    }
+    stop_tracing();
+    stop_sample_bus();
+}
+
+// Sleep until the next sample is due
+static void wait_for_next_sample(realtime_timer_t* timer, int interval) {
+    if (rt_config.enabled) {
+        wait_next_period(timer, &rt_report);
+    } else {
+        sleep_ms(interval);
     }
-    
-    printf("                    "); // Clear any remaining characters
-    fflush(stdout);
 }
 
 // Bridge monitoring mode
@@ -46,10 +117,14 @@ int run_bridge_monitoring(int hardware_mode, const char* device_path, int durati
     statistics_t vibration_stats;
     moving_average_t moving_avg;
     anomaly_config_t anomaly_config;
+    bridge_accumulator_t bridge_acc;
+    sample_window_t recent_window;
+    analysis_context_t analysis;
+    status_renderer_t status;
     
     // Configure anomaly detection
     anomaly_config.threshold_multiplier = threshold;
-    anomaly_config.absolute_threshold = 1.0;  // 1 m/s² absolute limit
+    anomaly_config.absolute_threshold = absolute_limit;  // m/s², 1.0 unless set by --rules
     anomaly_config.window_size = 50;
     anomaly_config.min_samples_for_analysis = 20;
     
@@ -72,34 +147,76 @@ int run_bridge_monitoring(int hardware_mode, const char* device_path, int durati
         init_sensor_simulator();
     }
     
-    // Initialize analysis components
+    // Initialize analysis components; filter and window memory comes from the
+    // analysis context so the acquisition loop never allocates
     init_statistics(&vibration_stats);
-    init_moving_average(&moving_avg, 20);  // 20-sample moving average
     
-    // Data collection arrays for analysis
-    const int max_samples = (duration * 1000) / interval;
-    sensor_data_t* vibration_data = malloc(max_samples * sizeof(sensor_data_t));
-    if (!vibration_data) {
+    // Streaming analysis state (constant memory regardless of duration)
+    init_bridge_accumulator(&bridge_acc);
+    if (init_analysis_context(&analysis, 0) != 0 ||
+        init_moving_average_in(&moving_avg, 20, &analysis) != 0 ||  // 20-sample moving average
+        init_sample_window_in(&recent_window, BRIDGE_RECENT_WINDOW, &analysis) != 0) {
         fprintf(stderr, "Memory allocation failed\n");
+        cleanup_analysis_context(&analysis);
         if (hardware_mode) cleanup_hardware_interface(&hw);
         cleanup_data_logger(&logger);
         return -1;
     }
     
+    // Raw context around anomalies goes to event files; the main log may be decimated
+    trigger_recorder_t trigger;
+    int trigger_ready = 0;
+    if (trigger_pre_ms > 0) {
+        trigger_config_t trigger_config;
+        trigger_config.pre_ms = trigger_pre_ms;
+        trigger_config.post_ms = trigger_post_ms;
+        trigger_config.interval_ms = interval;
+        trigger_config.decimation = log_decimation;
+        trigger_config.channel_mask = 1u << SENSOR_VIBRATION;
+        trigger_ready = init_trigger_recorder(&trigger, log_filename, &trigger_config) == 0;
+    }
+    
+    // Make buffers resident before the sampling loop starts
+    if (rt_config.enabled) {
+        prefault_memory(logger.buffer, logger.config.buffer_size * sizeof(sensor_data_t));
+        prefault_memory(moving_avg.buffer, moving_avg.buffer_size * sizeof(double));
+        prefault_memory(recent_window.samples,
+                        2 * (size_t)recent_window.capacity * sizeof(sensor_data_t));
+    }
+    
     printf("Starting bridge vibration monitoring...\n");
-    printf("Duration: %d seconds | Interval: %d ms | Mode: %s\n", 
-           duration, interval, hardware_mode ? "Hardware" : "Simulated");
+    if (duration > 0) {
+        printf("Duration: %d seconds | Interval: %d ms | Mode: %s\n", 
+               duration, interval, hardware_mode ? "Hardware" : "Simulated");
+    } else {
+        printf("Duration: until stopped | Interval: %d ms | Mode: %s\n", 
+               interval, hardware_mode ? "Hardware" : "Simulated");
+    }
     printf("Output: %s\n", logger.current_filename);
     printf("Press Ctrl+C to stop early\n\n");
     
-    precise_time_t start_time = get_current_time();
-    int sample_count = 0;
-    int anomaly_count = 0;
+    // Status line is rendered from its own thread at a fixed refresh rate
+    init_status_renderer(&status, status_refresh_hz);
+    int status_value = add_status_field(&status, "Vibration", "", 3);
+    int status_mean = add_status_field(&status, "Mean", "", 3);
+    int status_stddev = add_status_field(&status, "StdDev", "", 3);
+    int status_ma = add_status_field(&status, "MA", "", 3);
+    start_status_renderer(&status);
+    
+    int bus_source = register_bus_source("bridge");
+    
+    timestamp_ns_t start_time = get_current_time();
+    realtime_timer_t timer;
+    init_realtime_timer(&timer, interval);
+    long sample_count = 0;
+    long anomaly_count = 0;
     
-    while (running && sample_count < max_samples) {
+    while (running) {
         sensor_data_t data;
         
         // Get sensor data
+        PROBE_BEGIN(probe_start);
+        trace_begin("acquire");
         if (hardware_mode) {
             if (read_sensor_from_hardware(&hw, &data) != 0) {
                 printf("\nWarning: Failed to read from hardware, using simulated data\n");
@@ -108,16 +225,26 @@ int run_bridge_monitoring(int hardware_mode, const char* device_path, int durati
         } else {
             data = generate_bridge_vibration_data();
         }
+        trace_end("acquire");
+        PROBE_END(STAGE_ACQUISITION, probe_start);
+        
+        // Live consumers see the sample before analysis and logging
+        publish_bus_samples(bus_source, &data, 1);
+        dispatch_subscriber_samples(&data, 1);
         
-        // Store data for analysis
-        vibration_data[sample_count] = data;
+        // Feed streaming analysis
+        trace_begin("analyze");
+        update_bridge_accumulator(&bridge_acc, data.value);
+        push_sample_window(&recent_window, &data);
         
         // Update statistics
         update_statistics(&vibration_stats, data.value);
         double moving_average = update_moving_average(&moving_avg, data.value);
         
-        // Log data
-        log_sensor_data(&logger, &data);
+        // Log data (every sample, or every Nth while trigger capture keeps the raw stream)
+        if (!trigger_ready || record_trigger_sample(&trigger, &data)) {
+            log_sensor_data(&logger, &data);
+        }
         
         // Anomaly detection (after sufficient samples)
         anomaly_result_t anomaly = {0};
@@ -126,40 +253,40 @@ int run_bridge_monitoring(int hardware_mode, const char* device_path, int durati
             anomaly = detect_anomaly(&data, &vibration_stats, &anomaly_config);
             if (anomaly.is_anomaly) {
                 anomaly_count++;
-                print_anomaly_result(&anomaly);
+                post_status_anomaly(&status, &anomaly);
+                if (trigger_ready) fire_trigger(&trigger, &data, anomaly.description);
             }
         }
         
-        // Print real-time status (include moving average)
-        printf("\r[%d] %s: %.3f | Mean: %.3f | StdDev: %.3f | MA: %.3f", 
-               sample_count + 1, "Vibration", data.value, vibration_stats.mean, 
-               vibration_stats.std_deviation, moving_average);
-        
-        if (anomaly.is_anomaly) {
-            printf(" | ANOMALY! (%.1f)", anomaly.severity);
-        }
-        
-        printf("                    "); // Clear any remaining characters
-        fflush(stdout);
+        // Publish real-time status (include moving average)
+        set_status_field(&status, status_value, data.value);
+        set_status_field(&status, status_mean, vibration_stats.mean);
+        set_status_field(&status, status_stddev, vibration_stats.std_deviation);
+        set_status_field(&status, status_ma, moving_average);
+        count_status_sample(&status);
+        trace_end("analyze");
         
         sample_count++;
         
-        // Check if duration exceeded
-        precise_time_t current_time = get_current_time();
-        if (time_diff_ms(start_time, current_time) >= (duration * 1000)) {
+        // Check if duration exceeded (0 = run until stopped)
+        if (duration > 0 && get_current_time() - start_time >= (int64_t)duration * NS_PER_SEC) {
             break;
         }
         
         // Sleep for interval
-        sleep_ms(interval);
+        trace_begin("wait");
+        wait_for_next_sample(&timer, interval);
+        trace_end("wait");
     }
     
-    printf("\n\nData collection completed.\n");
+    stop_status_renderer(&status);
+    printf("\nData collection completed.\n");
     
     // Final analysis
     finalize_statistics(&vibration_stats);
-    bridge_analysis_t bridge_analysis = analyze_bridge_vibration(vibration_data, sample_count);
-    trend_analysis_t trend = analyze_trend(vibration_data, sample_count, 50);
+    bridge_analysis_t bridge_analysis = finalize_bridge_accumulator(&bridge_acc);
+    trend_analysis_t trend = analyze_trend(sample_window_data(&recent_window), 
+                                           recent_window.count, BRIDGE_TREND_WINDOW);
     
     // Print results
     print_statistics(&vibration_stats, "Bridge Vibration");
@@ -167,14 +294,21 @@ int run_bridge_monitoring(int hardware_mode, const char* device_path, int durati
     print_trend_analysis(&trend);
     
     printf("\nSummary:\n");
-    printf("- Total samples: %d\n", sample_count);
-    printf("- Anomalies detected: %d (%.1f%%)\n", 
-           anomaly_count, (anomaly_count * 100.0) / sample_count);
+    printf("- Total samples: %ld\n", sample_count);
+    printf("- Anomalies detected: %ld (%.1f%%)\n", 
+           anomaly_count, sample_count > 0 ? (anomaly_count * 100.0) / sample_count : 0.0);
     printf("- Data logged to: %s\n", logger.current_filename);
     
+    if (trigger_ready) {
+        flush_trigger_recorder(&trigger);
+        print_trigger_summary(&trigger);
+        cleanup_trigger_recorder(&trigger);
+    }
+    
     // Cleanup
-    free(vibration_data);
+    cleanup_sample_window(&recent_window);
     cleanup_moving_average(&moving_avg);
+    cleanup_analysis_context(&analysis);
     if (hardware_mode) cleanup_hardware_interface(&hw);
     cleanup_data_logger(&logger);
     cleanup_sensor_simulator();
@@ -191,6 +325,7 @@ int run_environmental_monitoring(int hardware_mode, const char* device_path, int
     data_logger_t logger;
     hardware_interface_t hw;
     statistics_t temp_stats, humidity_stats, pressure_stats;
+    status_renderer_t status;
     
     // Note: Anomaly detection not implemented for environmental mode in this version
     // Could be added later if needed
@@ -220,13 +355,34 @@ int run_environmental_monitoring(int hardware_mode, const char* device_path, int
     init_statistics(&humidity_stats);
     init_statistics(&pressure_stats);
     
+    // Make buffers resident before the sampling loop starts
+    if (rt_config.enabled) {
+        prefault_memory(logger.buffer, logger.config.buffer_size * sizeof(sensor_data_t));
+    }
+    
     printf("Starting environmental monitoring...\n");
-    printf("Duration: %d seconds | Interval: %d ms | Mode: %s\n", 
-           duration, interval, hardware_mode ? "Hardware" : "Simulated");
+    if (duration > 0) {
+        printf("Duration: %d seconds | Interval: %d ms | Mode: %s\n", 
+               duration, interval, hardware_mode ? "Hardware" : "Simulated");
+    } else {
+        printf("Duration: until stopped | Interval: %d ms | Mode: %s\n", 
+               interval, hardware_mode ? "Hardware" : "Simulated");
+    }
     printf("Output: %s\n", logger.current_filename);
     printf("Press Ctrl+C to stop early\n\n");
     
-    precise_time_t start_time = get_current_time();
+    // Status line is rendered from its own thread at a fixed refresh rate
+    init_status_renderer(&status, status_refresh_hz);
+    int status_temp = add_status_field(&status, "T", "°C", 1);
+    int status_humidity = add_status_field(&status, "H", "%", 1);
+    int status_pressure = add_status_field(&status, "P", "hPa", 1);
+    start_status_renderer(&status);
+    
+    int bus_source = register_bus_source("environmental");
+    
+    timestamp_ns_t start_time = get_current_time();
+    realtime_timer_t timer;
+    init_realtime_timer(&timer, interval);
     int sample_count = 0;
     
     while (running) {
@@ -234,66 +390,66 @@ int run_environmental_monitoring(int hardware_mode, const char* device_path, int
         int env_count;
         
         // Get environmental data set
+        PROBE_BEGIN(probe_start);
+        trace_begin("acquire");
         if (hardware_mode) {
-            // In hardware mode, try to read individual sensors
-            env_count = 0;
-            for (int i = 0; i < 3; i++) {
-                if (read_sensor_from_hardware(&hw, &env_data[env_count]) == 0) {
-                    env_count++;
-                }
-            }
-            if (env_count == 0) {
+            // In hardware mode, read up to one line per sensor in one batch
+            env_count = read_sensor_batch_from_hardware(&hw, env_data, 3, 0);
+            if (env_count <= 0) {
                 printf("\nWarning: Failed to read from hardware, using simulated data\n");
                 generate_environmental_data_set(env_data, &env_count);
             }
         } else {
             generate_environmental_data_set(env_data, &env_count);
         }
+        trace_end("acquire");
+        PROBE_END(STAGE_ACQUISITION, probe_start);
+        
+        publish_bus_samples(bus_source, env_data, env_count);
+        dispatch_subscriber_samples(env_data, env_count);
         
         // Process each sensor reading
+        trace_begin("analyze");
         for (int i = 0; i < env_count; i++) {
             // Update appropriate statistics
             switch (env_data[i].type) {
                 case SENSOR_TEMPERATURE:
                     update_statistics(&temp_stats, env_data[i].value);
+                    set_status_field(&status, status_temp, env_data[i].value);
                     break;
                 case SENSOR_HUMIDITY:
                     update_statistics(&humidity_stats, env_data[i].value);
+                    set_status_field(&status, status_humidity, env_data[i].value);
                     break;
                 case SENSOR_PRESSURE:
                     update_statistics(&pressure_stats, env_data[i].value);
+                    set_status_field(&status, status_pressure, env_data[i].value);
                     break;
                 default:
                     break;
             }
-            
-            // Log data
-            log_sensor_data(&logger, &env_data[i]);
         }
         
-        sample_count++;
+        // Log the set together (one flush check)
+        log_sensor_data_batch(&logger, env_data, env_count);
+        trace_end("analyze");
         
-        // Print status every 10 samples
-        if (sample_count % 10 == 0) {
-            printf("\r[%d] T:%.1f°C H:%.1f%% P:%.1fhPa", 
-                   sample_count, 
-                   env_data[0].value, 
-                   env_data[1].value, 
-                   env_data[2].value);
-            fflush(stdout);
-        }
+        sample_count++;
+        count_status_sample(&status);
         
-        // Check if duration exceeded
-        precise_time_t current_time = get_current_time();
-        if (time_diff_ms(start_time, current_time) >= (duration * 1000)) {
+        // Check if duration exceeded (0 = run until stopped)
+        if (duration > 0 && get_current_time() - start_time >= (int64_t)duration * NS_PER_SEC) {
             break;
         }
         
         // Sleep for interval
-        sleep_ms(interval);
+        trace_begin("wait");
+        wait_for_next_sample(&timer, interval);
+        trace_end("wait");
     }
     
-    printf("\n\nData collection completed.\n");
+    stop_status_renderer(&status);
+    printf("\nData collection completed.\n");
     
     // Final analysis
     finalize_statistics(&temp_stats);
@@ -325,9 +481,11 @@ int main(int argc, char* argv[]) {
     char* output_file = NULL;
     double threshold = 3.0;
     int hardware_mode = 0;
+    runtime_options_t options;
     
     int parse_result = parse_command_line_args(argc, argv, &device_path, &duration, 
-                                              &interval, &output_file, &threshold, &hardware_mode);
+                                              &interval, &output_file, &threshold, &hardware_mode,
+                                              &options);
     
     if (parse_result == 1) {
         // Help was shown
@@ -350,6 +508,90 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    int result = 0;
+    
+    // A bad daemon config must fail before any background service is running
+    daemon_config_t daemon_config;
+    if (options.config_file && load_daemon_config(options.config_file, &daemon_config) != 0) {
+        return 1;
+    }
+    
+#ifdef ENABLE_STAGE_PROBES
+    init_stage_probes();
+    if (options.perf_counters) {
+        enable_stage_perf_counters();
+    }
+#else
+    if (options.perf_counters) {
+        fprintf(stderr, "Warning: --perf-counters needs a 'make probes' build; ignoring\n");
+    }
+#endif
+    
+    // Tracing starts before any worker thread so they inherit its signal mask
+    if (options.trace_file) {
+        start_tracing(options.trace_file);
+    }
+    
+    // Metrics endpoint is optional; logging continues without it
+    if (options.metrics_port > 0) {
+        start_metrics_server(options.metrics_port);
+    }
+    
+    // Live sample bus for local consumers; logging continues without it
+    if (options.bus_name) {
+        start_sample_bus(options.bus_name, options.bus_slots);
+    }
+    
+    // Analysis subscribers run on their own threads so they never delay acquisition
+    start_subscriber_pool(options.subscriber_threads);
+    
+    // Batch analysis splits large arrays across the task pool; without it everything runs inline
+    if (options.analysis_threads >= 0) {
+        start_task_pool(options.analysis_threads);
+    }
+    
+    // Recent history is fed by a subscriber and served next to /metrics
+    if (options.history_seconds > 0) {
+        if (init_history_store(&history_store, options.history_seconds, options.history_mb) == 0) {
+            history_enabled = 1;
+            attach_history_store(&history_store);
+        }
+    }
+    
+    // Alert rules are evaluated by a subscriber; the file may also set analysis limits
+    if (options.rules_file) {
+        if (load_alert_rules(options.rules_file, &alert_engine) != 0) {
+            stop_background_services(0);
+            return 1;
+        }
+        alerts_enabled = 1;
+        set_bridge_safety_limits(&alert_engine.limits.bridge);
+        absolute_limit = alert_engine.limits.absolute_threshold;
+        if (options.config_file) {
+            daemon_config.bridge_absolute_limit = absolute_limit;
+        }
+        if (alert_engine.rule_count > 0) {
+            attach_alert_rules(&alert_engine);
+        }
+    }
+    
+    // Headless daemon mode runs every configured profile without prompting
+    if (options.config_file) {
+        setup_realtime_mode(&options);
+        result = run_daemon(&daemon_config, &rt_config, &running, &rt_report);
+        
+        if (rt_config.enabled) {
+            print_realtime_report(&rt_report);
+        }
+#ifdef ENABLE_STAGE_PROBES
+        print_stage_latency_table();
+#endif
+        
+        stop_background_services(1);
+        printf("\nDaemon %s.\n", result == 0 ? "stopped" : "failed with errors");
+        return result == 0 ? 0 : 1;
+    }
+    
     // Ask user for monitoring mode
     printf("\nSelect monitoring mode:\n");
     printf("1. Bridge Vibration Monitoring\n");
@@ -359,10 +601,16 @@ int main(int argc, char* argv[]) {
     int choice;
     if (scanf("%d", &choice) != 1) {
         fprintf(stderr, "Invalid input\n");
+        stop_background_services(0);
         return 1;
     }
     
-    int result = 0;
+    status_refresh_hz = options.status_hz;
+    trigger_pre_ms = options.trigger_pre_ms;
+    trigger_post_ms = options.trigger_post_ms >= 0 ? options.trigger_post_ms : options.trigger_pre_ms;
+    log_decimation = options.log_decimation;
+    
+    setup_realtime_mode(&options);
     
     switch (choice) {
         case 1:
@@ -375,9 +623,19 @@ int main(int argc, char* argv[]) {
             break;
         default:
             fprintf(stderr, "Invalid choice\n");
+            stop_background_services(0);
             return 1;
     }
     
+    stop_background_services(1);
+    
+    if (rt_config.enabled) {
+        print_realtime_report(&rt_report);
+    }
+#ifdef ENABLE_STAGE_PROBES
+    print_stage_latency_table();
+#endif
+    
     if (result == 0) {
         printf("\nData logging completed successfully!\n");
     } else {
@@ -0,0 +1,412 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/metrics.h"
+#include "../include/realtime.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sched.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// Metric kinds
+typedef enum {
+    METRIC_COUNTER,
+    METRIC_GAUGE,
+    METRIC_HISTOGRAM
+} metric_kind_t;
+
+// Registry entry
+typedef struct {
+    metric_kind_t kind;
+    char name[64];
+    char help[128];
+    void* metric;
+} metric_entry_t;
+
+// Histogram bucket upper bounds in nanoseconds
+static const long histogram_bounds_ns[METRICS_HISTOGRAM_BUCKETS] = {
+    1000L, 2500L, 5000L, 10000L, 25000L, 50000L, 100000L, 250000L,
+    500000L, 1000000L, 2500000L, 5000000L, 10000000L, 100000000L,
+    1000000000L, 10000000000L
+};
+
+// Global registry (registration is rare and locked; updates never lock)
+static metric_entry_t registry[METRICS_MAX_METRICS];
+static int registry_count = 0;
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Per-thread shard assignment
+static atomic_int next_shard = 0;
+static __thread int thread_shard = -1;
+
+// Extra HTTP paths
+typedef struct {
+    char path[64];
+    char content_type[64];
+    http_route_handler_t handler;
+    void* context;
+} http_route_t;
+
+static http_route_t routes[METRICS_MAX_ROUTES];
+static int route_count = 0;
+
+// HTTP server state
+static pthread_t server_thread;
+static int server_fd = -1;
+static atomic_int server_running = 0;
+
+// Shard used by the calling thread
+static int current_shard(void) {
+    if (thread_shard < 0) {
+        thread_shard = atomic_fetch_add_explicit(&next_shard, 1, memory_order_relaxed) % METRICS_SHARDS;
+    }
+    return thread_shard;
+}
+
+// Find or create a registry entry
+static void* register_metric(metric_kind_t kind, const char* name, const char* help, size_t size) {
+    if (!name) return NULL;
+
+    void* metric = NULL;
+    pthread_mutex_lock(&registry_lock);
+
+    for (int i = 0; i < registry_count; i++) {
+        if (strcmp(registry[i].name, name) == 0) {
+            metric = registry[i].kind == kind ? registry[i].metric : NULL;
+            pthread_mutex_unlock(&registry_lock);
+            return metric;
+        }
+    }
+
+    if (registry_count < METRICS_MAX_METRICS) {
+        metric = calloc(1, size);
+        if (metric) {
+            metric_entry_t* entry = &registry[registry_count++];
+            entry->kind = kind;
+            snprintf(entry->name, sizeof(entry->name), "%s", name);
+            snprintf(entry->help, sizeof(entry->help), "%s", help ? help : "");
+            entry->metric = metric;
+        }
+    }
+
+    pthread_mutex_unlock(&registry_lock);
+    return metric;
+}
+
+metrics_counter_t* register_counter(const char* name, const char* help) {
+    return register_metric(METRIC_COUNTER, name, help, sizeof(metrics_counter_t));
+}
+
+metrics_gauge_t* register_gauge(const char* name, const char* help) {
+    return register_metric(METRIC_GAUGE, name, help, sizeof(metrics_gauge_t));
+}
+
+metrics_histogram_t* register_histogram(const char* name, const char* help) {
+    return register_metric(METRIC_HISTOGRAM, name, help, sizeof(metrics_histogram_t));
+}
+
+// Add to a counter
+void counter_add(metrics_counter_t* counter, long amount) {
+    if (!counter) return;
+    atomic_fetch_add_explicit(&counter->shards[current_shard()].value, amount, memory_order_relaxed);
+}
+
+// Set a gauge
+void gauge_set(metrics_gauge_t* gauge, int64_t value) {
+    if (!gauge) return;
+    atomic_store_explicit(&gauge->value, value, memory_order_relaxed);
+}
+
+// Adjust a gauge
+void gauge_add(metrics_gauge_t* gauge, int64_t amount) {
+    if (!gauge) return;
+    atomic_fetch_add_explicit(&gauge->value, amount, memory_order_relaxed);
+}
+
+// Record a latency observation
+void histogram_observe_ns(metrics_histogram_t* histogram, long nanoseconds) {
+    if (!histogram) return;
+
+    int bucket = 0;
+    while (bucket < METRICS_HISTOGRAM_BUCKETS && nanoseconds > histogram_bounds_ns[bucket]) {
+        bucket++;
+    }
+
+    metrics_histogram_shard_t* shard = &histogram->shards[current_shard()];
+    atomic_fetch_add_explicit(&shard->buckets[bucket], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&shard->sum_ns, nanoseconds, memory_order_relaxed);
+}
+
+// Monotonic nanosecond clock for latency measurements (the sample time base)
+int64_t metrics_now_ns(void) {
+    return get_current_time();
+}
+
+// Sum counter shards
+static long counter_value(metrics_counter_t* counter) {
+    long total = 0;
+    for (int i = 0; i < METRICS_SHARDS; i++) {
+        total += atomic_load_explicit(&counter->shards[i].value, memory_order_relaxed);
+    }
+    return total;
+}
+
+// Write one histogram in exposition format
+static void write_histogram(FILE* out, const char* name, metrics_histogram_t* histogram) {
+    long cumulative = 0;
+    long sum_ns = 0;
+
+    for (int b = 0; b <= METRICS_HISTOGRAM_BUCKETS; b++) {
+        for (int s = 0; s < METRICS_SHARDS; s++) {
+            cumulative += atomic_load_explicit(&histogram->shards[s].buckets[b], memory_order_relaxed);
+        }
+
+        if (b < METRICS_HISTOGRAM_BUCKETS) {
+            fprintf(out, "%s_bucket{le=\"%g\"} %ld\n", name, histogram_bounds_ns[b] / 1e9, cumulative);
+        } else {
+            fprintf(out, "%s_bucket{le=\"+Inf\"} %ld\n", name, cumulative);
+        }
+    }
+
+    for (int s = 0; s < METRICS_SHARDS; s++) {
+        sum_ns += atomic_load_explicit(&histogram->shards[s].sum_ns, memory_order_relaxed);
+    }
+
+    fprintf(out, "%s_sum %.9f\n", name, sum_ns / 1e9);
+    fprintf(out, "%s_count %ld\n", name, cumulative);
+}
+
+// Write all metrics in Prometheus text exposition format
+int write_metrics(FILE* out) {
+    if (!out) return -1;
+
+    pthread_mutex_lock(&registry_lock);
+    int count = registry_count;
+    pthread_mutex_unlock(&registry_lock);
+
+    // Entries are never removed, so the first 'count' entries are stable
+    for (int i = 0; i < count; i++) {
+        const metric_entry_t* entry = &registry[i];
+
+        fprintf(out, "# HELP %s %s\n", entry->name, entry->help);
+
+        switch (entry->kind) {
+            case METRIC_COUNTER:
+                fprintf(out, "# TYPE %s counter\n", entry->name);
+                fprintf(out, "%s %ld\n", entry->name, counter_value(entry->metric));
+                break;
+            case METRIC_GAUGE: {
+                metrics_gauge_t* gauge = entry->metric;
+                fprintf(out, "# TYPE %s gauge\n", entry->name);
+                fprintf(out, "%s %lld\n", entry->name,
+                        (long long)atomic_load_explicit(&gauge->value, memory_order_relaxed));
+                break;
+            }
+            case METRIC_HISTOGRAM:
+                fprintf(out, "# TYPE %s histogram\n", entry->name);
+                write_histogram(out, entry->name, entry->metric);
+                break;
+        }
+    }
+
+    return 0;
+}
+
+// Serve handler for GET <path> on the metrics server
+int register_http_route(const char* path, const char* content_type,
+                        http_route_handler_t handler, void* context) {
+    if (!path || path[0] != '/' || !handler) return -1;
+
+    pthread_mutex_lock(&registry_lock);
+    if (route_count >= METRICS_MAX_ROUTES) {
+        pthread_mutex_unlock(&registry_lock);
+        fprintf(stderr, "Error: HTTP route table full; cannot serve %s\n", path);
+        return -1;
+    }
+
+    http_route_t* route = &routes[route_count];
+    snprintf(route->path, sizeof(route->path), "%s", path);
+    snprintf(route->content_type, sizeof(route->content_type), "%s",
+             content_type ? content_type : "text/plain");
+    route->handler = handler;
+    route->context = context;
+    route_count++;
+    pthread_mutex_unlock(&registry_lock);
+
+    return 0;
+}
+
+// Registered route for a request target ("/path?query"), NULL if none
+static const http_route_t* find_http_route(const char* target, const char** query) {
+    size_t path_length = strcspn(target, "? ");
+    *query = target[path_length] == '?' ? target + path_length + 1 : "";
+
+    pthread_mutex_lock(&registry_lock);
+    int count = route_count;
+    pthread_mutex_unlock(&registry_lock);
+
+    for (int i = 0; i < count; i++) {
+        if (strlen(routes[i].path) == path_length && strncmp(routes[i].path, target, path_length) == 0) {
+            return &routes[i];
+        }
+    }
+
+    return NULL;
+}
+
+// Send the whole buffer, retrying on short writes
+static void send_all(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t sent = send(fd, data, length, MSG_NOSIGNAL);
+        if (sent <= 0) return;
+        data += sent;
+        length -= (size_t)sent;
+    }
+}
+
+// Answer one HTTP request
+static void handle_metrics_request(int client_fd) {
+    char request[1024];
+    ssize_t received = recv(client_fd, request, sizeof(request) - 1, 0);
+    if (received <= 0) return;
+    request[received] = '\0';
+
+    char* body = NULL;
+    size_t body_length = 0;
+    const char* status = "200 OK";
+    const char* content_type = "text/plain; version=0.0.4";
+    const http_route_t* route = NULL;
+    const char* query = "";
+
+    // Query text ends at the space before the HTTP version
+    char* version = strstr(request, " HTTP/");
+    if (version) *version = '\0';
+
+    if (strncmp(request, "GET /metrics", 12) == 0 || strcmp(request, "GET /") == 0) {
+        FILE* out = open_memstream(&body, &body_length);
+        if (!out) return;
+        write_metrics(out);
+        fclose(out);
+    } else if (strncmp(request, "GET ", 4) == 0 && (route = find_http_route(request + 4, &query)) != NULL) {
+        FILE* out = open_memstream(&body, &body_length);
+        if (!out) return;
+        route->handler(out, query, route->context);
+        fclose(out);
+        content_type = route->content_type;
+    } else {
+        status = "404 Not Found";
+    }
+
+    char header[256];
+    int header_length = snprintf(header, sizeof(header),
+                                 "HTTP/1.0 %s\r\n"
+                                 "Content-Type: %s\r\n"
+                                 "Content-Length: %zu\r\n"
+                                 "Connection: close\r\n\r\n",
+                                 status, content_type, body_length);
+
+    send_all(client_fd, header, (size_t)header_length);
+    if (body) {
+        send_all(client_fd, body, body_length);
+        free(body);
+    }
+}
+
+// HTTP server thread
+static void* metrics_server_main(void* arg) {
+    (void)arg;
+
+    // Serving scrapes must not disturb a pinned acquisition thread
+    reset_current_thread_affinity();
+
+    struct pollfd pfd;
+    pfd.fd = server_fd;
+    pfd.events = POLLIN;
+
+    while (atomic_load(&server_running)) {
+        if (poll(&pfd, 1, 200) <= 0) continue;
+
+        int client_fd = accept(server_fd, NULL, NULL);
+        if (client_fd < 0) continue;
+
+        // Clients are served one at a time, so none may hold up the others (or shutdown)
+        struct timeval timeout;
+        timeout.tv_sec = METRICS_CLIENT_TIMEOUT_MS / 1000;
+        timeout.tv_usec = (METRICS_CLIENT_TIMEOUT_MS % 1000) * 1000;
+        setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        handle_metrics_request(client_fd);
+        close(client_fd);
+    }
+
+    return NULL;
+}
+
+// Serve metrics over HTTP on 127.0.0.1:port
+int start_metrics_server(int port) {
+    if (port <= 0 || port > 65535 || server_fd >= 0) return -1;
+
+    server_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (server_fd < 0) {
+        fprintf(stderr, "Error: Cannot create metrics socket: %s\n", strerror(errno));
+        return -1;
+    }
+
+    int reuse = 1;
+    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons((uint16_t)port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (bind(server_fd, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+        listen(server_fd, 8) != 0) {
+        fprintf(stderr, "Error: Cannot listen on metrics port %d: %s\n", port, strerror(errno));
+        close(server_fd);
+        server_fd = -1;
+        return -1;
+    }
+
+    // Scrapes are served at normal priority
+    pthread_attr_t attr;
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    pthread_attr_setschedparam(&attr, &param);
+
+    atomic_store(&server_running, 1);
+    int result = pthread_create(&server_thread, &attr, metrics_server_main, NULL);
+    pthread_attr_destroy(&attr);
+
+    if (result != 0) {
+        fprintf(stderr, "Error: Cannot start metrics server: %s\n", strerror(result));
+        atomic_store(&server_running, 0);
+        close(server_fd);
+        server_fd = -1;
+        return -1;
+    }
+
+    printf("Metrics available at http://127.0.0.1:%d/metrics\n", port);
+    return 0;
+}
+
+// Stop the metrics HTTP server
+void stop_metrics_server(void) {
+    if (server_fd < 0) return;
+
+    atomic_store(&server_running, 0);
+    pthread_join(server_thread, NULL);
+    close(server_fd);
+    server_fd = -1;
+}
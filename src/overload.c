@@ -0,0 +1,61 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/overload.h"
+#include <string.h>
+#include <strings.h>
+
+static const char* policy_names[] = { "block", "drop_oldest", "drop_newest", "decimate" };
+static const char* priority_names[] = { "low", "normal", "critical" };
+
+// Look up a policy by name
+int parse_overload_policy(const char* name, overload_policy_t* policy) {
+    if (!name || !policy) return -1;
+
+    for (int i = 0; i < (int)(sizeof(policy_names) / sizeof(policy_names[0])); i++) {
+        if (strcasecmp(name, policy_names[i]) == 0) {
+            *policy = (overload_policy_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// Config name of a policy
+const char* overload_policy_name(overload_policy_t policy) {
+    if (policy < 0 || policy > OVERLOAD_DECIMATE) return "unknown";
+    return policy_names[policy];
+}
+
+// Look up a priority by name
+int parse_sample_priority(const char* name, sample_priority_t* priority) {
+    if (!name || !priority) return -1;
+
+    for (int i = 0; i < (int)(sizeof(priority_names) / sizeof(priority_names[0])); i++) {
+        if (strcasecmp(name, priority_names[i]) == 0) {
+            *priority = (sample_priority_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// Structural channels are critical, environmental channels low
+sample_priority_t default_sample_priority(sensor_type_t type) {
+    switch (type) {
+        case SENSOR_TEMPERATURE:
+        case SENSOR_HUMIDITY:
+        case SENSOR_PRESSURE:
+            return SAMPLE_PRIORITY_LOW;
+        default:
+            return SAMPLE_PRIORITY_CRITICAL;
+    }
+}
+
+// Count a shed sample in its channel's gap
+void record_sample_gap(sample_gap_t* gap, const sensor_data_t* sample) {
+    if (!gap || !sample) return;
+
+    if (gap->dropped == 0 || sample->timestamp < gap->first) gap->first = sample->timestamp;
+    if (gap->dropped == 0 || sample->timestamp > gap->last) gap->last = sample->timestamp;
+    gap->dropped++;
+}
@@ -0,0 +1,148 @@
+#define _GNU_SOURCE
+
+#include "../include/perf_counters.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+static const uint64_t event_configs[PERF_COUNTER_COUNT] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES
+};
+
+static const char* counter_names[PERF_COUNTER_COUNT] = {
+    "cycles",
+    "instructions",
+    "cache_misses",
+    "branch_misses"
+};
+
+// The unavailable warning is printed once per process
+static atomic_int warned_unavailable = 0;
+
+static int perf_event_open(struct perf_event_attr* attr, int group_fd) {
+    return (int)syscall(SYS_perf_event_open, attr, 0, -1, group_fd, 0);
+}
+
+// Open counters for the calling thread
+int open_perf_counters(perf_counters_t* counters) {
+    if (!counters) return 0;
+
+    counters->group_fd = -1;
+    int opened = 0;
+    int last_error = 0;
+
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = event_configs[i];
+        attr.disabled = counters->group_fd < 0;  // Only the leader starts disabled
+        attr.exclude_kernel = 1;                 // Allowed at perf_event_paranoid <= 2
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+                           PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        counters->fds[i] = perf_event_open(&attr, counters->group_fd);
+        counters->ids[i] = 0;
+        if (counters->fds[i] < 0) {
+            last_error = errno;
+            continue;
+        }
+
+        if (ioctl(counters->fds[i], PERF_EVENT_IOC_ID, &counters->ids[i]) != 0) {
+            close(counters->fds[i]);
+            counters->fds[i] = -1;
+            continue;
+        }
+
+        if (counters->group_fd < 0) {
+            counters->group_fd = counters->fds[i];
+        }
+        opened++;
+    }
+
+    if (opened == 0 && atomic_exchange(&warned_unavailable, 1) == 0) {
+        fprintf(stderr, "Warning: Hardware performance counters unavailable (%s); "
+                        "continuing with timing only\n", strerror(last_error));
+    }
+
+    return opened;
+}
+
+// Reset and start counting
+void start_perf_counters(perf_counters_t* counters) {
+    if (!counters || counters->group_fd < 0) return;
+
+    ioctl(counters->group_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(counters->group_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+// Stop counting
+void stop_perf_counters(perf_counters_t* counters) {
+    if (!counters || counters->group_fd < 0) return;
+
+    ioctl(counters->group_fd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+}
+
+// Read current values with one system call
+int read_perf_counters(const perf_counters_t* counters, perf_reading_t* reading) {
+    if (!reading) return -1;
+    memset(reading, 0, sizeof(*reading));
+    if (!counters || counters->group_fd < 0) return -1;
+
+    // Layout for PERF_FORMAT_GROUP | ID | TOTAL_TIME_ENABLED | TOTAL_TIME_RUNNING
+    uint64_t buffer[3 + 2 * PERF_COUNTER_COUNT];
+    if (read(counters->group_fd, buffer, sizeof(buffer)) <= 0) return -1;
+
+    uint64_t count = buffer[0];
+    uint64_t time_enabled = buffer[1];
+    uint64_t time_running = buffer[2];
+    if (count > PERF_COUNTER_COUNT) count = PERF_COUNTER_COUNT;
+
+    // Scale up when the group was only scheduled part of the time
+    double scale = time_running > 0 && time_running < time_enabled
+                       ? (double)time_enabled / (double)time_running : 1.0;
+
+    for (uint64_t n = 0; n < count; n++) {
+        uint64_t value = buffer[3 + 2 * n];
+        uint64_t id = buffer[4 + 2 * n];
+
+        for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+            if (counters->fds[i] >= 0 && counters->ids[i] == id) {
+                reading->values[i] = (uint64_t)((double)value * scale);
+                reading->valid[i] = 1;
+                break;
+            }
+        }
+    }
+
+    return 0;
+}
+
+// Close all counters
+void close_perf_counters(perf_counters_t* counters) {
+    if (!counters) return;
+
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        if (counters->fds[i] >= 0) {
+            close(counters->fds[i]);
+            counters->fds[i] = -1;
+        }
+    }
+    counters->group_fd = -1;
+}
+
+// Event name for reports
+const char* perf_counter_name(perf_counter_t counter) {
+    if (counter < 0 || counter >= PERF_COUNTER_COUNT) return "unknown";
+    return counter_names[counter];
+}
@@ -0,0 +1,282 @@
+#define _GNU_SOURCE
+
+#include "../include/realtime.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+// Maximum stack depth we are willing to prefault
+#define REALTIME_MAX_STACK_PREFAULT_KB 1024
+
+// Initialize configuration with defaults (disabled)
+void init_realtime_config(realtime_config_t* config) {
+    if (!config) return;
+
+    config->enabled = 0;
+    config->priority = 80;
+    config->acquisition_cpu = -1;
+    config->writer_cpu = -1;
+    config->lock_memory = 1;
+    config->stack_prefault_kb = 256;
+}
+
+// Initialize an empty report
+void init_realtime_report(realtime_report_t* report) {
+    if (!report) return;
+
+    memset(report, 0, sizeof(*report));
+    report->min_latency_us = INFINITY;
+}
+
+// Prefault the stack so the hot loop never takes a stack page fault
+static void prefault_stack(size_t size_kb) {
+    volatile unsigned char stack[REALTIME_MAX_STACK_PREFAULT_KB * 1024];
+    size_t size = size_kb * 1024;
+    long page_size = sysconf(_SC_PAGESIZE);
+
+    if (size > sizeof(stack)) size = sizeof(stack);
+    if (page_size <= 0) page_size = 4096;
+
+    for (size_t i = 0; i < size; i += (size_t)page_size) {
+        stack[i] = 0;
+    }
+}
+
+// Pin the calling thread to a CPU (-1 = leave unpinned)
+int pin_current_thread_to_cpu(int cpu) {
+    if (cpu < 0) return 0;
+
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        fprintf(stderr, "Warning: Cannot pin thread to CPU %d: %s\n", cpu, strerror(errno));
+        return -1;
+    }
+    return 0;
+#else
+    fprintf(stderr, "Warning: CPU pinning not supported on this platform\n");
+    return -1;
+#endif
+}
+
+// Drop the real-time setup a helper thread inherited from its creator: run
+// on every online CPU again, under SCHED_OTHER
+int reset_current_thread_affinity(void) {
+    int result = 0;
+
+    // An inherited SCHED_FIFO priority would compete with acquisition
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    if (sched_getscheduler(0) != SCHED_OTHER && sched_setscheduler(0, SCHED_OTHER, &param) != 0) {
+        result = -1;
+    }
+
+#ifdef __linux__
+    long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpu_count <= 0) return -1;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (long cpu = 0; cpu < cpu_count && cpu < CPU_SETSIZE; cpu++) {
+        CPU_SET(cpu, &set);
+    }
+
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) result = -1;
+#endif
+    return result;
+}
+
+// Run the calling thread under SCHED_FIFO at the given priority
+int set_current_thread_realtime_priority(int priority) {
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+
+    int min_priority = sched_get_priority_min(SCHED_FIFO);
+    int max_priority = sched_get_priority_max(SCHED_FIFO);
+    if (priority < min_priority) priority = min_priority;
+    if (priority > max_priority) priority = max_priority;
+    param.sched_priority = priority;
+
+    if (sched_setscheduler(0, SCHED_FIFO, &param) != 0) {
+        fprintf(stderr, "Warning: Cannot set SCHED_FIFO priority %d: %s\n",
+                priority, strerror(errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+// Touch every page of a buffer so it is resident before the hot loop
+void prefault_memory(void* buffer, size_t size) {
+    if (!buffer || size == 0) return;
+
+    volatile unsigned char* bytes = buffer;
+    long page_size = sysconf(_SC_PAGESIZE);
+    if (page_size <= 0) page_size = 4096;
+
+    // Read and write back so existing contents are preserved
+    for (size_t i = 0; i < size; i += (size_t)page_size) {
+        bytes[i] = bytes[i];
+    }
+    bytes[size - 1] = bytes[size - 1];
+}
+
+// Enable real-time mode for the calling (acquisition) thread
+int enable_realtime_mode(const realtime_config_t* config, realtime_report_t* report) {
+    if (!config || !report) return -1;
+
+    int failures = 0;
+
+    if (config->lock_memory) {
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+            report->memory_locked = 1;
+        } else {
+            fprintf(stderr, "Warning: Cannot lock memory: %s\n", strerror(errno));
+            failures++;
+        }
+    }
+
+    prefault_stack(config->stack_prefault_kb);
+
+    if (config->acquisition_cpu >= 0) {
+        if (pin_current_thread_to_cpu(config->acquisition_cpu) == 0) {
+            report->cpu_pinned = 1;
+        } else {
+            failures++;
+        }
+    }
+
+    if (set_current_thread_realtime_priority(config->priority) == 0) {
+        report->priority_set = 1;
+    } else {
+        failures++;
+    }
+
+    printf("Real-time mode: memory %s, priority %s, CPU %s\n",
+           report->memory_locked ? "locked" : "unlocked",
+           report->priority_set ? "SCHED_FIFO" : "default",
+           report->cpu_pinned ? "pinned" : "unpinned");
+
+    if (failures > 0) {
+        printf("Real-time mode degraded: %d step(s) need additional privileges "
+               "(CAP_SYS_NICE / CAP_IPC_LOCK)\n", failures);
+    }
+
+    return failures;
+}
+
+// Periodic timer for the acquisition loop
+void init_realtime_timer(realtime_timer_t* timer, int interval_ms) {
+    if (!timer) return;
+
+    timer->period_ns = (int64_t)interval_ms * NS_PER_MS;
+    timer->next_deadline = get_current_time() + timer->period_ns;
+}
+
+// Record a single wakeup latency
+static void record_latency(realtime_report_t* report, double latency_us, int64_t period_ns) {
+    report->wakeup_count++;
+    report->sum_latency_us += latency_us;
+    if (latency_us < report->min_latency_us) report->min_latency_us = latency_us;
+    if (latency_us > report->max_latency_us) report->max_latency_us = latency_us;
+    if (latency_us * 1000.0 > (double)period_ns) report->overrun_count++;
+
+    // Bucket 0 holds < 1us, bucket i holds [2^(i-1), 2^i) us
+    int bucket = 0;
+    while (bucket < REALTIME_LATENCY_BUCKETS - 1 && latency_us >= (double)(1L << bucket)) {
+        bucket++;
+    }
+    report->latency_buckets[bucket]++;
+}
+
+// Sleep until an absolute CLOCK_MONOTONIC deadline and record the wakeup latency
+void wait_until_deadline(timestamp_ns_t deadline, int64_t period_ns, realtime_report_t* report) {
+    struct timespec wakeup = timestamp_to_timespec(deadline);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeup, NULL) == EINTR) {
+        // Retry after signal; the shutdown flag is checked by the caller
+    }
+
+    if (!report) return;
+
+    int64_t late_ns = get_current_time() - deadline;
+    double latency_us = late_ns > 0 ? (double)late_ns / NS_PER_US : 0.0;
+
+    record_latency(report, latency_us, period_ns);
+}
+
+// Merge one report's wakeup statistics into another
+void merge_realtime_report(realtime_report_t* into, const realtime_report_t* from) {
+    if (!into || !from || from->wakeup_count == 0) return;
+
+    into->wakeup_count += from->wakeup_count;
+    into->overrun_count += from->overrun_count;
+    into->sum_latency_us += from->sum_latency_us;
+    if (from->min_latency_us < into->min_latency_us) into->min_latency_us = from->min_latency_us;
+    if (from->max_latency_us > into->max_latency_us) into->max_latency_us = from->max_latency_us;
+
+    for (int i = 0; i < REALTIME_LATENCY_BUCKETS; i++) {
+        into->latency_buckets[i] += from->latency_buckets[i];
+    }
+}
+
+// Sleep until the next period and record the wakeup latency
+void wait_next_period(realtime_timer_t* timer, realtime_report_t* report) {
+    if (!timer) return;
+
+    wait_until_deadline(timer->next_deadline, timer->period_ns, report);
+
+    // Advance deadline; skip missed periods instead of bursting to catch up
+    timestamp_ns_t now = get_current_time();
+    timer->next_deadline += timer->period_ns;
+    if (now > timer->next_deadline) {
+        timer->next_deadline = now + timer->period_ns;
+    }
+}
+
+// Latency upper bound (us) below which the given fraction of wakeups fell
+static double latency_percentile(const realtime_report_t* report, double fraction) {
+    long target = (long)ceil(report->wakeup_count * fraction);
+    long seen = 0;
+
+    for (int i = 0; i < REALTIME_LATENCY_BUCKETS; i++) {
+        seen += report->latency_buckets[i];
+        if (seen >= target) {
+            return (double)(1L << i);
+        }
+    }
+
+    return report->max_latency_us;
+}
+
+// Print achieved real-time status and latency distribution
+void print_realtime_report(const realtime_report_t* report) {
+    if (!report) return;
+
+    printf("\n=== Real-Time Report ===\n");
+    printf("Memory locked: %s\n", report->memory_locked ? "yes" : "no");
+    printf("SCHED_FIFO: %s\n", report->priority_set ? "yes" : "no");
+    printf("CPU pinned: %s\n", report->cpu_pinned ? "yes" : "no");
+
+    if (report->wakeup_count == 0) {
+        printf("No wakeups recorded\n");
+        return;
+    }
+
+    printf("Wakeups: %ld (overruns: %ld)\n", report->wakeup_count, report->overrun_count);
+    printf("Wakeup latency: min %.1f us | avg %.1f us | max %.1f us\n",
+           report->min_latency_us,
+           report->sum_latency_us / report->wakeup_count,
+           report->max_latency_us);
+    printf("Wakeup latency: p50 < %.0f us | p99 < %.0f us | p99.9 < %.0f us\n",
+           latency_percentile(report, 0.50),
+           latency_percentile(report, 0.99),
+           latency_percentile(report, 0.999));
+}
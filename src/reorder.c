@@ -0,0 +1,194 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/reorder.h"
+#include "../include/metrics.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+static metrics_counter_t* late_samples_metric = NULL;
+static pthread_once_t reorder_metrics_once = PTHREAD_ONCE_INIT;
+
+static void register_reorder_metrics(void) {
+    late_samples_metric = register_counter("datalogger_reorder_late_total",
+                                           "Samples dropped because they arrived after the lateness window");
+}
+
+// Sample at a logical position of a stream (0 = oldest)
+static sensor_data_t* stream_at(const reorder_buffer_t* buffer, const reorder_stream_t* stream, int index) {
+    return &stream->samples[(stream->head + index) % buffer->capacity];
+}
+
+static int64_t stream_head_ns(const reorder_buffer_t* buffer, int stream) {
+    const reorder_stream_t* s = &buffer->streams[stream];
+    return stream_at(buffer, s, 0)->timestamp;
+}
+
+static void heap_swap(reorder_buffer_t* buffer, int a, int b) {
+    int stream = buffer->heap[a];
+    buffer->heap[a] = buffer->heap[b];
+    buffer->heap[b] = stream;
+    buffer->heap_position[buffer->heap[a]] = a;
+    buffer->heap_position[buffer->heap[b]] = b;
+}
+
+static void heap_sift_up(reorder_buffer_t* buffer, int index) {
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (stream_head_ns(buffer, buffer->heap[parent]) <= stream_head_ns(buffer, buffer->heap[index])) break;
+        heap_swap(buffer, parent, index);
+        index = parent;
+    }
+}
+
+static void heap_sift_down(reorder_buffer_t* buffer, int index) {
+    for (;;) {
+        int smallest = index;
+        int left = 2 * index + 1;
+        int right = left + 1;
+
+        if (left < buffer->heap_size &&
+            stream_head_ns(buffer, buffer->heap[left]) < stream_head_ns(buffer, buffer->heap[smallest])) {
+            smallest = left;
+        }
+        if (right < buffer->heap_size &&
+            stream_head_ns(buffer, buffer->heap[right]) < stream_head_ns(buffer, buffer->heap[smallest])) {
+            smallest = right;
+        }
+        if (smallest == index) break;
+
+        heap_swap(buffer, index, smallest);
+        index = smallest;
+    }
+}
+
+// Initialize for stream_count streams
+int init_reorder_buffer(reorder_buffer_t* buffer, int stream_count, int window_ms, int capacity) {
+    if (!buffer || stream_count <= 0 || stream_count > REORDER_MAX_STREAMS || window_ms < 0) return -1;
+
+    pthread_once(&reorder_metrics_once, register_reorder_metrics);
+
+    memset(buffer, 0, sizeof(*buffer));
+    buffer->stream_count = stream_count;
+    buffer->capacity = capacity > 0 ? capacity : REORDER_DEFAULT_CAPACITY;
+    buffer->window_ns = (int64_t)window_ms * 1000000LL;
+
+    for (int i = 0; i < stream_count; i++) {
+        buffer->streams[i].samples = calloc(buffer->capacity, sizeof(sensor_data_t));
+        buffer->heap_position[i] = -1;
+        if (!buffer->streams[i].samples) {
+            cleanup_reorder_buffer(buffer);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+// Queue a sample from one stream, keeping the stream sorted
+int push_reorder_sample(reorder_buffer_t* buffer, int stream, const sensor_data_t* sample) {
+    if (!buffer || !sample || stream < 0 || stream >= buffer->stream_count) return -1;
+
+    reorder_stream_t* s = &buffer->streams[stream];
+    int64_t time_ns = sample->timestamp;
+    s->received++;
+
+    if (buffer->has_emitted && time_ns < buffer->last_emitted_ns) {
+        s->late++;
+        buffer->late++;
+        counter_add(late_samples_metric, 1);
+        return 1;
+    }
+
+    // Full streams are drained by pop_reorder_sample before the next push
+    if (s->count == buffer->capacity) return -1;
+
+    // Devices normally deliver in order, so this is an append; otherwise shift into place
+    int position = s->count;
+    while (position > 0 && stream_at(buffer, s, position - 1)->timestamp > time_ns) {
+        *stream_at(buffer, s, position) = *stream_at(buffer, s, position - 1);
+        position--;
+    }
+    *stream_at(buffer, s, position) = *sample;
+    s->count++;
+
+    if (time_ns > buffer->newest_ns) {
+        buffer->newest_ns = time_ns;
+    }
+
+    if (buffer->heap_position[stream] < 0) {
+        buffer->heap[buffer->heap_size] = stream;
+        buffer->heap_position[stream] = buffer->heap_size;
+        heap_sift_up(buffer, buffer->heap_size++);
+    } else if (position == 0) {
+        heap_sift_up(buffer, buffer->heap_position[stream]);
+    }
+
+    return 0;
+}
+
+// Oldest pending sample may be emitted without breaking timestamp order
+static int head_is_ready(const reorder_buffer_t* buffer) {
+    if (buffer->heap_size == buffer->stream_count) return 1;
+
+    for (int i = 0; i < buffer->heap_size; i++) {
+        if (buffer->streams[buffer->heap[i]].count == buffer->capacity) return 1;
+    }
+
+    return stream_head_ns(buffer, buffer->heap[0]) <= buffer->newest_ns - buffer->window_ns;
+}
+
+// Take the next sample in timestamp order if it is ready
+int pop_reorder_sample(reorder_buffer_t* buffer, sensor_data_t* out, int force) {
+    if (!buffer || !out || buffer->heap_size == 0) return 0;
+    if (!force && !head_is_ready(buffer)) return 0;
+
+    int stream = buffer->heap[0];
+    reorder_stream_t* s = &buffer->streams[stream];
+
+    *out = *stream_at(buffer, s, 0);
+    s->head = (s->head + 1) % buffer->capacity;
+    s->count--;
+
+    buffer->last_emitted_ns = out->timestamp;
+    buffer->has_emitted = 1;
+    buffer->emitted++;
+
+    if (s->count > 0) {
+        heap_sift_down(buffer, 0);
+    } else {
+        buffer->heap_position[stream] = -1;
+        buffer->heap_size--;
+        if (buffer->heap_size > 0) {
+            buffer->heap[0] = buffer->heap[buffer->heap_size];
+            buffer->heap_position[buffer->heap[0]] = 0;
+            heap_sift_down(buffer, 0);
+        }
+    }
+
+    return 1;
+}
+
+// Samples waiting in the buffer
+int reorder_pending(const reorder_buffer_t* buffer) {
+    if (!buffer) return 0;
+
+    int pending = 0;
+    for (int i = 0; i < buffer->stream_count; i++) {
+        pending += buffer->streams[i].count;
+    }
+    return pending;
+}
+
+// Free stream buffers
+void cleanup_reorder_buffer(reorder_buffer_t* buffer) {
+    if (!buffer) return;
+
+    for (int i = 0; i < REORDER_MAX_STREAMS; i++) {
+        free(buffer->streams[i].samples);
+        buffer->streams[i].samples = NULL;
+        buffer->streams[i].count = 0;
+    }
+    buffer->heap_size = 0;
+}
@@ -0,0 +1,142 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/sample_batch.h"
+#include "../include/metrics.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+// Pool metrics (shared by all pools in the process)
+static metrics_gauge_t* batches_in_use_metric;
+static metrics_counter_t* pool_exhausted_metric;
+static pthread_once_t batch_metrics_once = PTHREAD_ONCE_INIT;
+
+static void register_batch_metrics(void) {
+    batches_in_use_metric = register_gauge("datalogger_sample_batches_in_use",
+                                           "Pooled sample batches referenced by pipeline stages");
+    pool_exhausted_metric = register_counter("datalogger_sample_batch_pool_exhausted_total",
+                                             "Batch requests that found the pool empty");
+}
+
+// Push a batch onto the free list
+static void push_free_batch(sample_batch_pool_t* pool, sample_batch_t* batch) {
+    uint32_t link = (uint32_t)(batch - pool->batches) + 1;
+    uint64_t head = atomic_load_explicit(&pool->free_head, memory_order_relaxed);
+    uint64_t next;
+
+    do {
+        atomic_store_explicit(&batch->next_free, (uint32_t)head, memory_order_relaxed);
+        next = ((head >> 32) + 1) << 32 | link;
+    } while (!atomic_compare_exchange_weak_explicit(&pool->free_head, &head, next,
+                                                    memory_order_release, memory_order_relaxed));
+}
+
+// Allocate batch_count batches, all free
+int init_sample_batch_pool(sample_batch_pool_t* pool, int batch_count) {
+    if (!pool || batch_count <= 0) return -1;
+
+    pthread_once(&batch_metrics_once, register_batch_metrics);
+
+    pool->batches = calloc((size_t)batch_count, sizeof(sample_batch_t));
+    if (!pool->batches) {
+        fprintf(stderr, "Error: Cannot allocate %d sample batches\n", batch_count);
+        return -1;
+    }
+
+    pool->batch_count = batch_count;
+    atomic_init(&pool->free_head, 0);
+    atomic_init(&pool->in_use, 0);
+    atomic_init(&pool->peak_in_use, 0);
+    atomic_init(&pool->exhausted, 0);
+
+    for (int i = batch_count - 1; i >= 0; i--) {
+        pool->batches[i].pool = pool;
+        atomic_init(&pool->batches[i].references, 0);
+        push_free_batch(pool, &pool->batches[i]);
+    }
+
+    return 0;
+}
+
+// Take a free batch with one reference
+sample_batch_t* acquire_sample_batch(sample_batch_pool_t* pool) {
+    if (!pool || !pool->batches) return NULL;
+
+    uint64_t head = atomic_load_explicit(&pool->free_head, memory_order_acquire);
+    sample_batch_t* batch;
+
+    do {
+        uint32_t link = (uint32_t)head;
+        if (link == 0) {
+            atomic_fetch_add_explicit(&pool->exhausted, 1, memory_order_relaxed);
+            counter_add(pool_exhausted_metric, 1);
+            return NULL;
+        }
+
+        // A stale next link is harmless: the generation makes the exchange fail
+        batch = &pool->batches[link - 1];
+        uint64_t next = ((head >> 32) + 1) << 32 |
+                        atomic_load_explicit(&batch->next_free, memory_order_relaxed);
+        if (atomic_compare_exchange_weak_explicit(&pool->free_head, &head, next,
+                                                  memory_order_acquire, memory_order_acquire)) {
+            break;
+        }
+    } while (1);
+
+    batch->count = 0;
+    atomic_store_explicit(&batch->references, 1, memory_order_relaxed);
+
+    long in_use = atomic_fetch_add_explicit(&pool->in_use, 1, memory_order_relaxed) + 1;
+    long peak = atomic_load_explicit(&pool->peak_in_use, memory_order_relaxed);
+    while (in_use > peak &&
+           !atomic_compare_exchange_weak_explicit(&pool->peak_in_use, &peak, in_use,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+    gauge_add(batches_in_use_metric, 1);
+
+    return batch;
+}
+
+// Add a reference
+void retain_sample_batch(sample_batch_t* batch) {
+    if (!batch) return;
+    atomic_fetch_add_explicit(&batch->references, 1, memory_order_relaxed);
+}
+
+// Drop a reference; the last one returns the batch to its pool
+void release_sample_batch(sample_batch_t* batch) {
+    if (!batch) return;
+
+    // Release orders this stage's reads before the batch can be refilled
+    if (atomic_fetch_sub_explicit(&batch->references, 1, memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    sample_batch_pool_t* pool = batch->pool;
+    atomic_fetch_sub_explicit(&pool->in_use, 1, memory_order_relaxed);
+    gauge_add(batches_in_use_metric, -1);
+    push_free_batch(pool, batch);
+}
+
+// Print batches in use, peak and exhaustion
+void print_sample_batch_report(const sample_batch_pool_t* pool) {
+    if (!pool || !pool->batches) return;
+
+    printf("Sample batches: %d pooled (%zu bytes each), peak in use %ld, pool empty %ld time(s)\n",
+           pool->batch_count, sizeof(sample_batch_t),
+           atomic_load(&pool->peak_in_use), atomic_load(&pool->exhausted));
+}
+
+// Free the batches
+void cleanup_sample_batch_pool(sample_batch_pool_t* pool) {
+    if (!pool) return;
+
+    long in_use = atomic_load(&pool->in_use);
+    if (in_use != 0) {
+        fprintf(stderr, "Warning: %ld sample batch(es) still referenced at cleanup\n", in_use);
+    }
+
+    free(pool->batches);
+    pool->batches = NULL;
+    pool->batch_count = 0;
+}
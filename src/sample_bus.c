@@ -0,0 +1,152 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/sample_bus.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Map the bus /dev/shm/<name> read-only
+int open_sample_bus(sample_bus_reader_t* reader, const char* name, int from_oldest) {
+    if (!reader || !name) return -1;
+
+    memset(reader, 0, sizeof(*reader));
+    reader->fd = -1;
+
+    char path[128];
+    snprintf(path, sizeof(path), "/%s", name);
+
+    reader->fd = shm_open(path, O_RDONLY, 0);
+    if (reader->fd < 0) {
+        fprintf(stderr, "Error: Cannot open sample bus '%s'\n", name);
+        return -1;
+    }
+
+    struct stat info;
+    if (fstat(reader->fd, &info) != 0 || (size_t)info.st_size < sizeof(sample_bus_header_t)) {
+        fprintf(stderr, "Error: Sample bus '%s' is not initialized\n", name);
+        close_sample_bus(reader);
+        return -1;
+    }
+
+    reader->map_size = (size_t)info.st_size;
+    reader->map = mmap(NULL, reader->map_size, PROT_READ, MAP_SHARED, reader->fd, 0);
+    if (reader->map == MAP_FAILED) {
+        reader->map = NULL;
+        fprintf(stderr, "Error: Cannot map sample bus '%s'\n", name);
+        close_sample_bus(reader);
+        return -1;
+    }
+
+    const sample_bus_header_t* header = reader->map;
+    uint32_t slot_count = header->slot_count;
+    if (header->magic != SAMPLE_BUS_MAGIC || header->version != SAMPLE_BUS_VERSION ||
+        header->slot_size != sizeof(bus_slot_t) || slot_count == 0 ||
+        (slot_count & (slot_count - 1)) != 0 ||
+        header->slots_offset + (uint64_t)slot_count * sizeof(bus_slot_t) > reader->map_size) {
+        fprintf(stderr, "Error: Sample bus '%s' has an incompatible layout\n", name);
+        close_sample_bus(reader);
+        return -1;
+    }
+
+    reader->header = header;
+    reader->slots = (const bus_slot_t*)((const char*)reader->map + header->slots_offset);
+    reader->mask = slot_count - 1;
+
+    uint64_t written = atomic_load_explicit(&header->write_sequence, memory_order_acquire);
+    if (from_oldest) {
+        reader->next_sequence = written > slot_count ? written - slot_count : 0;
+    } else {
+        reader->next_sequence = written;
+    }
+
+    return 0;
+}
+
+// Copy new samples; torn and overwritten slots are detected by their sequence
+int read_sample_bus(sample_bus_reader_t* reader, bus_sample_t* samples, int max_samples) {
+    if (!reader || !reader->header || !samples || max_samples <= 0) return 0;
+
+    const sample_bus_header_t* header = reader->header;
+    int count = 0;
+
+    while (count < max_samples) {
+        uint64_t next = reader->next_sequence;
+        const bus_slot_t* slot = &reader->slots[next & reader->mask];
+        uint64_t expected = 2 * next + 2;
+
+        uint64_t before = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        if (before < expected) break;  // Not published yet (or still being written)
+
+        if (before == expected) {
+            bus_sample_t copy = slot->sample;
+            atomic_thread_fence(memory_order_acquire);
+            uint64_t after = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+            if (after == expected) {
+                samples[count++] = copy;
+                reader->next_sequence = next + 1;
+                continue;
+            }
+        }
+
+        // The publisher lapped this reader: resume at the oldest sample still in the ring
+        uint64_t written = atomic_load_explicit(&header->write_sequence, memory_order_acquire);
+        uint64_t oldest = written > header->slot_count ? written - header->slot_count : 0;
+        if (oldest <= next) oldest = next + 1;
+        reader->lost += oldest - next;
+        reader->next_sequence = oldest;
+    }
+
+    if (count == 0 && atomic_load_explicit(&header->closed, memory_order_acquire) &&
+        reader->next_sequence >= atomic_load_explicit(&header->write_sequence, memory_order_acquire)) {
+        return -1;
+    }
+
+    return count;
+}
+
+// Poll until a new sample is available
+int wait_sample_bus(sample_bus_reader_t* reader, int timeout_ms) {
+    if (!reader || !reader->header) return 0;
+
+    // Short sleeps keep wakeup latency in the tens of microseconds without spinning a core
+    struct timespec pause = {0, 50000L};
+    long polls = timeout_ms > 0 ? (long)timeout_ms * 20 : 1;
+
+    for (long i = 0; i < polls; i++) {
+        uint64_t written = atomic_load_explicit(&reader->header->write_sequence, memory_order_acquire);
+        if (written > reader->next_sequence) return 1;
+        if (atomic_load_explicit(&reader->header->closed, memory_order_acquire)) return 0;
+        nanosleep(&pause, NULL);
+    }
+
+    return 0;
+}
+
+// Name registered by the publisher for a source index
+const char* sample_bus_source_name(const sample_bus_reader_t* reader, int source) {
+    if (!reader || !reader->header || source < 0 || source >= SAMPLE_BUS_MAX_SOURCES) return "";
+    if ((uint32_t)source >= atomic_load_explicit(&reader->header->source_count, memory_order_acquire)) return "";
+
+    return reader->header->source_names[source];
+}
+
+// Unmap the bus
+void close_sample_bus(sample_bus_reader_t* reader) {
+    if (!reader) return;
+
+    if (reader->map) {
+        munmap(reader->map, reader->map_size);
+    }
+    if (reader->fd >= 0) {
+        close(reader->fd);
+    }
+
+    reader->map = NULL;
+    reader->header = NULL;
+    reader->slots = NULL;
+    reader->fd = -1;
+}
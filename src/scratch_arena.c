@@ -0,0 +1,114 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/scratch_arena.h"
+#include <stdlib.h>
+
+// Heap block for a request the arena could not hold; the data follows the header
+struct scratch_overflow {
+    struct scratch_overflow* next;
+    size_t size;
+};
+
+#define SCRATCH_HEADER_SIZE \
+    ((sizeof(struct scratch_overflow) + SCRATCH_ALIGNMENT - 1) & ~(size_t)(SCRATCH_ALIGNMENT - 1))
+
+static size_t align_up(size_t size) {
+    return (size + SCRATCH_ALIGNMENT - 1) & ~(size_t)(SCRATCH_ALIGNMENT - 1);
+}
+
+// Allocate the initial block
+int init_scratch_arena(scratch_arena_t* arena, size_t capacity) {
+    if (!arena) return -1;
+
+    arena->base = NULL;
+    arena->capacity = 0;
+    arena->used = 0;
+    arena->overflow = NULL;
+    arena->overflow_bytes = 0;
+    arena->peak = 0;
+    arena->heap_allocations = 0;
+
+    if (capacity > 0) {
+        arena->base = malloc(align_up(capacity));
+        if (!arena->base) return -1;
+        arena->capacity = align_up(capacity);
+        arena->heap_allocations++;
+    }
+
+    return 0;
+}
+
+// Aligned allocation from the block, or an overflow block when it is full
+void* scratch_alloc(scratch_arena_t* arena, size_t size) {
+    if (!arena) return NULL;
+
+    size = align_up(size > 0 ? size : 1);
+
+    void* memory;
+    if (arena->base && arena->capacity - arena->used >= size) {
+        memory = arena->base + arena->used;
+        arena->used += size;
+    } else {
+        struct scratch_overflow* block = malloc(SCRATCH_HEADER_SIZE + size);
+        if (!block) return NULL;
+
+        block->next = arena->overflow;
+        block->size = size;
+        arena->overflow = block;
+        arena->overflow_bytes += size;
+        arena->heap_allocations++;
+        memory = (unsigned char*)block + SCRATCH_HEADER_SIZE;
+    }
+
+    if (arena->used + arena->overflow_bytes > arena->peak) {
+        arena->peak = arena->used + arena->overflow_bytes;
+    }
+    return memory;
+}
+
+// Current position
+scratch_mark_t mark_scratch_arena(const scratch_arena_t* arena) {
+    scratch_mark_t mark = { 0, NULL };
+    if (arena) {
+        mark.used = arena->used;
+        mark.overflow = arena->overflow;
+    }
+    return mark;
+}
+
+// Free everything allocated since the mark; grow the block once the arena is empty
+void release_scratch_arena(scratch_arena_t* arena, scratch_mark_t mark) {
+    if (!arena) return;
+
+    while (arena->overflow && arena->overflow != mark.overflow) {
+        struct scratch_overflow* block = arena->overflow;
+        arena->overflow = block->next;
+        arena->overflow_bytes -= block->size;
+        free(block);
+    }
+    arena->used = mark.used;
+
+    if (arena->used == 0 && !arena->overflow && arena->peak > arena->capacity) {
+        free(arena->base);
+        arena->base = malloc(arena->peak);
+        arena->capacity = arena->base ? arena->peak : 0;
+        arena->heap_allocations++;
+    }
+}
+
+// Free everything
+void reset_scratch_arena(scratch_arena_t* arena) {
+    scratch_mark_t start = { 0, NULL };
+    release_scratch_arena(arena, start);
+}
+
+// Free the block and any overflow
+void cleanup_scratch_arena(scratch_arena_t* arena) {
+    if (!arena) return;
+
+    arena->peak = 0;     // Nothing to grow for
+    reset_scratch_arena(arena);
+    free(arena->base);
+    arena->base = NULL;
+    arena->capacity = 0;
+}
@@ -103,6 +103,11 @@ static double generate_anomaly(const sensor_config_t* config) {
 
 // Generate simulated sensor data
 sensor_data_t generate_sensor_data(sensor_type_t type) {
+    return generate_sensor_data_at(type, get_current_time());
+}
+
+// Generate simulated sensor data with a batch timestamp
+sensor_data_t generate_sensor_data_at(sensor_type_t type, timestamp_ns_t timestamp) {
     sensor_data_t data;
     
     if (!simulator_initialized) {
@@ -113,7 +118,7 @@ sensor_data_t generate_sensor_data(sensor_type_t type) {
         // Return invalid data
         data.type = type;
         data.value = 0.0;
-        data.timestamp = get_current_time();
+        data.timestamp = timestamp;
         strcpy(data.unit, "N/A");
         strcpy(data.description, "Invalid sensor type");
         return data;
@@ -121,8 +126,7 @@ sensor_data_t generate_sensor_data(sensor_type_t type) {
     
     const sensor_config_t* config = &sensor_configs[type];
     
-    // Get current time for calculations
-    data.timestamp = get_current_time();
+    data.timestamp = timestamp;
     double time_offset = (double)simulation_step * 0.1;  // Assume 100ms intervals
     
     // Calculate base value with trend
@@ -198,9 +202,11 @@ sensor_data_t generate_bridge_vibration_data(void) {
 void generate_environmental_data_set(sensor_data_t* data_array, int* count) {
     if (!data_array || !count) return;
     
-    data_array[0] = generate_sensor_data(SENSOR_TEMPERATURE);
-    data_array[1] = generate_sensor_data(SENSOR_HUMIDITY);
-    data_array[2] = generate_sensor_data(SENSOR_PRESSURE);
+    // One clock read for the set: the three channels are sampled together
+    timestamp_ns_t now = get_current_time();
+    data_array[0] = generate_sensor_data_at(SENSOR_TEMPERATURE, now);
+    data_array[1] = generate_sensor_data_at(SENSOR_HUMIDITY, now);
+    data_array[2] = generate_sensor_data_at(SENSOR_PRESSURE, now);
     
     *count = 3;
     
@@ -215,6 +221,25 @@ void generate_environmental_data_set(sensor_data_t* data_array, int* count) {
     data_array[1].value = clamp(data_array[1].value, 0.0, 100.0);
 }
 
+// Protocol names for each sensor type (shared by hardware parser and config files)
+static const char* sensor_type_names[] = {
+    "TEMP", "VIB", "STRAIN", "HUM", "PRESS", "ACCEL_X", "ACCEL_Y", "ACCEL_Z"
+};
+
+// Look up sensor type by protocol name
+int sensor_type_from_name(const char* name, sensor_type_t* type) {
+    if (!name || !type) return -1;
+    
+    for (int i = 0; i < 8; i++) {
+        if (strcmp(name, sensor_type_names[i]) == 0) {
+            *type = (sensor_type_t)i;
+            return 0;
+        }
+    }
+    
+    return -1;
+}
+
 // Cleanup simulator resources
 void cleanup_sensor_simulator(void) {
     if (simulator_initialized) {
@@ -0,0 +1,380 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/stage_probes.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define PROBES_HAVE_TSC 1
+#endif
+
+// Histogram: 4 linear buckets below 4 ticks, then 4 sub-buckets per power of two
+#define PROBE_BUCKETS 256
+
+// Per-stage histogram
+typedef struct {
+    atomic_long buckets[PROBE_BUCKETS];
+    _Atomic uint64_t sum_ticks;
+    _Atomic uint64_t min_ticks;
+    _Atomic uint64_t max_ticks;
+} stage_histogram_t;
+
+static stage_histogram_t stage_histograms[STAGE_COUNT];
+static int use_tsc = 0;
+static double ns_per_tick = 1.0;
+static pthread_once_t clock_once = PTHREAD_ONCE_INIT;
+
+// Hardware counter totals per stage
+static atomic_int perf_enabled = 0;
+static _Atomic uint64_t stage_perf_sums[STAGE_COUNT][PERF_COUNTER_COUNT];
+static atomic_long stage_perf_counts[STAGE_COUNT][PERF_COUNTER_COUNT];
+
+// Counters are per thread and opened on the first probe in each thread
+// (0 = not yet opened, 1 = open, -1 = unavailable)
+static __thread perf_counters_t thread_counters;
+static __thread int thread_counters_state = 0;
+
+static const char* stage_names[STAGE_COUNT] = {
+    "acquisition",
+    "parse",
+    "update_statistics",
+    "detect_anomaly",
+    "log_sensor_data",
+    "flush_logger_buffer",
+    "write_logger_records"
+};
+
+// Monotonic clock in nanoseconds
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+#ifdef PROBES_HAVE_TSC
+// The TSC is only usable across cores and frequency changes when invariant
+static int has_invariant_tsc(void) {
+    unsigned int eax, ebx, ecx, edx;
+
+    if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007) {
+        return 0;
+    }
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+        return 0;
+    }
+
+    return (edx & (1u << 8)) != 0;
+}
+
+// Measure TSC frequency against CLOCK_MONOTONIC
+static double calibrate_tsc(void) {
+    struct timespec pause = {0, 20000000L};  // 20 ms
+
+    uint64_t start_ns = monotonic_ns();
+    uint64_t start_ticks = __rdtsc();
+    nanosleep(&pause, NULL);
+    uint64_t end_ticks = __rdtsc();
+    uint64_t end_ns = monotonic_ns();
+
+    if (end_ticks <= start_ticks) return 0.0;
+    return (double)(end_ns - start_ns) / (double)(end_ticks - start_ticks);
+}
+#endif
+
+// Select the clock and calibrate the TSC
+static void calibrate_probe_clock(void) {
+    use_tsc = 0;
+    ns_per_tick = 1.0;
+
+#ifdef PROBES_HAVE_TSC
+    if (has_invariant_tsc()) {
+        double calibrated = calibrate_tsc();
+        if (calibrated > 0.0) {
+            ns_per_tick = calibrated;
+            use_tsc = 1;
+        }
+    }
+#endif
+}
+
+// Calibrate the tick clock once per process
+void init_probe_clock(void) {
+    pthread_once(&clock_once, calibrate_probe_clock);
+}
+
+// Calibrate the clock and clear all recorded latencies
+void init_stage_probes(void) {
+    init_probe_clock();
+    reset_stage_probes();
+}
+
+// Name of the clock source in use
+const char* probe_clock_source(void) {
+    return use_tsc ? "tsc" : "clock_monotonic";
+}
+
+// Current tick count
+uint64_t probe_ticks(void) {
+#ifdef PROBES_HAVE_TSC
+    if (use_tsc) return __rdtsc();
+#endif
+    return monotonic_ns();
+}
+
+// Convert ticks to nanoseconds
+double probe_ticks_to_ns(uint64_t ticks) {
+    return (double)ticks * ns_per_tick;
+}
+
+// Histogram bucket for a tick count
+static int bucket_index(uint64_t ticks) {
+    if (ticks < 4) return (int)ticks;
+
+    int msb = 63 - __builtin_clzll(ticks);
+    int sub = (int)((ticks >> (msb - 2)) & 3);
+    return 4 + (msb - 2) * 4 + sub;
+}
+
+// Midpoint of a bucket in ticks
+static double bucket_midpoint(int index) {
+    if (index < 4) return (double)index;
+
+    int msb = (index - 4) / 4 + 2;
+    int sub = (index - 4) % 4;
+    double lower = (double)(4 + sub) * (double)(1ULL << (msb - 2));
+    double width = (double)(1ULL << (msb - 2));
+    return lower + width / 2.0;
+}
+
+// Record a duration in ticks for a stage
+void probe_record(probe_stage_t stage, uint64_t ticks) {
+    if (stage < 0 || stage >= STAGE_COUNT) return;
+
+    stage_histogram_t* histogram = &stage_histograms[stage];
+    atomic_fetch_add_explicit(&histogram->buckets[bucket_index(ticks)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->sum_ticks, ticks, memory_order_relaxed);
+
+    uint64_t current = atomic_load_explicit(&histogram->min_ticks, memory_order_relaxed);
+    while (ticks < current &&
+           !atomic_compare_exchange_weak_explicit(&histogram->min_ticks, &current, ticks,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+
+    current = atomic_load_explicit(&histogram->max_ticks, memory_order_relaxed);
+    while (ticks > current &&
+           !atomic_compare_exchange_weak_explicit(&histogram->max_ticks, &current, ticks,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+// Counter group of the calling thread, or NULL when unavailable
+static perf_counters_t* current_thread_counters(void) {
+    if (thread_counters_state == 0) {
+        if (open_perf_counters(&thread_counters) > 0) {
+            start_perf_counters(&thread_counters);
+            thread_counters_state = 1;
+        } else {
+            thread_counters_state = -1;
+        }
+    }
+    return thread_counters_state > 0 ? &thread_counters : NULL;
+}
+
+// Mark the start of a measured interval
+void probe_begin(probe_point_t* point) {
+    // Counters are read outside the timed region so the syscall is not attributed to the stage
+    if (atomic_load_explicit(&perf_enabled, memory_order_relaxed)) {
+        perf_counters_t* counters = current_thread_counters();
+        if (!counters || read_perf_counters(counters, &point->counters) != 0) {
+            memset(&point->counters, 0, sizeof(point->counters));
+        }
+    }
+    point->ticks = probe_ticks();
+}
+
+// Mark the end of a measured interval and record it
+void probe_end(probe_stage_t stage, const probe_point_t* point) {
+    probe_record(stage, probe_ticks() - point->ticks);
+
+    if (!atomic_load_explicit(&perf_enabled, memory_order_relaxed) || stage < 0 || stage >= STAGE_COUNT) {
+        return;
+    }
+
+    perf_reading_t now;
+    perf_counters_t* counters = current_thread_counters();
+    if (!counters || read_perf_counters(counters, &now) != 0) return;
+
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+        if (!point->counters.valid[c] || !now.valid[c]) continue;
+        atomic_fetch_add_explicit(&stage_perf_sums[stage][c], now.values[c] - point->counters.values[c],
+                                  memory_order_relaxed);
+        atomic_fetch_add_explicit(&stage_perf_counts[stage][c], 1, memory_order_relaxed);
+    }
+}
+
+// Also collect hardware counters per stage
+int enable_stage_perf_counters(void) {
+    if (!current_thread_counters()) return -1;
+
+    atomic_store(&perf_enabled, 1);
+    return 0;
+}
+
+// Hardware counter summary for a stage
+int get_stage_counters(probe_stage_t stage, stage_counters_t* counters) {
+    if (stage < 0 || stage >= STAGE_COUNT || !counters) return -1;
+
+    memset(counters, 0, sizeof(*counters));
+    double totals[PERF_COUNTER_COUNT] = {0};
+
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+        long count = atomic_load_explicit(&stage_perf_counts[stage][c], memory_order_relaxed);
+        if (count == 0) continue;
+
+        totals[c] = (double)atomic_load_explicit(&stage_perf_sums[stage][c], memory_order_relaxed);
+        counters->per_call[c] = totals[c] / (double)count;
+        counters->valid[c] = 1;
+        if (count > counters->count) counters->count = count;
+    }
+
+    if (counters->count == 0) return -1;
+
+    if (counters->valid[PERF_COUNTER_CYCLES] && counters->valid[PERF_COUNTER_INSTRUCTIONS] &&
+        totals[PERF_COUNTER_CYCLES] > 0.0) {
+        counters->ipc = totals[PERF_COUNTER_INSTRUCTIONS] / totals[PERF_COUNTER_CYCLES];
+    }
+
+    return 0;
+}
+
+// Stage name for reports
+const char* probe_stage_name(probe_stage_t stage) {
+    if (stage < 0 || stage >= STAGE_COUNT) return "unknown";
+    return stage_names[stage];
+}
+
+// Percentile from a bucket snapshot
+static double bucket_percentile(const long* buckets, long count, double fraction) {
+    long target = (long)(fraction * (double)count);
+    if (target >= count) target = count - 1;
+
+    long seen = 0;
+    for (int i = 0; i < PROBE_BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen > target) {
+            return probe_ticks_to_ns((uint64_t)bucket_midpoint(i));
+        }
+    }
+
+    return 0.0;
+}
+
+// Latency summary for a stage
+int get_stage_latency(probe_stage_t stage, stage_latency_t* latency) {
+    if (stage < 0 || stage >= STAGE_COUNT || !latency) return -1;
+
+    stage_histogram_t* histogram = &stage_histograms[stage];
+    long buckets[PROBE_BUCKETS];
+    long count = 0;
+
+    for (int i = 0; i < PROBE_BUCKETS; i++) {
+        buckets[i] = atomic_load_explicit(&histogram->buckets[i], memory_order_relaxed);
+        count += buckets[i];
+    }
+
+    memset(latency, 0, sizeof(*latency));
+    if (count == 0) return -1;
+
+    uint64_t sum = atomic_load_explicit(&histogram->sum_ticks, memory_order_relaxed);
+
+    latency->count = count;
+    latency->min_ns = probe_ticks_to_ns(atomic_load_explicit(&histogram->min_ticks, memory_order_relaxed));
+    latency->max_ns = probe_ticks_to_ns(atomic_load_explicit(&histogram->max_ticks, memory_order_relaxed));
+    latency->mean_ns = probe_ticks_to_ns(sum) / (double)count;
+    latency->p50_ns = bucket_percentile(buckets, count, 0.50);
+    latency->p90_ns = bucket_percentile(buckets, count, 0.90);
+    latency->p99_ns = bucket_percentile(buckets, count, 0.99);
+    latency->p999_ns = bucket_percentile(buckets, count, 0.999);
+
+    // Bucket midpoints can fall outside the observed range
+    double* percentiles[] = {&latency->p50_ns, &latency->p90_ns, &latency->p99_ns, &latency->p999_ns};
+    for (int i = 0; i < 4; i++) {
+        if (*percentiles[i] < latency->min_ns) *percentiles[i] = latency->min_ns;
+        if (*percentiles[i] > latency->max_ns) *percentiles[i] = latency->max_ns;
+    }
+
+    return 0;
+}
+
+// Clear all recorded latencies
+void reset_stage_probes(void) {
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        stage_histogram_t* histogram = &stage_histograms[s];
+        for (int i = 0; i < PROBE_BUCKETS; i++) {
+            atomic_store(&histogram->buckets[i], 0);
+        }
+        atomic_store(&histogram->sum_ticks, 0);
+        atomic_store(&histogram->min_ticks, UINT64_MAX);
+        atomic_store(&histogram->max_ticks, 0);
+
+        for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+            atomic_store(&stage_perf_sums[s][c], 0);
+            atomic_store(&stage_perf_counts[s][c], 0);
+        }
+    }
+}
+
+// Print per-stage latency table
+void print_stage_latency_table(void) {
+    printf("\n=== Stage Latency (ns, clock: %s", probe_clock_source());
+    if (use_tsc) {
+        printf(", %.3f GHz", 1.0 / ns_per_tick);
+    }
+    printf(") ===\n");
+
+    printf("%-22s %10s %9s %9s %9s %9s %9s %10s\n",
+           "Stage", "Count", "Min", "Mean", "P50", "P99", "P99.9", "Max");
+
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        stage_latency_t latency;
+        if (get_stage_latency((probe_stage_t)s, &latency) != 0) continue;
+
+        printf("%-22s %10ld %9.0f %9.0f %9.0f %9.0f %9.0f %10.0f\n",
+               probe_stage_name((probe_stage_t)s), latency.count,
+               latency.min_ns, latency.mean_ns, latency.p50_ns,
+               latency.p99_ns, latency.p999_ns, latency.max_ns);
+    }
+
+    if (!atomic_load(&perf_enabled)) return;
+
+    printf("\n=== Stage Hardware Counters (per call, user space) ===\n");
+    printf("%-22s %12s %12s %6s %12s %12s\n",
+           "Stage", "Cycles", "Instructions", "IPC", "Cache miss", "Branch miss");
+
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        stage_counters_t counters;
+        if (get_stage_counters((probe_stage_t)s, &counters) != 0) continue;
+
+        printf("%-22s", probe_stage_name((probe_stage_t)s));
+        for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+            if (c == PERF_COUNTER_CACHE_MISSES) {
+                if (counters.ipc > 0.0) {
+                    printf(" %6.2f", counters.ipc);
+                } else {
+                    printf(" %6s", "-");
+                }
+            }
+            if (counters.valid[c]) {
+                printf(" %12.1f", counters.per_call[c]);
+            } else {
+                printf(" %12s", "-");
+            }
+        }
+        printf("\n");
+    }
+}
@@ -0,0 +1,215 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/status_renderer.h"
+#include "../include/realtime.h"
+#include "../include/trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+
+// Store a double in an atomic 64-bit slot
+static void store_double(_Atomic uint64_t* slot, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    atomic_store_explicit(slot, bits, memory_order_relaxed);
+}
+
+// Load a double from an atomic 64-bit slot
+static double load_double(_Atomic uint64_t* slot) {
+    uint64_t bits = atomic_load_explicit(slot, memory_order_relaxed);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Initialize renderer (refresh_hz <= 0 uses the default)
+void init_status_renderer(status_renderer_t* renderer, int refresh_hz) {
+    if (!renderer) return;
+
+    memset(renderer, 0, sizeof(*renderer));
+    renderer->refresh_hz = refresh_hz > 0 ? refresh_hz : STATUS_DEFAULT_REFRESH_HZ;
+
+    atomic_init(&renderer->sample_count, 0);
+    atomic_init(&renderer->anomaly_count, 0);
+    atomic_init(&renderer->dropped_anomalies, 0);
+    atomic_init(&renderer->anomaly_head, 0);
+    atomic_init(&renderer->anomaly_tail, 0);
+    atomic_init(&renderer->running, 0);
+}
+
+// Print only queued anomalies, each prefixed
+void set_status_headless(status_renderer_t* renderer, const char* prefix) {
+    if (!renderer) return;
+
+    renderer->headless = 1;
+    snprintf(renderer->prefix, sizeof(renderer->prefix), "%s", prefix ? prefix : "");
+}
+
+// Register a field shown on the status line
+int add_status_field(status_renderer_t* renderer, const char* label, const char* unit, int precision) {
+    if (!renderer || !label || renderer->field_count >= STATUS_MAX_FIELDS) return -1;
+
+    status_field_t* field = &renderer->fields[renderer->field_count];
+    strncpy(field->label, label, sizeof(field->label) - 1);
+    field->label[sizeof(field->label) - 1] = '\0';
+    strncpy(field->unit, unit ? unit : "", sizeof(field->unit) - 1);
+    field->unit[sizeof(field->unit) - 1] = '\0';
+    field->precision = precision;
+    store_double(&field->value_bits, 0.0);
+
+    return renderer->field_count++;
+}
+
+// Publish latest value for a field
+void set_status_field(status_renderer_t* renderer, int field, double value) {
+    if (!renderer || field < 0 || field >= renderer->field_count) return;
+    store_double(&renderer->fields[field].value_bits, value);
+}
+
+// Count a processed sample
+void count_status_sample(status_renderer_t* renderer) {
+    if (!renderer) return;
+    atomic_fetch_add_explicit(&renderer->sample_count, 1, memory_order_relaxed);
+}
+
+// Queue an anomaly for printing (drops when full)
+void post_status_anomaly(status_renderer_t* renderer, const anomaly_result_t* anomaly) {
+    if (!renderer || !anomaly) return;
+
+    atomic_fetch_add_explicit(&renderer->anomaly_count, 1, memory_order_relaxed);
+
+    unsigned int head = atomic_load_explicit(&renderer->anomaly_head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&renderer->anomaly_tail, memory_order_acquire);
+
+    if (head - tail >= STATUS_ANOMALY_QUEUE_SIZE) {
+        atomic_fetch_add_explicit(&renderer->dropped_anomalies, 1, memory_order_relaxed);
+        return;
+    }
+
+    renderer->anomaly_queue[head & (STATUS_ANOMALY_QUEUE_SIZE - 1)] = *anomaly;
+    atomic_store_explicit(&renderer->anomaly_head, head + 1, memory_order_release);
+}
+
+// Print queued anomalies, returns severity of the last one (0 if none)
+static double drain_anomalies(status_renderer_t* renderer) {
+    unsigned int tail = atomic_load_explicit(&renderer->anomaly_tail, memory_order_relaxed);
+    unsigned int head = atomic_load_explicit(&renderer->anomaly_head, memory_order_acquire);
+    double last_severity = 0.0;
+
+    if (tail != head && !renderer->headless) {
+        printf("\n");  // Keep the status line intact above the reports
+    }
+
+    while (tail != head) {
+        const anomaly_result_t* anomaly = &renderer->anomaly_queue[tail & (STATUS_ANOMALY_QUEUE_SIZE - 1)];
+        // Whole reports, even when other renderers print too
+        flockfile(stdout);
+        if (renderer->prefix[0] != '\0') printf("[%s] ", renderer->prefix);
+        print_anomaly_result(anomaly);
+        funlockfile(stdout);
+        last_severity = anomaly->severity;
+        tail++;
+        atomic_store_explicit(&renderer->anomaly_tail, tail, memory_order_release);
+    }
+
+    return last_severity;
+}
+
+// Render one status line from the current snapshot
+static void render_status(status_renderer_t* renderer) {
+    double last_severity = drain_anomalies(renderer);
+    if (renderer->headless) {
+        fflush(stdout);
+        return;
+    }
+
+    printf("\r[%ld]", atomic_load_explicit(&renderer->sample_count, memory_order_relaxed));
+
+    for (int i = 0; i < renderer->field_count; i++) {
+        const status_field_t* field = &renderer->fields[i];
+        printf("%s %s: %.*f%s", i == 0 ? "" : " |", field->label, field->precision,
+               load_double(&renderer->fields[i].value_bits), field->unit);
+    }
+
+    long anomalies = atomic_load_explicit(&renderer->anomaly_count, memory_order_relaxed);
+    if (anomalies > 0) {
+        printf(" | Anomalies: %ld", anomalies);
+    }
+    if (last_severity > 0.0) {
+        printf(" | ANOMALY! (%.1f)", last_severity);
+    }
+
+    printf("                    "); // Clear any remaining characters
+    fflush(stdout);
+}
+
+// Renderer thread main loop
+static void* status_renderer_thread(void* arg) {
+    status_renderer_t* renderer = arg;
+
+    trace_set_thread_name("status");
+
+    // Console output must never compete with a pinned acquisition thread
+    reset_current_thread_affinity();
+
+    long period_ns = 1000000000L / renderer->refresh_hz;
+    struct timespec period;
+    period.tv_sec = period_ns / 1000000000L;
+    period.tv_nsec = period_ns % 1000000000L;
+
+    while (atomic_load_explicit(&renderer->running, memory_order_relaxed)) {
+        trace_begin("render");
+        render_status(renderer);
+        trace_end("render");
+        nanosleep(&period, NULL);
+    }
+
+    // Final refresh so the last values and anomalies are shown
+    render_status(renderer);
+    if (!renderer->headless) printf("\n");
+
+    long dropped = atomic_load_explicit(&renderer->dropped_anomalies, memory_order_relaxed);
+    if (dropped > 0) {
+        if (renderer->prefix[0] != '\0') printf("[%s] ", renderer->prefix);
+        printf("Status: %ld anomaly reports dropped (queue full)\n", dropped);
+    }
+
+    return NULL;
+}
+
+// Start the renderer thread
+int start_status_renderer(status_renderer_t* renderer) {
+    if (!renderer || renderer->thread_started) return -1;
+
+    // Run at normal priority even when started from a SCHED_FIFO thread
+    pthread_attr_t attr;
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    pthread_attr_setschedparam(&attr, &param);
+
+    atomic_store(&renderer->running, 1);
+    int result = pthread_create(&renderer->thread, &attr, status_renderer_thread, renderer);
+    pthread_attr_destroy(&attr);
+
+    if (result != 0) {
+        fprintf(stderr, "Error: Cannot start status renderer: %s\n", strerror(result));
+        atomic_store(&renderer->running, 0);
+        return -1;
+    }
+
+    renderer->thread_started = 1;
+    return 0;
+}
+
+// Stop the renderer thread after a final refresh
+void stop_status_renderer(status_renderer_t* renderer) {
+    if (!renderer || !renderer->thread_started) return;
+
+    atomic_store(&renderer->running, 0);
+    pthread_join(renderer->thread, NULL);
+    renderer->thread_started = 0;
+}
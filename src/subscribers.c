@@ -0,0 +1,348 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/subscribers.h"
+#include "../include/metrics.h"
+#include "../include/realtime.h"
+#include "../include/trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <sched.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+// Queued sample with the time it was dispatched (for lag measurement)
+typedef struct {
+    sensor_data_t sample;
+    int64_t queued_ns;
+} queued_sample_t;
+
+// Registered subscriber and its bounded queue
+typedef struct {
+    subscriber_config_t config;
+    char name[32];
+    queued_sample_t* queue;
+    int head;                 // Oldest queued sample
+    int count;
+    sensor_data_t* batch;     // Delivery buffer, owned by the worker running the callback
+    int busy;
+
+    long delivered;
+    long dropped;
+    long batches;
+    double lag_total_ms;
+    double lag_max_ms;
+    double callback_total_us;
+    metrics_histogram_t* lag_metric;
+    metrics_counter_t* dropped_metric;
+} subscriber_t;
+
+static subscriber_t subscribers[SUBSCRIBERS_MAX];
+static atomic_int subscriber_count = 0;
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_ready = PTHREAD_COND_INITIALIZER;
+static pthread_t pool_threads[SUBSCRIBER_POOL_MAX_THREADS];
+static int pool_thread_count = 0;
+static int pool_running = 0;
+static int next_subscriber = 0;   // Round-robin start so no subscriber starves the others
+
+// Metric name fragment from a subscriber name
+static void metric_safe_name(const char* name, char* buffer, size_t buffer_size) {
+    size_t length = 0;
+    for (const char* p = name; *p && length + 1 < buffer_size; p++) {
+        buffer[length++] = isalnum((unsigned char)*p) ? (char)tolower((unsigned char)*p) : '_';
+    }
+    buffer[length] = '\0';
+}
+
+// Register a subscriber
+int subscribe_samples(const subscriber_config_t* config) {
+    if (!config || !config->name) return -1;
+
+    int capacity = config->queue_capacity > 0 ? config->queue_capacity : SUBSCRIBER_DEFAULT_QUEUE;
+    int batch_size = config->batch_size > 0 ? config->batch_size : SUBSCRIBER_DEFAULT_BATCH;
+    if (batch_size > capacity) batch_size = capacity;
+
+    pthread_mutex_lock(&pool_lock);
+
+    int id = atomic_load(&subscriber_count);
+    if (id >= SUBSCRIBERS_MAX) {
+        pthread_mutex_unlock(&pool_lock);
+        fprintf(stderr, "Error: Subscriber limit reached; cannot add '%s'\n", config->name);
+        return -1;
+    }
+
+    subscriber_t* subscriber = &subscribers[id];
+    memset(subscriber, 0, sizeof(*subscriber));
+    subscriber->queue = calloc(capacity, sizeof(queued_sample_t));
+    subscriber->batch = calloc(batch_size, sizeof(sensor_data_t));
+    if (!subscriber->queue || !subscriber->batch) {
+        free(subscriber->queue);
+        free(subscriber->batch);
+        pthread_mutex_unlock(&pool_lock);
+        fprintf(stderr, "Error: Memory allocation failed for subscriber '%s'\n", config->name);
+        return -1;
+    }
+
+    subscriber->config = *config;
+    subscriber->config.queue_capacity = capacity;
+    subscriber->config.batch_size = batch_size;
+    snprintf(subscriber->name, sizeof(subscriber->name), "%s", config->name);
+    subscriber->config.name = subscriber->name;
+
+    char safe_name[24];   // Keeps the longest metric name within the registry limit
+    char metric_name[64];
+    metric_safe_name(subscriber->name, safe_name, sizeof(safe_name));
+    snprintf(metric_name, sizeof(metric_name), "datalogger_subscriber_%s_lag_seconds", safe_name);
+    subscriber->lag_metric = register_histogram(metric_name, "Age of the oldest sample in each delivered batch");
+    snprintf(metric_name, sizeof(metric_name), "datalogger_subscriber_%s_dropped_total", safe_name);
+    subscriber->dropped_metric = register_counter(metric_name, "Samples dropped because the subscriber queue was full");
+
+    // Dispatchers read the count without the lock, so the slot is complete first
+    atomic_store(&subscriber_count, id + 1);
+    pthread_mutex_unlock(&pool_lock);
+
+    return id;
+}
+
+// Move up to max_samples from a subscriber's queue and account their lag (pool lock held)
+static int dequeue_samples(subscriber_t* subscriber, sensor_data_t* samples, int max_samples) {
+    int count = subscriber->count < max_samples ? subscriber->count : max_samples;
+    if (count == 0) return 0;
+
+    int capacity = subscriber->config.queue_capacity;
+    int64_t lag_ns = metrics_now_ns() - subscriber->queue[subscriber->head].queued_ns;
+
+    for (int i = 0; i < count; i++) {
+        samples[i] = subscriber->queue[(subscriber->head + i) % capacity].sample;
+    }
+    subscriber->head = (subscriber->head + count) % capacity;
+    subscriber->count -= count;
+
+    double lag_ms = lag_ns / 1e6;
+    subscriber->lag_total_ms += lag_ms;
+    if (lag_ms > subscriber->lag_max_ms) subscriber->lag_max_ms = lag_ms;
+    subscriber->delivered += count;
+    subscriber->batches++;
+    histogram_observe_ns(subscriber->lag_metric, (long)lag_ns);
+
+    return count;
+}
+
+// Next subscriber with a callback and queued samples that no worker is running (pool lock held)
+static subscriber_t* find_ready_subscriber(void) {
+    int count = atomic_load(&subscriber_count);
+
+    for (int n = 0; n < count; n++) {
+        int index = (next_subscriber + n) % count;
+        subscriber_t* subscriber = &subscribers[index];
+        if (subscriber->config.callback && !subscriber->busy && subscriber->count > 0) {
+            next_subscriber = (index + 1) % count;
+            return subscriber;
+        }
+    }
+
+    return NULL;
+}
+
+// Worker thread: run callbacks one batch at a time
+static void* subscriber_worker(void* arg) {
+    (void)arg;
+
+    trace_set_thread_name("subscriber");
+
+    // Analysis plug-ins never run on the acquisition CPU
+    reset_current_thread_affinity();
+
+    pthread_mutex_lock(&pool_lock);
+
+    for (;;) {
+        subscriber_t* subscriber = find_ready_subscriber();
+        if (!subscriber) {
+            if (!pool_running) break;
+            pthread_cond_wait(&work_ready, &pool_lock);
+            continue;
+        }
+
+        int count = dequeue_samples(subscriber, subscriber->batch, subscriber->config.batch_size);
+        subscriber->busy = 1;
+        pthread_mutex_unlock(&pool_lock);
+
+        trace_begin("subscriber");
+        int64_t start = metrics_now_ns();
+        subscriber->config.callback(subscriber->config.context, subscriber->batch, count);
+        int64_t elapsed = metrics_now_ns() - start;
+        trace_end("subscriber");
+
+        pthread_mutex_lock(&pool_lock);
+        subscriber->busy = 0;
+        subscriber->callback_total_us += elapsed / 1000.0;
+
+        // Another batch of this subscriber may have been skipped while it was busy
+        if (subscriber->count > 0) {
+            pthread_cond_signal(&work_ready);
+        }
+    }
+
+    pthread_mutex_unlock(&pool_lock);
+    return NULL;
+}
+
+// Start the worker threads
+int start_subscriber_pool(int thread_count) {
+    if (thread_count <= 0) return -1;
+    if (thread_count > SUBSCRIBER_POOL_MAX_THREADS) {
+        thread_count = SUBSCRIBER_POOL_MAX_THREADS;
+    }
+
+    pthread_mutex_lock(&pool_lock);
+    if (pool_running) {
+        pthread_mutex_unlock(&pool_lock);
+        return -1;
+    }
+    pool_running = 1;
+    pthread_mutex_unlock(&pool_lock);
+
+    // Subscribers never run at real-time priority
+    pthread_attr_t attr;
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    pthread_attr_setschedparam(&attr, &param);
+
+    for (int i = 0; i < thread_count; i++) {
+        int result = pthread_create(&pool_threads[i], &attr, subscriber_worker, NULL);
+        if (result != 0) {
+            fprintf(stderr, "Error: Cannot start subscriber thread: %s\n", strerror(result));
+            break;
+        }
+        pool_thread_count++;
+    }
+
+    pthread_attr_destroy(&attr);
+
+    if (pool_thread_count == 0) {
+        pthread_mutex_lock(&pool_lock);
+        pool_running = 0;
+        pthread_mutex_unlock(&pool_lock);
+        return -1;
+    }
+
+    return 0;
+}
+
+// Deliver queued samples and stop the worker threads
+void stop_subscriber_pool(void) {
+    pthread_mutex_lock(&pool_lock);
+    pool_running = 0;
+    pthread_cond_broadcast(&work_ready);
+    pthread_mutex_unlock(&pool_lock);
+
+    for (int i = 0; i < pool_thread_count; i++) {
+        pthread_join(pool_threads[i], NULL);
+    }
+    pool_thread_count = 0;
+}
+
+// Queue samples for every matching subscriber
+void dispatch_subscriber_samples(const sensor_data_t* samples, int count) {
+    if (!samples || count <= 0 || atomic_load_explicit(&subscriber_count, memory_order_acquire) == 0) return;
+
+    int64_t now = metrics_now_ns();
+    int wake = 0;
+
+    pthread_mutex_lock(&pool_lock);
+
+    int subscriber_total = atomic_load(&subscriber_count);
+    for (int s = 0; s < subscriber_total; s++) {
+        subscriber_t* subscriber = &subscribers[s];
+        int capacity = subscriber->config.queue_capacity;
+        long dropped = 0;
+
+        for (int i = 0; i < count; i++) {
+            uint32_t mask = subscriber->config.channel_mask;
+            if (mask && !(mask & SUBSCRIBE_CHANNEL(samples[i].type))) continue;
+
+            if (subscriber->count == capacity) {
+                dropped++;
+                if (subscriber->config.overload != OVERLOAD_DROP_OLDEST) continue;
+                subscriber->head = (subscriber->head + 1) % capacity;
+                subscriber->count--;
+            }
+
+            queued_sample_t* slot = &subscriber->queue[(subscriber->head + subscriber->count) % capacity];
+            slot->sample = samples[i];
+            slot->queued_ns = now;
+            subscriber->count++;
+            wake |= subscriber->config.callback != NULL;
+        }
+
+        if (dropped > 0) {
+            subscriber->dropped += dropped;
+            counter_add(subscriber->dropped_metric, dropped);
+        }
+    }
+
+    if (wake) {
+        pthread_cond_signal(&work_ready);
+    }
+
+    pthread_mutex_unlock(&pool_lock);
+}
+
+// Drain a queue-only subscriber
+int take_subscriber_samples(int id, sensor_data_t* samples, int max_samples) {
+    if (id < 0 || id >= atomic_load(&subscriber_count) || !samples || max_samples <= 0) return 0;
+
+    pthread_mutex_lock(&pool_lock);
+    int count = dequeue_samples(&subscribers[id], samples, max_samples);
+    pthread_mutex_unlock(&pool_lock);
+
+    return count;
+}
+
+// Current statistics for one subscriber
+int get_subscriber_stats(int id, subscriber_stats_t* stats) {
+    if (id < 0 || id >= atomic_load(&subscriber_count) || !stats) return -1;
+
+    pthread_mutex_lock(&pool_lock);
+
+    const subscriber_t* subscriber = &subscribers[id];
+    memset(stats, 0, sizeof(*stats));
+    snprintf(stats->name, sizeof(stats->name), "%s", subscriber->name);
+    stats->delivered = subscriber->delivered;
+    stats->dropped = subscriber->dropped;
+    stats->batches = subscriber->batches;
+    stats->queue_depth = subscriber->count;
+    stats->max_lag_ms = subscriber->lag_max_ms;
+    if (subscriber->batches > 0) {
+        stats->mean_lag_ms = subscriber->lag_total_ms / subscriber->batches;
+        stats->mean_callback_us = subscriber->callback_total_us / subscriber->batches;
+    }
+
+    pthread_mutex_unlock(&pool_lock);
+    return 0;
+}
+
+// Print per-subscriber delivery and lag statistics
+void print_subscriber_report(void) {
+    int count = atomic_load(&subscriber_count);
+    if (count == 0) return;
+
+    printf("\n=== Subscribers ===\n");
+    printf("%-20s %10s %8s %8s %6s %12s %12s %12s\n",
+           "Subscriber", "Delivered", "Dropped", "Batches", "Queue", "Mean lag ms", "Max lag ms", "Callback us");
+
+    for (int i = 0; i < count; i++) {
+        subscriber_stats_t stats;
+        if (get_subscriber_stats(i, &stats) != 0) continue;
+
+        printf("%-20s %10ld %8ld %8ld %6d %12.3f %12.3f %12.1f\n",
+               stats.name, stats.delivered, stats.dropped, stats.batches, stats.queue_depth,
+               stats.mean_lag_ms, stats.max_lag_ms, stats.mean_callback_us);
+    }
+}
@@ -0,0 +1,404 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/task_pool.h"
+#include "../include/metrics.h"
+#include "../include/realtime.h"
+#include "../include/trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+// One parallel_for or parallel_reduce call, on the caller's stack
+typedef struct {
+    task_range_fn range;
+    void* context;                  // parallel_for context
+    const task_reduce_t* reduce;
+    unsigned char* partials;        // One partial per chunk (reduce only)
+    size_t partial_stride;
+    int count;
+    int grain;
+    atomic_int remaining;           // Chunks not yet run
+} task_job_t;
+
+// Chunks [first, last) of a job
+typedef struct {
+    task_job_t* job;
+    int first;
+    int last;
+} task_t;
+
+// The owner pushes and pops at the bottom, thieves take from the top
+typedef struct {
+    pthread_mutex_t lock;
+    task_t tasks[TASK_DEQUE_CAPACITY];
+    long top;
+    long bottom;
+} task_deque_t;
+
+// Worker deques, plus one shared by threads outside the pool
+static task_deque_t deques[TASK_POOL_MAX_THREADS + 1];
+static pthread_t pool_threads[TASK_POOL_MAX_THREADS];
+static atomic_int pool_thread_count;
+static int pool_running = 0;
+static int pool_started = 0;
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_wake = PTHREAD_COND_INITIALIZER;
+static atomic_long pending_tasks;
+static atomic_int sleeping_threads;
+static atomic_long tasks_run;
+static atomic_long tasks_stolen;
+
+// Deque of the calling thread: its own on a worker, the shared one elsewhere
+static __thread int thread_slot = -1;
+
+// Pool metrics
+static metrics_counter_t* tasks_metric;
+static metrics_counter_t* steals_metric;
+static pthread_once_t task_pool_once = PTHREAD_ONCE_INIT;
+
+// Deque locks and metrics, once per process
+static void init_task_pool_state(void) {
+    for (int i = 0; i <= TASK_POOL_MAX_THREADS; i++) {
+        pthread_mutex_init(&deques[i].lock, NULL);
+    }
+
+    tasks_metric = register_counter("datalogger_analysis_tasks_total",
+                                    "Chunk ranges run by parallel analysis");
+    steals_metric = register_counter("datalogger_analysis_task_steals_total",
+                                     "Chunk ranges taken from another thread's deque");
+}
+
+// Chunk size so that no call has more than TASK_POOL_MAX_CHUNKS chunks
+static int chunk_grain(int count, int grain) {
+    int min_grain = (count + TASK_POOL_MAX_CHUNKS - 1) / TASK_POOL_MAX_CHUNKS;
+    if (grain < 1) grain = 1;
+    return grain < min_grain ? min_grain : grain;
+}
+
+// Wake sleeping threads when there is new work or a job finished
+static void wake_pool_threads(void) {
+    pthread_mutex_lock(&pool_lock);
+    pthread_cond_broadcast(&pool_wake);
+    pthread_mutex_unlock(&pool_lock);
+}
+
+// Push at the bottom; -1 when the deque is full
+static int push_task(task_deque_t* deque, const task_t* task) {
+    pthread_mutex_lock(&deque->lock);
+    if (deque->bottom - deque->top >= TASK_DEQUE_CAPACITY) {
+        pthread_mutex_unlock(&deque->lock);
+        return -1;
+    }
+    deque->tasks[deque->bottom % TASK_DEQUE_CAPACITY] = *task;
+    deque->bottom++;
+    atomic_fetch_add(&pending_tasks, 1);
+    pthread_mutex_unlock(&deque->lock);
+
+    if (atomic_load(&sleeping_threads) > 0) {
+        wake_pool_threads();
+    }
+    return 0;
+}
+
+// Pop the most recently pushed (smallest) range
+static int pop_task(task_deque_t* deque, task_t* task) {
+    pthread_mutex_lock(&deque->lock);
+    int found = deque->bottom > deque->top;
+    if (found) {
+        deque->bottom--;
+        *task = deque->tasks[deque->bottom % TASK_DEQUE_CAPACITY];
+        atomic_fetch_sub(&pending_tasks, 1);
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+// Take the oldest (largest) range from another thread
+static int steal_task(task_deque_t* deque, task_t* task) {
+    pthread_mutex_lock(&deque->lock);
+    int found = deque->bottom > deque->top;
+    if (found) {
+        *task = deque->tasks[deque->top % TASK_DEQUE_CAPACITY];
+        deque->top++;
+        atomic_fetch_sub(&pending_tasks, 1);
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+// Own deque first, then the others starting with the next slot
+static int find_task(int slot, task_t* task) {
+    if (pop_task(&deques[slot], task)) return 1;
+
+    int slots = atomic_load(&pool_thread_count) + 1;
+    for (int i = 1; i < slots; i++) {
+        if (steal_task(&deques[(slot + i) % slots], task)) {
+            atomic_fetch_add_explicit(&tasks_stolen, 1, memory_order_relaxed);
+            counter_add(steals_metric, 1);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Run one chunk, into its own partial for a reduction
+static void run_chunk(task_job_t* job, int chunk) {
+    int begin = chunk * job->grain;
+    int end = begin + job->grain < job->count ? begin + job->grain : job->count;
+
+    if (job->reduce) {
+        void* partial = job->partials + (size_t)chunk * job->partial_stride;
+        memcpy(partial, job->reduce->identity, job->reduce->result_size);
+        job->reduce->map(job->reduce->context, begin, end, partial);
+    } else {
+        job->range(job->context, begin, end);
+    }
+}
+
+// Split the range until one chunk is left, leaving upper halves to thieves
+static void run_task(int slot, task_t task) {
+    task_job_t* job = task.job;
+
+    while (task.last - task.first > 1) {
+        task_t upper = { job, task.first + (task.last - task.first) / 2, task.last };
+        if (push_task(&deques[slot], &upper) != 0) break;   // Full: run the rest here
+        task.last = upper.first;
+    }
+
+    for (int chunk = task.first; chunk < task.last; chunk++) {
+        run_chunk(job, chunk);
+    }
+
+    atomic_fetch_add_explicit(&tasks_run, 1, memory_order_relaxed);
+    counter_add(tasks_metric, 1);
+
+    // The job may be gone as soon as remaining reaches zero
+    int finished = task.last - task.first;
+    if (atomic_fetch_sub(&job->remaining, finished) == finished) {
+        wake_pool_threads();
+    }
+}
+
+// Worker thread: run and steal ranges until the pool stops
+static void* task_worker(void* arg) {
+    thread_slot = (int)(long)arg;
+
+    trace_set_thread_name("analysis");
+
+    // Analysis never runs on the acquisition CPU
+    reset_current_thread_affinity();
+
+    for (;;) {
+        task_t task;
+        if (find_task(thread_slot, &task)) {
+            run_task(thread_slot, task);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool_lock);
+        if (!pool_running) {
+            pthread_mutex_unlock(&pool_lock);
+            break;
+        }
+        atomic_fetch_add(&sleeping_threads, 1);
+        while (pool_running && atomic_load(&pending_tasks) == 0) {
+            pthread_cond_wait(&pool_wake, &pool_lock);
+        }
+        atomic_fetch_sub(&sleeping_threads, 1);
+        pthread_mutex_unlock(&pool_lock);
+    }
+
+    return NULL;
+}
+
+// Run every chunk of a job, helping until the last one is done
+static void run_job(task_job_t* job, int chunk_count) {
+    atomic_init(&job->remaining, chunk_count);
+
+    int workers = atomic_load(&pool_thread_count);
+    if (workers == 0 || chunk_count == 1) {
+        for (int chunk = 0; chunk < chunk_count; chunk++) {
+            run_chunk(job, chunk);
+        }
+        return;
+    }
+
+    int slot = thread_slot >= 0 ? thread_slot : workers;
+    task_t all = { job, 0, chunk_count };
+    run_task(slot, all);
+
+    while (atomic_load(&job->remaining) > 0) {
+        task_t task;
+        if (find_task(slot, &task)) {
+            run_task(slot, task);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool_lock);
+        atomic_fetch_add(&sleeping_threads, 1);
+        while (atomic_load(&job->remaining) > 0 && atomic_load(&pending_tasks) == 0) {
+            pthread_cond_wait(&pool_wake, &pool_lock);
+        }
+        atomic_fetch_sub(&sleeping_threads, 1);
+        pthread_mutex_unlock(&pool_lock);
+    }
+}
+
+// Start the worker threads
+int start_task_pool(int thread_count) {
+    if (thread_count < 0) return -1;
+    if (thread_count == 0) {
+        long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = cpu_count > 1 ? (int)cpu_count - 1 : 1;
+    }
+    if (thread_count > TASK_POOL_MAX_THREADS) {
+        thread_count = TASK_POOL_MAX_THREADS;
+    }
+
+    pthread_once(&task_pool_once, init_task_pool_state);
+
+    pthread_mutex_lock(&pool_lock);
+    if (pool_running) {
+        pthread_mutex_unlock(&pool_lock);
+        return -1;
+    }
+    pool_running = 1;
+    pthread_mutex_unlock(&pool_lock);
+
+    for (int i = 0; i <= thread_count; i++) {
+        deques[i].top = 0;
+        deques[i].bottom = 0;
+    }
+
+    // Analysis workers never run at real-time priority
+    pthread_attr_t attr;
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    pthread_attr_setschedparam(&attr, &param);
+
+    // Workers steal from the slots counted so far; the shared deque sits after the last worker
+    int started = 0;
+    for (int i = 0; i < thread_count; i++) {
+        int result = pthread_create(&pool_threads[i], &attr, task_worker, (void*)(long)i);
+        if (result != 0) {
+            fprintf(stderr, "Error: Cannot start analysis thread: %s\n", strerror(result));
+            break;
+        }
+        started++;
+    }
+
+    pthread_attr_destroy(&attr);
+
+    atomic_store(&pool_thread_count, started);
+    pool_started |= started > 0;
+
+    if (started == 0) {
+        pthread_mutex_lock(&pool_lock);
+        pool_running = 0;
+        pthread_mutex_unlock(&pool_lock);
+        return -1;
+    }
+
+    return 0;
+}
+
+// Stop the worker threads
+void stop_task_pool(void) {
+    pthread_mutex_lock(&pool_lock);
+    if (!pool_running) {
+        pthread_mutex_unlock(&pool_lock);
+        return;
+    }
+    pool_running = 0;
+    pthread_cond_broadcast(&pool_wake);
+    pthread_mutex_unlock(&pool_lock);
+
+    int count = atomic_exchange(&pool_thread_count, 0);    // Later calls run on the caller
+    for (int i = 0; i < count; i++) {
+        pthread_join(pool_threads[i], NULL);
+    }
+}
+
+// Worker threads running
+int task_pool_threads(void) {
+    return atomic_load(&pool_thread_count);
+}
+
+// Call fn over [0, count) in chunks
+void parallel_for(int count, int grain, task_range_fn fn, void* context) {
+    if (!fn || count <= 0) return;
+
+    task_job_t job;
+    job.range = fn;
+    job.context = context;
+    job.reduce = NULL;
+    job.partials = NULL;
+    job.partial_stride = 0;
+    job.count = count;
+    job.grain = chunk_grain(count, grain);
+
+    run_job(&job, (count + job.grain - 1) / job.grain);
+}
+
+// Reduce [0, count) into result
+int parallel_reduce(const task_reduce_t* reduce, int count, int grain, void* result,
+                    scratch_arena_t* scratch) {
+    if (!reduce || !reduce->map || !reduce->combine || !reduce->identity || !result) return -1;
+
+    memcpy(result, reduce->identity, reduce->result_size);
+    if (count <= 0) return 0;
+
+    task_job_t job;
+    job.range = NULL;
+    job.context = NULL;
+    job.reduce = reduce;
+    job.count = count;
+    job.grain = chunk_grain(count, grain);
+
+    int chunk_count = (count + job.grain - 1) / job.grain;
+
+    // One chunk folds straight into the result
+    if (chunk_count == 1) {
+        reduce->map(reduce->context, 0, count, result);
+        return 0;
+    }
+
+    job.partial_stride = (reduce->result_size + SCRATCH_ALIGNMENT - 1) & ~(size_t)(SCRATCH_ALIGNMENT - 1);
+    size_t bytes = job.partial_stride * (size_t)chunk_count;
+
+    scratch_mark_t mark = mark_scratch_arena(scratch);
+    job.partials = scratch ? scratch_alloc(scratch, bytes) : malloc(bytes);
+    if (!job.partials) {
+        fprintf(stderr, "Error: Cannot allocate %d partial results\n", chunk_count);
+        return -1;
+    }
+
+    run_job(&job, chunk_count);
+
+    // Chunk order, whichever thread ran each chunk
+    for (int chunk = 0; chunk < chunk_count; chunk++) {
+        reduce->combine(result, job.partials + (size_t)chunk * job.partial_stride);
+    }
+
+    if (scratch) {
+        release_scratch_arena(scratch, mark);
+    } else {
+        free(job.partials);
+    }
+    return 0;
+}
+
+// Print tasks run and stolen
+void print_task_pool_report(void) {
+    if (!pool_started) return;
+
+    printf("Analysis pool: %ld task(s) run, %ld stolen\n",
+           atomic_load(&tasks_run), atomic_load(&tasks_stolen));
+}
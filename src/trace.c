@@ -0,0 +1,252 @@
+#define _GNU_SOURCE
+
+#include "../include/trace.h"
+#include "../include/stage_probes.h"
+#include "../include/realtime.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/syscall.h>
+
+// One buffered event; names are string literals so only the pointer is stored
+typedef struct {
+    uint64_t ticks;
+    const char* name;
+    char phase;               // 'B' begin, 'E' end, 'i' instant
+} trace_event_t;
+
+// Per-thread ring, written only by its owning thread
+typedef struct {
+    trace_event_t* events;
+    atomic_ulong head;        // Total events written; published after each write
+    long tid;
+    char name[32];
+} trace_ring_t;
+
+static trace_ring_t rings[TRACE_MAX_THREADS];
+static atomic_int ring_count = 0;
+static __thread trace_ring_t* thread_ring = NULL;
+static __thread int thread_ring_failed = 0;
+
+static atomic_int tracing_enabled = 0;
+static uint64_t start_ticks = 0;
+static char trace_filename[256];
+static pthread_mutex_t write_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// On-demand dump thread (waits for SIGUSR1)
+static pthread_t dump_thread;
+static atomic_int dump_running = 0;
+
+// Ring of the calling thread, created on first use
+static trace_ring_t* current_ring(void) {
+    if (thread_ring || thread_ring_failed) return thread_ring;
+
+    int index = atomic_fetch_add(&ring_count, 1);
+    if (index >= TRACE_MAX_THREADS) {
+        atomic_fetch_sub(&ring_count, 1);
+        thread_ring_failed = 1;
+        return NULL;
+    }
+
+    trace_ring_t* ring = &rings[index];
+    ring->events = calloc(TRACE_RING_EVENTS, sizeof(trace_event_t));
+    ring->tid = (long)syscall(SYS_gettid);
+    if (ring->name[0] == '\0') {
+        snprintf(ring->name, sizeof(ring->name), "thread-%ld", ring->tid);
+    }
+    if (!ring->events) {
+        thread_ring_failed = 1;
+        return NULL;
+    }
+
+    thread_ring = ring;
+    return ring;
+}
+
+// Append an event to the calling thread's ring
+static void trace_record(const char* name, char phase) {
+    if (!atomic_load_explicit(&tracing_enabled, memory_order_relaxed)) return;
+
+    trace_ring_t* ring = current_ring();
+    if (!ring) return;
+
+    unsigned long head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    trace_event_t* event = &ring->events[head & (TRACE_RING_EVENTS - 1)];
+    event->ticks = probe_ticks();
+    event->name = name;
+    event->phase = phase;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+void trace_begin(const char* name) {
+    trace_record(name, 'B');
+}
+
+void trace_end(const char* name) {
+    trace_record(name, 'E');
+}
+
+void trace_instant(const char* name) {
+    trace_record(name, 'i');
+}
+
+// Name the calling thread in the trace viewer
+void trace_set_thread_name(const char* name) {
+    if (!name || !atomic_load(&tracing_enabled)) return;
+
+    trace_ring_t* ring = current_ring();
+    if (ring) {
+        snprintf(ring->name, sizeof(ring->name), "%s", name);
+    }
+}
+
+// Write one ring's events; returns the number written
+static long write_ring_events(FILE* file, trace_ring_t* ring, int pid, int* first) {
+    unsigned long head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    unsigned long begin = head > TRACE_RING_EVENTS ? head - TRACE_RING_EVENTS : 0;
+    unsigned long count = head - begin;
+    if (count == 0) return 0;
+
+    trace_event_t* copy = malloc(count * sizeof(trace_event_t));
+    if (!copy) return 0;
+    for (unsigned long i = 0; i < count; i++) {
+        copy[i] = ring->events[(begin + i) & (TRACE_RING_EVENTS - 1)];
+    }
+
+    // Skip slots the owner may have overwritten while we were copying
+    unsigned long head_after = atomic_load_explicit(&ring->head, memory_order_acquire);
+    unsigned long skip = 0;
+    if (head_after > TRACE_RING_EVENTS && head_after - TRACE_RING_EVENTS + 1 > begin) {
+        skip = head_after - TRACE_RING_EVENTS + 1 - begin;
+    }
+
+    long written = 0;
+    for (unsigned long i = skip; i < count; i++) {
+        const trace_event_t* event = &copy[i];
+        double ts_us = event->ticks > start_ticks ? probe_ticks_to_ns(event->ticks - start_ticks) / 1000.0 : 0.0;
+
+        fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%ld%s}",
+                *first ? "" : ",", event->name ? event->name : "?", event->phase, ts_us, pid, ring->tid,
+                event->phase == 'i' ? ",\"s\":\"t\"" : "");
+        *first = 0;
+        written++;
+    }
+
+    free(copy);
+    return written;
+}
+
+// Write all buffered events now
+int write_trace_file(const char* filename) {
+    if (!filename) return -1;
+
+    pthread_mutex_lock(&write_lock);
+
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot write trace file '%s'\n", filename);
+        pthread_mutex_unlock(&write_lock);
+        return -1;
+    }
+
+    int pid = (int)getpid();
+    int first = 1;
+    long events = 0;
+    int count = atomic_load(&ring_count);
+    if (count > TRACE_MAX_THREADS) count = TRACE_MAX_THREADS;
+
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+    // Thread names first so viewers label every track
+    for (int i = 0; i < count; i++) {
+        if (!rings[i].events) continue;
+        fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%ld,\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",", pid, rings[i].tid, rings[i].name);
+        first = 0;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (!rings[i].events) continue;
+        events += write_ring_events(file, &rings[i], pid, &first);
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    pthread_mutex_unlock(&write_lock);
+
+    printf("\nTrace written to %s (%ld events)\n", filename, events);
+    return 0;
+}
+
+// Write the trace whenever SIGUSR1 arrives
+static void* trace_dump_main(void* arg) {
+    (void)arg;
+
+    // Dumping must not disturb a pinned acquisition thread
+    reset_current_thread_affinity();
+
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1);
+    struct timespec timeout = {0, 200000000L};
+
+    while (atomic_load(&dump_running)) {
+        if (sigtimedwait(&signals, NULL, &timeout) == SIGUSR1) {
+            write_trace_file(trace_filename);
+        }
+    }
+
+    return NULL;
+}
+
+// Start tracing
+int start_tracing(const char* filename) {
+    if (!filename || atomic_load(&tracing_enabled)) return -1;
+
+    init_probe_clock();
+    snprintf(trace_filename, sizeof(trace_filename), "%s", filename);
+    start_ticks = probe_ticks();
+    atomic_store(&tracing_enabled, 1);
+    trace_set_thread_name("main");
+
+    // SIGUSR1 is only accepted by the dump thread; threads created later inherit the mask
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+    pthread_attr_t attr;
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    pthread_attr_setschedparam(&attr, &param);
+
+    atomic_store(&dump_running, 1);
+    if (pthread_create(&dump_thread, &attr, trace_dump_main, NULL) != 0) {
+        fprintf(stderr, "Warning: Cannot start trace dump thread; trace is written at exit only\n");
+        atomic_store(&dump_running, 0);
+    }
+    pthread_attr_destroy(&attr);
+
+    printf("Tracing to %s (send SIGUSR1 to pid %d to write it now)\n", trace_filename, (int)getpid());
+    return 0;
+}
+
+// Write the current trace file and stop tracing
+void stop_tracing(void) {
+    if (!atomic_load(&tracing_enabled)) return;
+
+    if (atomic_exchange(&dump_running, 0)) {
+        pthread_join(dump_thread, NULL);
+    }
+
+    atomic_store(&tracing_enabled, 0);
+    write_trace_file(trace_filename);
+}
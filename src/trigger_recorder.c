@@ -0,0 +1,375 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/trigger_recorder.h"
+#include "../include/data_logger.h"
+#include "../include/metrics.h"
+#include "../include/realtime.h"
+#include "../include/trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <time.h>
+
+static metrics_counter_t* events_written_metric = NULL;
+static metrics_counter_t* events_dropped_metric = NULL;
+static pthread_once_t trigger_metrics_once = PTHREAD_ONCE_INIT;
+
+static void register_trigger_metrics(void) {
+    events_written_metric = register_counter("datalogger_trigger_events_total",
+                                             "Pre/post-trigger event files written");
+    events_dropped_metric = register_counter("datalogger_trigger_events_dropped_total",
+                                             "Triggers lost because every event buffer was busy");
+}
+
+// Sample at a logical position of a ring (0 = oldest)
+static const sensor_data_t* ring_at(const trigger_ring_t* ring, int index) {
+    int position = ring->head - ring->count + index;
+    if (position < 0) position += ring->capacity;
+    return &ring->samples[position];
+}
+
+// Write one event as CSV in the main log's format
+static int write_event_file(trigger_recorder_t* recorder, const trigger_event_t* event,
+                            char* filename, size_t filename_size) {
+    time_t seconds = (time_t)(timestamp_to_realtime_ns(event->trigger_ns) / NS_PER_SEC);
+    struct tm tm_info;
+    localtime_r(&seconds, &tm_info);
+
+    snprintf(filename, filename_size, "%s/%s_event%03ld_%04d%02d%02d_%02d%02d%02d.csv",
+             recorder->directory, recorder->base_filename, event->sequence,
+             tm_info.tm_year + 1900, tm_info.tm_mon + 1, tm_info.tm_mday,
+             tm_info.tm_hour, tm_info.tm_min, tm_info.tm_sec);
+
+    data_logger_t event_log;
+    memset(&event_log, 0, sizeof(event_log));
+    event_log.file = fopen(filename, "w");
+    if (!event_log.file) {
+        fprintf(stderr, "Error: Cannot create event file '%s': %s\n", filename, strerror(errno));
+        return -1;
+    }
+
+    write_csv_header(&event_log);
+    int result = write_logger_records(&event_log, event->samples, event->count);
+    fclose(event_log.file);
+    return result;
+}
+
+// Oldest queued event, or NULL (caller holds the lock)
+static trigger_event_t* next_queued_event(trigger_recorder_t* recorder) {
+    trigger_event_t* next = NULL;
+    for (int i = 0; i < TRIGGER_EVENT_SLOTS; i++) {
+        trigger_event_t* event = &recorder->events[i];
+        if (event->state == TRIGGER_SLOT_QUEUED && (!next || event->sequence < next->sequence)) {
+            next = event;
+        }
+    }
+    return next;
+}
+
+// Event writer: writes queued events in order, then returns their slots
+static void* trigger_writer_thread(void* arg) {
+    trigger_recorder_t* recorder = arg;
+
+    trace_set_thread_name("trigger");
+    reset_current_thread_affinity();
+
+    pthread_mutex_lock(&recorder->lock);
+
+    for (;;) {
+        trigger_event_t* event = next_queued_event(recorder);
+        if (!event) {
+            if (!recorder->running) break;
+            pthread_cond_wait(&recorder->queued, &recorder->lock);
+            continue;
+        }
+        pthread_mutex_unlock(&recorder->lock);
+
+        char filename[320];
+        trace_begin("event");
+        int result = write_event_file(recorder, event, filename, sizeof(filename));
+        trace_end("event");
+
+        pthread_mutex_lock(&recorder->lock);
+        if (result == 0) {
+            trigger_event_record_t* record = &recorder->recent[recorder->events_written % TRIGGER_RECENT_EVENTS];
+            snprintf(record->filename, sizeof(record->filename), "%s", filename);
+            snprintf(record->reason, sizeof(record->reason), "%s", event->reason);
+            record->samples = event->count;
+            record->triggers = event->triggers;
+            recorder->events_written++;
+            recorder->samples_written += event->count;
+            counter_add(events_written_metric, 1);
+        }
+        event->state = TRIGGER_SLOT_FREE;
+        pthread_cond_broadcast(&recorder->written);
+    }
+
+    pthread_mutex_unlock(&recorder->lock);
+    return NULL;
+}
+
+// Allocate rings and event buffers and start the event writer
+int init_trigger_recorder(trigger_recorder_t* recorder, const char* base_filename,
+                          const trigger_config_t* config) {
+    if (!recorder || !base_filename || !config || config->pre_ms <= 0 || config->post_ms < 0 ||
+        config->interval_ms <= 0 || config->decimation < 1) {
+        return -1;
+    }
+
+    pthread_once(&trigger_metrics_once, register_trigger_metrics);
+
+    memset(recorder, 0, sizeof(*recorder));
+    recorder->config = *config;
+    snprintf(recorder->base_filename, sizeof(recorder->base_filename), "%s", base_filename);
+    snprintf(recorder->directory, sizeof(recorder->directory), "data");
+    create_data_directory(recorder->directory);
+
+    // Twice the nominal sample count leaves room for jitter and faster devices
+    int ring_capacity = 2 * (config->pre_ms / config->interval_ms) + 16;
+    int event_span_ms = config->pre_ms + TRIGGER_MAX_EXTENSION * config->post_ms;
+    int per_channel = 2 * (event_span_ms / config->interval_ms) + 16;
+    int channel_count = 0;
+
+    for (int i = 0; i < SENSOR_TYPE_COUNT; i++) {
+        if (config->channel_mask && !(config->channel_mask & (1u << i))) continue;
+
+        recorder->rings[i].samples = calloc(ring_capacity, sizeof(sensor_data_t));
+        recorder->rings[i].capacity = ring_capacity;
+        if (!recorder->rings[i].samples) {
+            cleanup_trigger_recorder(recorder);
+            return -1;
+        }
+        channel_count++;
+    }
+
+    for (int i = 0; i < TRIGGER_EVENT_SLOTS; i++) {
+        recorder->events[i].capacity = channel_count * per_channel;
+        recorder->events[i].samples = calloc(recorder->events[i].capacity, sizeof(sensor_data_t));
+        if (!recorder->events[i].samples) {
+            cleanup_trigger_recorder(recorder);
+            return -1;
+        }
+    }
+
+    pthread_mutex_init(&recorder->lock, NULL);
+    pthread_cond_init(&recorder->queued, NULL);
+    pthread_cond_init(&recorder->written, NULL);
+    recorder->running = 1;
+
+    // Event files are ordinary disk writes and never run at real-time priority
+    pthread_attr_t attr;
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    pthread_attr_setschedparam(&attr, &param);
+
+    int result = pthread_create(&recorder->writer_thread, &attr, trigger_writer_thread, recorder);
+    pthread_attr_destroy(&attr);
+    if (result != 0) {
+        fprintf(stderr, "Error: Cannot start trigger writer thread: %s\n", strerror(result));
+        cleanup_trigger_recorder(recorder);
+        return -1;
+    }
+    recorder->writer_started = 1;
+
+    printf("Trigger capture: %d ms before / %d ms after, main log keeps 1 in %d samples\n",
+           config->pre_ms, config->post_ms, config->decimation);
+    return 0;
+}
+
+// Hand the open capture to the event writer
+static void finish_capture(trigger_recorder_t* recorder) {
+    trigger_event_t* event = recorder->capturing;
+    if (!event) return;
+
+    pthread_mutex_lock(&recorder->lock);
+    event->state = TRIGGER_SLOT_QUEUED;
+    pthread_cond_signal(&recorder->queued);
+    pthread_mutex_unlock(&recorder->lock);
+
+    recorder->capturing = NULL;
+}
+
+// Add a raw sample; returns 1 when the decimated main log should keep it
+int record_trigger_sample(trigger_recorder_t* recorder, const sensor_data_t* sample) {
+    if (!recorder || !sample || sample->type < 0 || sample->type >= SENSOR_TYPE_COUNT) return 1;
+
+    trigger_ring_t* ring = &recorder->rings[sample->type];
+    if (!ring->samples) return 1;
+
+    recorder->samples_seen++;
+
+    trigger_event_t* event = recorder->capturing;
+    if (event) {
+        if (sample->timestamp > event->end_ns) {
+            finish_capture(recorder);
+        } else if (event->count < event->capacity) {
+            event->samples[event->count++] = *sample;
+        } else {
+            event->truncated++;
+        }
+    }
+
+    ring->samples[ring->head] = *sample;
+    ring->head = (ring->head + 1) % ring->capacity;
+    if (ring->count < ring->capacity) ring->count++;
+
+    if (ring->decimation_counter++ % recorder->config.decimation != 0) return 0;
+
+    recorder->samples_kept++;
+    return 1;
+}
+
+// Copy the pre-trigger history of every channel into an event in timestamp order
+static void copy_pre_trigger(trigger_recorder_t* recorder, trigger_event_t* event, int64_t from_ns) {
+    int cursor[SENSOR_TYPE_COUNT];
+
+    // Rings are in arrival order, so skip to the first sample inside the window
+    for (int c = 0; c < SENSOR_TYPE_COUNT; c++) {
+        const trigger_ring_t* ring = &recorder->rings[c];
+        cursor[c] = 0;
+        while (cursor[c] < ring->count && ring_at(ring, cursor[c])->timestamp < from_ns) cursor[c]++;
+    }
+
+    for (;;) {
+        int next = -1;
+        int64_t next_ns = 0;
+        for (int c = 0; c < SENSOR_TYPE_COUNT; c++) {
+            const trigger_ring_t* ring = &recorder->rings[c];
+            if (cursor[c] >= ring->count) continue;
+
+            int64_t time_ns = ring_at(ring, cursor[c])->timestamp;
+            if (next < 0 || time_ns < next_ns) {
+                next = c;
+                next_ns = time_ns;
+            }
+        }
+        if (next < 0) break;
+
+        if (event->count < event->capacity) {
+            event->samples[event->count++] = *ring_at(&recorder->rings[next], cursor[next]);
+        } else {
+            event->truncated++;
+        }
+        cursor[next]++;
+    }
+}
+
+// Capture around a sample that was already recorded
+void fire_trigger(trigger_recorder_t* recorder, const sensor_data_t* sample, const char* reason) {
+    if (!recorder || !sample) return;
+
+    int64_t trigger_ns = sample->timestamp;
+    int64_t post_ns = (int64_t)recorder->config.post_ms * 1000000LL;
+    trace_instant("trigger");
+
+    // Overlapping triggers become one longer event
+    trigger_event_t* event = recorder->capturing;
+    if (event) {
+        int64_t end_ns = trigger_ns + post_ns;
+        if (end_ns > event->limit_ns) end_ns = event->limit_ns;
+        if (end_ns > event->end_ns) event->end_ns = end_ns;
+        event->triggers++;
+        return;
+    }
+
+    pthread_mutex_lock(&recorder->lock);
+    for (int i = 0; i < TRIGGER_EVENT_SLOTS && !event; i++) {
+        if (recorder->events[i].state == TRIGGER_SLOT_FREE) {
+            event = &recorder->events[i];
+            event->state = TRIGGER_SLOT_CAPTURING;
+        }
+    }
+    if (!event) {
+        recorder->events_dropped++;
+        pthread_mutex_unlock(&recorder->lock);
+        counter_add(events_dropped_metric, 1);
+        return;
+    }
+    event->sequence = ++recorder->next_sequence;
+    pthread_mutex_unlock(&recorder->lock);
+
+    event->count = 0;
+    event->truncated = 0;
+    event->triggers = 1;
+    event->trigger_ns = trigger_ns;
+    event->end_ns = trigger_ns + post_ns;
+    event->limit_ns = trigger_ns + TRIGGER_MAX_EXTENSION * post_ns;
+    snprintf(event->reason, sizeof(event->reason), "%s", reason ? reason : "trigger");
+
+    copy_pre_trigger(recorder, event, trigger_ns - (int64_t)recorder->config.pre_ms * 1000000LL);
+    recorder->capturing = event;
+}
+
+// Write any open capture and wait until every queued event file is written
+void flush_trigger_recorder(trigger_recorder_t* recorder) {
+    if (!recorder || !recorder->writer_started) return;
+
+    finish_capture(recorder);
+
+    pthread_mutex_lock(&recorder->lock);
+    while (next_queued_event(recorder)) {
+        pthread_cond_wait(&recorder->written, &recorder->lock);
+    }
+    pthread_mutex_unlock(&recorder->lock);
+}
+
+// Print events written, dropped and the main log reduction
+void print_trigger_summary(trigger_recorder_t* recorder) {
+    if (!recorder || !recorder->writer_started) return;
+
+    pthread_mutex_lock(&recorder->lock);
+
+    printf("\n=== Trigger Capture ===\n");
+    printf("Events written: %ld (%ld raw samples), dropped: %ld\n",
+           recorder->events_written, recorder->samples_written, recorder->events_dropped);
+    if (recorder->samples_seen > 0) {
+        printf("Main log kept %ld of %ld samples (%.1f%%)\n", recorder->samples_kept, recorder->samples_seen,
+               100.0 * recorder->samples_kept / recorder->samples_seen);
+    }
+
+    long shown = recorder->events_written < TRIGGER_RECENT_EVENTS ? recorder->events_written : TRIGGER_RECENT_EVENTS;
+    for (long i = recorder->events_written - shown; i < recorder->events_written; i++) {
+        const trigger_event_record_t* record = &recorder->recent[i % TRIGGER_RECENT_EVENTS];
+        printf("  %s: %d samples, %d trigger(s) - %s\n",
+               record->filename, record->samples, record->triggers, record->reason);
+    }
+
+    pthread_mutex_unlock(&recorder->lock);
+}
+
+// Flush, stop the writer and free buffers
+void cleanup_trigger_recorder(trigger_recorder_t* recorder) {
+    if (!recorder) return;
+
+    if (recorder->writer_started) {
+        finish_capture(recorder);
+
+        // The writer drains queued events before it exits
+        pthread_mutex_lock(&recorder->lock);
+        recorder->running = 0;
+        pthread_cond_signal(&recorder->queued);
+        pthread_mutex_unlock(&recorder->lock);
+
+        pthread_join(recorder->writer_thread, NULL);
+        recorder->writer_started = 0;
+
+        pthread_mutex_destroy(&recorder->lock);
+        pthread_cond_destroy(&recorder->queued);
+        pthread_cond_destroy(&recorder->written);
+    }
+
+    for (int i = 0; i < SENSOR_TYPE_COUNT; i++) {
+        free(recorder->rings[i].samples);
+        recorder->rings[i].samples = NULL;
+    }
+    for (int i = 0; i < TRIGGER_EVENT_SLOTS; i++) {
+        free(recorder->events[i].samples);
+        recorder->events[i].samples = NULL;
+    }
+    recorder->capturing = NULL;
+}
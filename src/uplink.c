@@ -0,0 +1,498 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/uplink.h"
+#include "../include/metrics.h"
+#include "../include/realtime.h"
+#include "../include/trace.h"
+#include "../include/utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+// Uplink metrics
+static metrics_counter_t* records_metric;
+static metrics_counter_t* wire_bytes_metric;
+static metrics_counter_t* connects_metric;
+static metrics_gauge_t* connected_metric;
+static pthread_once_t uplink_metrics_once = PTHREAD_ONCE_INIT;
+
+static void register_uplink_metrics(void) {
+    records_metric = register_counter("datalogger_uplink_records_total",
+                                      "Log records acknowledged by the collector");
+    wire_bytes_metric = register_counter("datalogger_uplink_wire_bytes_total",
+                                         "Bytes sent to the collector after compression");
+    connects_metric = register_counter("datalogger_uplink_connects_total",
+                                       "Connections established to the collector");
+    connected_metric = register_gauge("datalogger_uplink_connected",
+                                      "1 while the uplink is connected to the collector");
+}
+
+// Fill in defaults (no host)
+void init_uplink_config(uplink_config_t* config) {
+    if (!config) return;
+
+    memset(config, 0, sizeof(*config));
+    config->port = UPLINK_DEFAULT_PORT;
+    config->bandwidth_kbps = 0;
+    config->batch_kb = 32;
+    config->drain_ms = 2000;
+}
+
+// Parse "host:port"
+int parse_uplink_address(const char* value, uplink_config_t* config) {
+    if (!value || !config || *value == '\0') return -1;
+
+    const char* colon = strrchr(value, ':');
+    size_t host_length = colon ? (size_t)(colon - value) : strlen(value);
+    if (host_length == 0 || host_length >= sizeof(config->host)) return -1;
+
+    if (colon) {
+        char* end = NULL;
+        long port = strtol(colon + 1, &end, 10);
+        if (end == colon + 1 || *end != '\0' || port <= 0 || port > 65535) return -1;
+        config->port = (int)port;
+    }
+
+    memcpy(config->host, value, host_length);
+    config->host[host_length] = '\0';
+    return 0;
+}
+
+// Whether file is one of the logger's segments for name
+// (<name>_YYYYMMDD_HHMMSS_NNNN.csv). The logger keeps these names increasing,
+// so name order is write order. Local-time names of older versions would not
+// sort among them and are left alone.
+static int is_stream_segment(const char* file, const char* name) {
+    size_t length = strlen(name);
+    if (strncmp(file, name, length) != 0 || file[length] != '_') return 0;
+
+    const char* stamp = file + length + 1;
+    for (int i = 0; i < 20; i++) {
+        if (i == 8 || i == 15 ? stamp[i] != '_' : !isdigit((unsigned char)stamp[i])) return 0;
+    }
+    return strcmp(stamp + 20, ".csv") == 0;
+}
+
+// Oldest segment of a stream newer than after ("" = oldest of all); 1 if found
+static int find_next_segment(const uplink_t* uplink, const char* name, const char* after,
+                             char* segment) {
+    DIR* dir = opendir(uplink->directory);
+    if (!dir) return 0;
+
+    int found = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strlen(entry->d_name) >= UPLINK_MAX_NAME || !is_stream_segment(entry->d_name, name)) continue;
+        if (strcmp(entry->d_name, after) <= 0) continue;
+        if (!found || strcmp(entry->d_name, segment) < 0) {
+            strcpy(segment, entry->d_name);
+            found = 1;
+        }
+    }
+
+    closedir(dir);
+    return found;
+}
+
+// Take over the collector's position of a stream. A segment that is not on
+// disk here (deleted, or data from another install) cannot be continued;
+// forwarding goes on with the oldest local segment after it, which is the
+// first one the collector will take, or waits until there is one.
+static void follow_collector_position(uplink_t* uplink, uplink_stream_t* stream,
+                                      const char* segment, uint64_t offset) {
+    strcpy(stream->segment, segment);
+    stream->offset = offset;
+
+    char path[512];
+    struct stat info;
+    snprintf(path, sizeof(path), "%s/%s", uplink->directory, segment);
+    if (segment[0] == '\0' || stat(path, &info) == 0) {
+        stream->missing_reported = 0;
+        return;
+    }
+
+    char next[UPLINK_MAX_NAME];
+    if (find_next_segment(uplink, stream->name, segment, next)) {
+        fprintf(stderr, "Warning: Collector holds %s, which is not on disk here; continuing with %s\n",
+                segment, next);
+        strcpy(stream->segment, next);
+        stream->offset = 0;
+        stream->missing_reported = 0;
+    } else if (!stream->missing_reported) {
+        fprintf(stderr, "Warning: Collector holds %s, which is not on disk here and newer than every "
+                "local segment; %s waits for a newer one\n", segment, stream->name);
+        stream->missing_reported = 1;
+    }
+}
+
+// Read whole lines of the current segment from the forwarded offset into
+// uplink->records; returns their length (0 = nothing new, -1 = segment gone,
+// -2 = segment shorter than what was forwarded)
+static long read_segment_records(uplink_t* uplink, const uplink_stream_t* stream) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", uplink->directory, stream->segment);
+
+    struct stat info;
+    if (stat(path, &info) != 0) return -1;
+
+    // Segments only grow; a shorter one was replaced and cannot be continued
+    if ((uint64_t)info.st_size < stream->offset) return -2;
+    if ((uint64_t)info.st_size == stream->offset) return 0;
+
+    FILE* file = fopen(path, "rb");
+    if (!file) return -1;
+
+    size_t capacity = (size_t)uplink->config.batch_kb * 1024;
+    size_t length = 0;
+    if (fseeko(file, (off_t)stream->offset, SEEK_SET) == 0) {
+        length = fread(uplink->records, 1, capacity, file);
+    }
+    fclose(file);
+
+    // The logger may be in the middle of a line; a line longer than a whole
+    // batch goes out in pieces
+    size_t complete = length;
+    while (complete > 0 && uplink->records[complete - 1] != '\n') complete--;
+    if (complete == 0 && length == capacity) complete = length;
+
+    return (long)complete;
+}
+
+static int drain_expired(const uplink_t* uplink) {
+    return atomic_load(&uplink->draining) && get_current_time() >= uplink->drain_deadline;
+}
+
+// Wait until the bandwidth budget allows bytes more on the wire. Up to one
+// second of budget left unused may be spent at once. At a low budget one
+// batch may have to wait for many seconds, so the wait is given up (-1) once
+// the drain deadline passes.
+static int pace_uplink(uplink_t* uplink, size_t bytes) {
+    if (uplink->config.bandwidth_kbps <= 0) return 0;
+
+    timestamp_ns_t now = get_current_time();
+    if (uplink->next_send < now - NS_PER_SEC) uplink->next_send = now - NS_PER_SEC;
+    while (now < uplink->next_send) {
+        if (drain_expired(uplink)) return -1;
+
+        timestamp_ns_t step = now + 100 * NS_PER_MS;
+        struct timespec until = timestamp_to_timespec(step < uplink->next_send ? step : uplink->next_send);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL) == EINTR) {
+        }
+        now = get_current_time();
+    }
+
+    uplink->next_send += (int64_t)bytes * 8 * NS_PER_SEC / ((int64_t)uplink->config.bandwidth_kbps * 1000);
+    return 0;
+}
+
+// Send one batch of a stream and wait for its acknowledgement.
+// Returns 1 when something happened, 0 when the stream is caught up (or the
+// drain deadline passed while pacing), -1 when the connection failed.
+static int forward_stream_batch(uplink_t* uplink, int fd, uplink_stream_t* stream) {
+    char next[UPLINK_MAX_NAME];
+
+    if (stream->segment[0] == '\0') {
+        if (!find_next_segment(uplink, stream->name, "", stream->segment)) return 0;
+        stream->offset = 0;
+    }
+
+    // Look for a newer segment before reading: once it exists, rotation has
+    // closed the current one, so reading it empty means it is done
+    int has_next = find_next_segment(uplink, stream->name, stream->segment, next);
+    long length = read_segment_records(uplink, stream);
+    if (length <= 0) {
+        if (!has_next) return 0;
+        if (length == -2) {
+            fprintf(stderr, "Warning: Uplink segment %s shrank below %llu bytes, skipping it\n",
+                    stream->segment, (unsigned long long)stream->offset);
+        }
+        strcpy(stream->segment, next);
+        stream->offset = 0;
+        return 1;
+    }
+
+    uint32_t record_count = 0;
+    for (long i = 0; i < length; i++) {
+        if (uplink->records[i] == '\n') record_count++;
+    }
+
+    uplink_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.type = UPLINK_DATA;
+    strcpy(frame.stream, stream->name);
+    strcpy(frame.segment, stream->segment);
+    frame.offset = stream->offset;
+    frame.raw_length = (uint32_t)length;
+    frame.record_count = record_count;
+
+    size_t compressed = compress_uplink_records(uplink->records, (size_t)length,
+                                                uplink->frame_buffer, UPLINK_MAX_PAYLOAD);
+    if (compressed > 0) {
+        frame.flags = UPLINK_FLAG_COMPRESSED;
+        frame.payload = uplink->frame_buffer;
+        frame.payload_length = (uint32_t)compressed;
+    } else {
+        frame.payload = uplink->records;
+        frame.payload_length = (uint32_t)length;
+    }
+
+    size_t wire_bytes = frame.payload_length + strlen(frame.stream) + strlen(frame.segment) + 32;
+    if (pace_uplink(uplink, wire_bytes) != 0) return 0;
+
+    trace_begin("uplink_send");
+    int sent = send_uplink_frame(fd, &frame);
+    uplink_frame_t ack;
+    int acked = sent == 0 &&
+                recv_uplink_frame(fd, &ack, uplink->frame_buffer, UPLINK_MAX_PAYLOAD) == 0 &&
+                ack.type == UPLINK_ACK && strcmp(ack.stream, stream->name) == 0;
+    trace_end("uplink_send");
+    if (!acked) return -1;
+
+    uplink->frames_sent++;
+    uplink->wire_bytes += (long)wire_bytes;
+    counter_add(wire_bytes_metric, (int64_t)wire_bytes);
+
+    if (strcmp(ack.segment, stream->segment) == 0 && ack.offset == stream->offset + (uint64_t)length) {
+        stream->offset = ack.offset;
+        uplink->records_sent += record_count;
+        uplink->raw_bytes += length;
+        counter_add(records_metric, record_count);
+    } else {
+        // The collector holds something else (e.g. it lost data); continue from there
+        follow_collector_position(uplink, stream, ack.segment, ack.offset);
+        uplink->realigned++;
+    }
+
+    return 1;
+}
+
+// Connect with a timeout; returns the socket or -1
+static int connect_uplink(const uplink_t* uplink) {
+    struct addrinfo hints;
+    struct addrinfo* addresses = NULL;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    char port[16];
+    snprintf(port, sizeof(port), "%d", uplink->config.port);
+    if (getaddrinfo(uplink->config.host, port, &hints, &addresses) != 0) return -1;
+
+    int fd = -1;
+    for (struct addrinfo* address = addresses; address && fd < 0; address = address->ai_next) {
+        fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd < 0) continue;
+
+        // Non-blocking connect so an unreachable collector cannot stall shutdown
+        int flags = fcntl(fd, F_GETFL, 0);
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        int connected = connect(fd, address->ai_addr, address->ai_addrlen) == 0;
+        if (!connected && errno == EINPROGRESS) {
+            struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+            int error = 0;
+            socklen_t error_length = sizeof(error);
+            connected = poll(&pfd, 1, UPLINK_ACK_TIMEOUT_MS) == 1 &&
+                        getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &error_length) == 0 && error == 0;
+        }
+        fcntl(fd, F_SETFL, flags);
+
+        if (!connected) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+    if (fd < 0) return -1;
+
+    // Small frames (acks) must not wait for delayed acknowledgement; a silent
+    // collector counts as a lost connection
+    int no_delay = 1;
+    struct timeval timeout = { UPLINK_ACK_TIMEOUT_MS / 1000, 0 };
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    return fd;
+}
+
+// Ask the collector where every stream stands
+static int resume_uplink_streams(uplink_t* uplink, int fd) {
+    for (int i = 0; i < uplink->stream_count; i++) {
+        uplink_stream_t* stream = &uplink->streams[i];
+
+        uplink_frame_t frame;
+        memset(&frame, 0, sizeof(frame));
+        frame.type = UPLINK_HELLO;
+        strcpy(frame.stream, stream->name);
+
+        uplink_frame_t resume;
+        if (send_uplink_frame(fd, &frame) != 0 ||
+            recv_uplink_frame(fd, &resume, uplink->frame_buffer, UPLINK_MAX_PAYLOAD) != 0 ||
+            resume.type != UPLINK_RESUME || strcmp(resume.stream, stream->name) != 0) {
+            return -1;
+        }
+
+        follow_collector_position(uplink, stream, resume.segment, resume.offset);
+    }
+
+    return 0;
+}
+
+// Sleep in short steps so a drain deadline is noticed
+static void wait_uplink(const uplink_t* uplink, int milliseconds) {
+    for (int waited = 0; waited < milliseconds && !drain_expired(uplink); waited += 100) {
+        sleep_ms(milliseconds - waited < 100 ? milliseconds - waited : 100);
+    }
+}
+
+// Uplink thread: connect, resume, forward; reconnect with backoff
+static void* uplink_thread(void* arg) {
+    uplink_t* uplink = arg;
+    int retry_ms = UPLINK_RETRY_MIN_MS;
+    int reported = 0;
+
+    trace_set_thread_name("uplink");
+
+    // Network I/O must not disturb a pinned acquisition thread
+    reset_current_thread_affinity();
+
+    while (!drain_expired(uplink)) {
+        int fd = connect_uplink(uplink);
+        if (fd >= 0 && resume_uplink_streams(uplink, fd) == 0) {
+            uplink->connects++;
+            counter_add(connects_metric, 1);
+            gauge_set(connected_metric, 1);
+            printf("Uplink connected to %s:%d\n", uplink->config.host, uplink->config.port);
+            retry_ms = UPLINK_RETRY_MIN_MS;
+            reported = 0;
+
+            int caught_up = 0;
+            while (!drain_expired(uplink)) {
+                int progress = 0;
+                int failed = 0;
+                for (int i = 0; i < uplink->stream_count && !failed; i++) {
+                    int status = forward_stream_batch(uplink, fd, &uplink->streams[i]);
+                    if (status < 0) failed = 1;
+                    if (status > 0) progress = 1;
+                }
+                if (failed) break;
+
+                if (!progress) {
+                    if (atomic_load(&uplink->draining)) {
+                        caught_up = 1;
+                        break;
+                    }
+                    wait_uplink(uplink, UPLINK_POLL_MS);
+                }
+            }
+
+            gauge_set(connected_metric, 0);
+            close(fd);
+            if (caught_up) break;
+            if (!drain_expired(uplink)) {
+                printf("Uplink connection to %s:%d lost, reconnecting\n", uplink->config.host, uplink->config.port);
+            }
+        } else {
+            if (fd >= 0) close(fd);
+            if (!reported) {
+                fprintf(stderr, "Warning: Cannot reach collector %s:%d, records stay queued on disk\n",
+                        uplink->config.host, uplink->config.port);
+                reported = 1;
+            }
+        }
+
+        // Nothing is lost while waiting: records stay in the segments
+        wait_uplink(uplink, retry_ms);
+        retry_ms = retry_ms * 2 < UPLINK_RETRY_MAX_MS ? retry_ms * 2 : UPLINK_RETRY_MAX_MS;
+    }
+
+    return NULL;
+}
+
+// Start forwarding the segments of the named logs
+int start_uplink(uplink_t* uplink, const uplink_config_t* config, const char* directory,
+                 const char* const* names, int count) {
+    if (!uplink || !config || !directory || !names || count <= 0 || count > UPLINK_MAX_STREAMS ||
+        config->host[0] == '\0' || config->batch_kb <= 0 || config->batch_kb * 1024 > UPLINK_MAX_RECORDS) {
+        return -1;
+    }
+
+    pthread_once(&uplink_metrics_once, register_uplink_metrics);
+
+    memset(uplink, 0, sizeof(*uplink));
+    uplink->config = *config;
+    snprintf(uplink->directory, sizeof(uplink->directory), "%s", directory);
+    for (int i = 0; i < count; i++) {
+        if (strlen(names[i]) >= UPLINK_MAX_NAME) return -1;
+        strcpy(uplink->streams[i].name, names[i]);
+    }
+    uplink->stream_count = count;
+    atomic_init(&uplink->draining, 0);
+
+    uplink->records = malloc((size_t)config->batch_kb * 1024);
+    uplink->frame_buffer = malloc(UPLINK_MAX_PAYLOAD);
+    if (!uplink->records || !uplink->frame_buffer) {
+        fprintf(stderr, "Error: Cannot allocate uplink buffers\n");
+        free(uplink->records);
+        free(uplink->frame_buffer);
+        return -1;
+    }
+
+    if (pthread_create(&uplink->thread, NULL, uplink_thread, uplink) != 0) {
+        fprintf(stderr, "Error: Cannot start uplink thread\n");
+        free(uplink->records);
+        free(uplink->frame_buffer);
+        return -1;
+    }
+    uplink->thread_started = 1;
+
+    printf("Uplink forwarding %d log(s) to %s:%d", count, config->host, config->port);
+    if (config->bandwidth_kbps > 0) printf(" at up to %d kbit/s", config->bandwidth_kbps);
+    printf("\n");
+    return 0;
+}
+
+// Forward what is left for up to drain_ms, then stop
+void stop_uplink(uplink_t* uplink) {
+    if (!uplink || !uplink->thread_started) return;
+
+    uplink->drain_deadline = get_current_time() + (int64_t)uplink->config.drain_ms * NS_PER_MS;
+    atomic_store(&uplink->draining, 1);
+    pthread_join(uplink->thread, NULL);
+    uplink->thread_started = 0;
+
+    free(uplink->records);
+    free(uplink->frame_buffer);
+    uplink->records = NULL;
+    uplink->frame_buffer = NULL;
+}
+
+// Print frames, records, compression and reconnects
+void print_uplink_report(const uplink_t* uplink) {
+    if (!uplink) return;
+
+    printf("Uplink: %ld record(s) in %ld frame(s), %ld bytes sent for %ld (%.1fx), %ld connect(s)",
+           uplink->records_sent, uplink->frames_sent, uplink->wire_bytes, uplink->raw_bytes,
+           uplink->wire_bytes > 0 ? (double)uplink->raw_bytes / (double)uplink->wire_bytes : 0.0,
+           uplink->connects);
+    if (uplink->realigned > 0) printf(", %ld realigned", uplink->realigned);
+    printf("\n");
+
+    for (int i = 0; i < uplink->stream_count; i++) {
+        const uplink_stream_t* stream = &uplink->streams[i];
+        printf("  %s: %s at %llu\n", stream->name,
+               stream->segment[0] ? stream->segment : "(nothing forwarded)",
+               (unsigned long long)stream->offset);
+    }
+}
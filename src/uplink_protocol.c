@@ -0,0 +1,301 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/uplink_protocol.h"
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <arpa/inet.h>
+
+#define UPLINK_HEADER_SIZE 12
+#define UPLINK_META_MAX (2 + UPLINK_MAX_NAME + 2 + UPLINK_MAX_NAME + 16)
+
+// Compressor parameters: a sequence is literals plus an optional back reference
+#define LZ_MIN_MATCH 4
+#define LZ_HASH_BITS 12
+#define LZ_MAX_OFFSET 65535
+
+static uint8_t* put_u16(uint8_t* p, uint16_t value) {
+    p[0] = (uint8_t)(value >> 8);
+    p[1] = (uint8_t)value;
+    return p + 2;
+}
+
+static uint8_t* put_u32(uint8_t* p, uint32_t value) {
+    p[0] = (uint8_t)(value >> 24);
+    p[1] = (uint8_t)(value >> 16);
+    p[2] = (uint8_t)(value >> 8);
+    p[3] = (uint8_t)value;
+    return p + 4;
+}
+
+static uint16_t get_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] << 8 | p[1]);
+}
+
+static uint32_t get_u32(const uint8_t* p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+// Length-prefixed name
+static uint8_t* put_name(uint8_t* p, const char* name) {
+    size_t length = strnlen(name, UPLINK_MAX_NAME - 1);
+    p = put_u16(p, (uint16_t)length);
+    memcpy(p, name, length);
+    return p + length;
+}
+
+// Send header, metadata and payload, retrying on short writes
+static int send_all(int fd, struct iovec* parts, int count) {
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = parts;
+    message.msg_iovlen = (size_t)count;
+
+    while (message.msg_iovlen > 0) {
+        ssize_t sent = sendmsg(fd, &message, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return -1;
+
+        while (message.msg_iovlen > 0 && (size_t)sent >= message.msg_iov->iov_len) {
+            sent -= (ssize_t)message.msg_iov->iov_len;
+            message.msg_iov++;
+            message.msg_iovlen--;
+        }
+        if (message.msg_iovlen > 0) {
+            message.msg_iov->iov_base = (uint8_t*)message.msg_iov->iov_base + sent;
+            message.msg_iov->iov_len -= (size_t)sent;
+        }
+    }
+
+    return 0;
+}
+
+static int recv_all(int fd, uint8_t* data, size_t length) {
+    while (length > 0) {
+        ssize_t received = recv(fd, data, length, 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) return -1;
+        data += received;
+        length -= (size_t)received;
+    }
+    return 0;
+}
+
+// Send one frame
+int send_uplink_frame(int fd, const uplink_frame_t* frame) {
+    if (fd < 0 || !frame) return -1;
+
+    uint8_t meta[UPLINK_HEADER_SIZE + UPLINK_META_MAX];
+    uint8_t* p = meta + UPLINK_HEADER_SIZE;
+    p = put_name(p, frame->stream);
+    p = put_name(p, frame->segment);
+    p = put_u32(p, (uint32_t)(frame->offset >> 32));
+    p = put_u32(p, (uint32_t)frame->offset);
+    p = put_u32(p, frame->raw_length);
+    p = put_u32(p, frame->record_count);
+
+    size_t body_length = (size_t)(p - meta) - UPLINK_HEADER_SIZE + frame->payload_length;
+    uint8_t* header = meta;
+    header = put_u32(header, UPLINK_MAGIC);
+    header = put_u16(header, (uint16_t)frame->type);
+    header = put_u16(header, frame->flags);
+    put_u32(header, (uint32_t)body_length);
+
+    struct iovec parts[2];
+    parts[0].iov_base = meta;
+    parts[0].iov_len = (size_t)(p - meta);
+    parts[1].iov_base = (void*)frame->payload;
+    parts[1].iov_len = frame->payload_length;
+
+    return send_all(fd, parts, frame->payload_length > 0 ? 2 : 1);
+}
+
+// Read a length-prefixed name from the metadata
+static const uint8_t* get_name(const uint8_t* p, const uint8_t* end, char* name) {
+    if (end - p < 2) return NULL;
+    uint16_t length = get_u16(p);
+    p += 2;
+    if (length >= UPLINK_MAX_NAME || end - p < length) return NULL;
+    memcpy(name, p, length);
+    name[length] = '\0';
+    return p + length;
+}
+
+// Receive one frame
+int recv_uplink_frame(int fd, uplink_frame_t* frame, uint8_t* buffer, size_t capacity) {
+    if (fd < 0 || !frame) return -1;
+
+    uint8_t header[UPLINK_HEADER_SIZE];
+    if (recv_all(fd, header, sizeof(header)) != 0) return -1;
+    if (get_u32(header) != UPLINK_MAGIC) return -1;
+
+    frame->type = (uplink_frame_type_t)get_u16(header + 4);
+    frame->flags = get_u16(header + 6);
+    uint32_t body_length = get_u32(header + 8);
+
+    // Metadata first; its names are length-prefixed, so read the prefixes as we go
+    uint8_t meta[UPLINK_META_MAX];
+    size_t meta_length = 0;
+    for (int name = 0; name < 2; name++) {
+        if (meta_length + 2 > body_length ||
+            recv_all(fd, meta + meta_length, 2) != 0) return -1;
+        uint16_t length = get_u16(meta + meta_length);
+        meta_length += 2;
+        if (length >= UPLINK_MAX_NAME || meta_length + length > body_length ||
+            recv_all(fd, meta + meta_length, length) != 0) return -1;
+        meta_length += length;
+    }
+    if (meta_length + 16 > body_length || recv_all(fd, meta + meta_length, 16) != 0) return -1;
+    meta_length += 16;
+
+    const uint8_t* p = meta;
+    const uint8_t* end = meta + meta_length;
+    p = get_name(p, end, frame->stream);
+    if (p) p = get_name(p, end, frame->segment);
+    if (!p) return -1;
+    frame->offset = (uint64_t)get_u32(p) << 32 | get_u32(p + 4);
+    frame->raw_length = get_u32(p + 8);
+    frame->record_count = get_u32(p + 12);
+
+    frame->payload_length = body_length - (uint32_t)meta_length;
+    frame->payload = buffer;
+    if (frame->payload_length > capacity) return -1;
+    return frame->payload_length > 0 ? recv_all(fd, buffer, frame->payload_length) : 0;
+}
+
+static uint32_t hash_sequence(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return (value * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+// Lengths of 15 and more continue in extra bytes of up to 255 each
+static uint8_t* put_length(uint8_t* op, const uint8_t* oend, size_t length) {
+    while (length >= 255) {
+        if (op >= oend) return NULL;
+        *op++ = 255;
+        length -= 255;
+    }
+    if (op >= oend) return NULL;
+    *op++ = (uint8_t)length;
+    return op;
+}
+
+// Emit literals and, when match_length > 0, a back reference
+static uint8_t* put_sequence(uint8_t* op, const uint8_t* oend, const uint8_t* literals,
+                             size_t literal_length, size_t offset, size_t match_length) {
+    size_t match_code = match_length ? match_length - LZ_MIN_MATCH : 0;
+    if (op >= oend) return NULL;
+    *op++ = (uint8_t)((literal_length < 15 ? literal_length : 15) << 4 |
+                      (match_code < 15 ? match_code : 15));
+
+    if (literal_length >= 15 && !(op = put_length(op, oend, literal_length - 15))) return NULL;
+    if ((size_t)(oend - op) < literal_length) return NULL;
+    memcpy(op, literals, literal_length);
+    op += literal_length;
+
+    if (match_length == 0) return op;
+    if (oend - op < 2) return NULL;
+    *op++ = (uint8_t)offset;
+    *op++ = (uint8_t)(offset >> 8);
+    if (match_code >= 15 && !(op = put_length(op, oend, match_code - 15))) return NULL;
+    return op;
+}
+
+// LZ77 compression of record text
+size_t compress_uplink_records(const uint8_t* input, size_t length, uint8_t* output, size_t capacity) {
+    if (!input || !output || length == 0) return 0;
+
+    // Positions are stored plus one so that zero means empty
+    uint32_t table[1 << LZ_HASH_BITS];
+    memset(table, 0, sizeof(table));
+
+    const uint8_t* ip = input;
+    const uint8_t* anchor = input;
+    const uint8_t* end = input + length;
+    const uint8_t* oend = output + (capacity < length ? capacity : length);
+    uint8_t* op = output;
+
+    while (end - ip >= LZ_MIN_MATCH) {
+        uint32_t hash = hash_sequence(ip);
+        uint32_t candidate = table[hash];
+        table[hash] = (uint32_t)(ip - input) + 1;
+
+        const uint8_t* ref = candidate ? input + candidate - 1 : NULL;
+        if (!ref || ip - ref > LZ_MAX_OFFSET || memcmp(ref, ip, LZ_MIN_MATCH) != 0) {
+            ip++;
+            continue;
+        }
+
+        size_t match = LZ_MIN_MATCH;
+        while (ip + match < end && ref[match] == ip[match]) match++;
+
+        op = put_sequence(op, oend, anchor, (size_t)(ip - anchor), (size_t)(ip - ref), match);
+        if (!op) return 0;
+
+        // Later lines mostly repeat earlier ones, so index the matched bytes too
+        const uint8_t* match_end = ip + match;
+        for (ip++; ip < match_end && end - ip >= LZ_MIN_MATCH; ip++) {
+            table[hash_sequence(ip)] = (uint32_t)(ip - input) + 1;
+        }
+        ip = match_end;
+        anchor = ip;
+    }
+
+    op = put_sequence(op, oend, anchor, (size_t)(end - anchor), 0, 0);
+    if (!op || (size_t)(op - output) >= length) return 0;
+    return (size_t)(op - output);
+}
+
+// Read an extended length
+static int get_length(const uint8_t** ip, const uint8_t* iend, size_t* length) {
+    uint8_t byte;
+    do {
+        if (*ip >= iend) return -1;
+        byte = *(*ip)++;
+        *length += byte;
+    } while (byte == 255);
+    return 0;
+}
+
+// Decompress exactly expected bytes
+int decompress_uplink_records(const uint8_t* input, size_t length, uint8_t* output, size_t expected) {
+    if (!input || !output) return -1;
+
+    const uint8_t* ip = input;
+    const uint8_t* iend = input + length;
+    uint8_t* op = output;
+    uint8_t* oend = output + expected;
+
+    while (ip < iend) {
+        uint8_t token = *ip++;
+
+        size_t literal_length = token >> 4;
+        if (literal_length == 15 && get_length(&ip, iend, &literal_length) != 0) return -1;
+        if ((size_t)(iend - ip) < literal_length || (size_t)(oend - op) < literal_length) return -1;
+        memcpy(op, ip, literal_length);
+        ip += literal_length;
+        op += literal_length;
+
+        // The last sequence has literals only
+        if (ip == iend) break;
+
+        if (iend - ip < 2) return -1;
+        size_t offset = (size_t)ip[0] | (size_t)ip[1] << 8;
+        ip += 2;
+        size_t match_length = token & 0xf;
+        if (match_length == 15 && get_length(&ip, iend, &match_length) != 0) return -1;
+        match_length += LZ_MIN_MATCH;
+
+        if (offset == 0 || offset > (size_t)(op - output) || (size_t)(oend - op) < match_length) return -1;
+
+        // Byte by byte: a reference may overlap the bytes it produces
+        const uint8_t* ref = op - offset;
+        for (size_t i = 0; i < match_length; i++) op[i] = ref[i];
+        op += match_length;
+    }
+
+    return op == oend ? 0 : -1;
+}
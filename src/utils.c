@@ -8,36 +8,70 @@
 #include <unistd.h>
 #include <ctype.h>
 #include <math.h>
+#include <pthread.h>
 
-// Get current time with high precision
-precise_time_t get_current_time(void) {
-    precise_time_t current_time;
+// Wall-clock minus monotonic time, fixed at the first conversion
+static int64_t realtime_anchor_ns;
+static pthread_once_t realtime_anchor_once = PTHREAD_ONCE_INIT;
+
+static int64_t read_clock_ns(clockid_t clock) {
     struct timespec ts;
-    
-    if (clock_gettime(CLOCK_REALTIME, &ts) == 0) {
-        current_time.timestamp = ts.tv_sec;
-        current_time.nanoseconds = ts.tv_nsec;
-    } else {
-        // Fallback to lower precision
-        current_time.timestamp = time(NULL);
-        current_time.nanoseconds = 0;
-    }
-    
-    return current_time;
+    clock_gettime(clock, &ts);
+    return (int64_t)ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
+// Take the realtime reading between two monotonic ones and use their midpoint
+static void take_realtime_anchor(void) {
+    int64_t before = read_clock_ns(CLOCK_MONOTONIC);
+    int64_t realtime = read_clock_ns(CLOCK_REALTIME);
+    int64_t after = read_clock_ns(CLOCK_MONOTONIC);
+
+    realtime_anchor_ns = realtime - (before + (after - before) / 2);
+}
+
+// Current monotonic time
+timestamp_ns_t get_current_time(void) {
+    return read_clock_ns(CLOCK_MONOTONIC);
+}
+
+// Coarse monotonic time, same base as get_current_time
+timestamp_ns_t get_coarse_time(void) {
+#ifdef CLOCK_MONOTONIC_COARSE
+    return read_clock_ns(CLOCK_MONOTONIC_COARSE);
+#else
+    return read_clock_ns(CLOCK_MONOTONIC);
+#endif
+}
+
+// Wall-clock nanoseconds since the epoch for a monotonic timestamp
+int64_t timestamp_to_realtime_ns(timestamp_ns_t time) {
+    pthread_once(&realtime_anchor_once, take_realtime_anchor);
+    return time + realtime_anchor_ns;
+}
+
+// Absolute CLOCK_MONOTONIC timespec for clock_nanosleep
+struct timespec timestamp_to_timespec(timestamp_ns_t time) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)(time / NS_PER_SEC);
+    ts.tv_nsec = (long)(time % NS_PER_SEC);
+    return ts;
 }
 
 // Format timestamp for CSV output
-void format_timestamp(precise_time_t time, char* buffer, size_t buffer_size) {
-    struct tm* tm_info = localtime(&time.timestamp);
+void format_timestamp(timestamp_ns_t time, char* buffer, size_t buffer_size) {
+    int64_t realtime = timestamp_to_realtime_ns(time);
+    time_t seconds = (time_t)(realtime / NS_PER_SEC);
+    struct tm tm_info;
+    localtime_r(&seconds, &tm_info);
     
     snprintf(buffer, buffer_size, "%04d-%02d-%02d %02d:%02d:%02d.%06ld",
-             tm_info->tm_year + 1900,
-             tm_info->tm_mon + 1,
-             tm_info->tm_mday,
-             tm_info->tm_hour,
-             tm_info->tm_min,
-             tm_info->tm_sec,
-             time.nanoseconds / 1000);  // Convert to microseconds
+             tm_info.tm_year + 1900,
+             tm_info.tm_mon + 1,
+             tm_info.tm_mday,
+             tm_info.tm_hour,
+             tm_info.tm_min,
+             tm_info.tm_sec,
+             (long)(realtime % NS_PER_SEC / NS_PER_US));
 }
 
 // Sleep for specified milliseconds
@@ -46,11 +80,8 @@ void sleep_ms(int milliseconds) {
 }
 
 // Calculate time difference in milliseconds
-double time_diff_ms(precise_time_t start, precise_time_t end) {
-    double diff_sec = difftime(end.timestamp, start.timestamp);
-    double diff_ns = (double)(end.nanoseconds - start.nanoseconds);
-    
-    return (diff_sec * 1000.0) + (diff_ns / 1000000.0);
+double time_diff_ms(timestamp_ns_t start, timestamp_ns_t end) {
+    return (double)(end - start) / NS_PER_MS;
 }
 
 // Trim whitespace from string
@@ -73,7 +104,8 @@ void trim_whitespace(char* str) {
 // Parse command line arguments
 int parse_command_line_args(int argc, char* argv[], char** device_path, 
                            int* duration, int* interval, char** output_file, 
-                           double* threshold, int* hardware_mode) {
+                           double* threshold, int* hardware_mode,
+                           runtime_options_t* options) {
     // Set defaults
     *device_path = NULL;
     *duration = 60;        // 60 seconds default
@@ -81,6 +113,25 @@ int parse_command_line_args(int argc, char* argv[], char** device_path,
     *output_file = NULL;
     *threshold = 3.0;      // 3 standard deviations default
     *hardware_mode = 0;    // Simulated mode default
+    options->realtime = 0;
+    options->rt_priority = 80;
+    options->acquisition_cpu = -1;
+    options->writer_cpu = -1;
+    options->status_hz = 10;
+    options->config_file = NULL;
+    options->metrics_port = 0;
+    options->perf_counters = 0;
+    options->trace_file = NULL;
+    options->bus_name = NULL;
+    options->bus_slots = 65536;
+    options->subscriber_threads = 2;
+    options->analysis_threads = -1;
+    options->history_seconds = 0;
+    options->history_mb = 16;
+    options->rules_file = NULL;
+    options->trigger_pre_ms = 0;
+    options->trigger_post_ms = -1;
+    options->log_decimation = 1;
     
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--hardware") == 0 && i + 1 < argc) {
@@ -88,8 +139,8 @@ int parse_command_line_args(int argc, char* argv[], char** device_path,
             *device_path = argv[++i];
         } else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
             *duration = atoi(argv[++i]);
-            if (*duration <= 0) {
-                fprintf(stderr, "Error: Duration must be positive\n");
+            if (*duration < 0) {
+                fprintf(stderr, "Error: Duration must not be negative\n");
                 return -1;
             }
         } else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
@@ -106,20 +157,135 @@ int parse_command_line_args(int argc, char* argv[], char** device_path,
                 fprintf(stderr, "Error: Threshold must be positive\n");
                 return -1;
             }
+        } else if (strcmp(argv[i], "--realtime") == 0) {
+            options->realtime = 1;
+        } else if (strcmp(argv[i], "--rt-priority") == 0 && i + 1 < argc) {
+            options->rt_priority = atoi(argv[++i]);
+            if (options->rt_priority < 1 || options->rt_priority > 99) {
+                fprintf(stderr, "Error: Real-time priority must be between 1 and 99\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--rt-cpu") == 0 && i + 1 < argc) {
+            options->acquisition_cpu = atoi(argv[++i]);
+            if (options->acquisition_cpu < 0) {
+                fprintf(stderr, "Error: CPU index must be non-negative\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--writer-cpu") == 0 && i + 1 < argc) {
+            options->writer_cpu = atoi(argv[++i]);
+            if (options->writer_cpu < 0) {
+                fprintf(stderr, "Error: CPU index must be non-negative\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--status-hz") == 0 && i + 1 < argc) {
+            options->status_hz = atoi(argv[++i]);
+            if (options->status_hz <= 0 || options->status_hz > 1000) {
+                fprintf(stderr, "Error: Status refresh rate must be between 1 and 1000 Hz\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--daemon") == 0 && i + 1 < argc) {
+            options->config_file = argv[++i];
+        } else if (strcmp(argv[i], "--metrics-port") == 0 && i + 1 < argc) {
+            options->metrics_port = atoi(argv[++i]);
+            if (options->metrics_port <= 0 || options->metrics_port > 65535) {
+                fprintf(stderr, "Error: Metrics port must be between 1 and 65535\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            options->trace_file = argv[++i];
+        } else if (strcmp(argv[i], "--bus") == 0 && i + 1 < argc) {
+            options->bus_name = argv[++i];
+            if (options->bus_name[0] == '\0' || strchr(options->bus_name, '/')) {
+                fprintf(stderr, "Error: Bus name must be non-empty and contain no '/'\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--bus-slots") == 0 && i + 1 < argc) {
+            options->bus_slots = atoi(argv[++i]);
+            if (options->bus_slots < 64 || options->bus_slots > (1 << 24)) {
+                fprintf(stderr, "Error: Bus slots must be between 64 and 16777216\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--subscriber-threads") == 0 && i + 1 < argc) {
+            options->subscriber_threads = atoi(argv[++i]);
+            if (options->subscriber_threads < 1 || options->subscriber_threads > 8) {
+                fprintf(stderr, "Error: Subscriber threads must be between 1 and 8\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--analysis-threads") == 0 && i + 1 < argc) {
+            options->analysis_threads = atoi(argv[++i]);
+            if (options->analysis_threads < 0 || options->analysis_threads > 64) {
+                fprintf(stderr, "Error: Analysis threads must be between 0 and 64\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--history") == 0 && i + 1 < argc) {
+            options->history_seconds = atoi(argv[++i]);
+            if (options->history_seconds <= 0) {
+                fprintf(stderr, "Error: History horizon must be positive\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--history-mb") == 0 && i + 1 < argc) {
+            options->history_mb = atoi(argv[++i]);
+            if (options->history_mb <= 0 || options->history_mb > 4096) {
+                fprintf(stderr, "Error: History memory must be between 1 and 4096 MB\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--rules") == 0 && i + 1 < argc) {
+            options->rules_file = argv[++i];
+        } else if (strcmp(argv[i], "--trigger-pre") == 0 && i + 1 < argc) {
+            options->trigger_pre_ms = atoi(argv[++i]);
+            if (options->trigger_pre_ms <= 0) {
+                fprintf(stderr, "Error: Trigger pre-capture must be positive\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--trigger-post") == 0 && i + 1 < argc) {
+            options->trigger_post_ms = atoi(argv[++i]);
+            if (options->trigger_post_ms < 0) {
+                fprintf(stderr, "Error: Trigger post-capture must not be negative\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--log-decimation") == 0 && i + 1 < argc) {
+            options->log_decimation = atoi(argv[++i]);
+            if (options->log_decimation < 1) {
+                fprintf(stderr, "Error: Log decimation must be at least 1\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--perf-counters") == 0) {
+            options->perf_counters = 1;
         } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
             printf("Real-Time Sensor Data Logger\n\n");
             printf("Usage: %s [OPTIONS]\n\n", argv[0]);
             printf("Options:\n");
             printf("  --hardware <device>   Use hardware mode with specified device (e.g., /dev/ttyUSB0)\n");
-            printf("  --duration <seconds>  Set logging duration in seconds (default: 60)\n");
+            printf("  --duration <seconds>  Set logging duration in seconds, 0 = until stopped (default: 60)\n");
             printf("  --interval <ms>       Set sampling interval in milliseconds (default: 100)\n");
             printf("  --output <filename>   Set output CSV filename\n");
             printf("  --threshold <value>   Set anomaly detection threshold (default: 3.0)\n");
+            printf("  --realtime            Lock memory and sample at SCHED_FIFO priority\n");
+            printf("  --rt-priority <1-99>  Real-time priority for acquisition (default: 80)\n");
+            printf("  --rt-cpu <cpu>        Pin acquisition thread to CPU\n");
+            printf("  --writer-cpu <cpu>    Pin writer threads to CPU\n");
+            printf("  --status-hz <hz>      Console status refresh rate (default: 10)\n");
+            printf("  --daemon <config>     Run all profiles in a config file headless\n");
+            printf("  --metrics-port <port> Serve Prometheus metrics on 127.0.0.1:<port>\n");
+            printf("  --trace <file>        Write a Chrome/Perfetto trace on SIGUSR1 and at exit\n");
+            printf("  --bus <name>          Publish live samples to /dev/shm/<name>\n");
+            printf("  --bus-slots <n>       Sample bus ring size in samples (default: 65536)\n");
+            printf("  --subscriber-threads <n> Worker threads for analysis subscribers (default: 2)\n");
+            printf("  --analysis-threads <n> Split batch analysis across n threads, 0 = one per CPU\n");
+            printf("  --history <seconds>   Keep recent samples in memory, served at /history\n");
+            printf("  --history-mb <mb>     Memory bound for --history (default: 16)\n");
+            printf("  --rules <file>        Evaluate alert rules and limits from a rules file\n");
+            printf("  --trigger-pre <ms>    Write raw samples around each anomaly to an event file\n");
+            printf("  --trigger-post <ms>   Raw samples kept after an anomaly (default: same as pre)\n");
+            printf("  --log-decimation <n>  Main log keeps every Nth sample with --trigger-pre\n");
+            printf("  --perf-counters       Add hardware counters to stage probes (make probes)\n");
             printf("  --help, -h            Show this help message\n\n");
             printf("Examples:\n");
             printf("  %s                                    # Simulated mode, 60 seconds\n", argv[0]);
             printf("  %s --duration 300 --interval 50      # Simulated mode, 5 minutes, 50ms interval\n", argv[0]);
             printf("  %s --hardware /dev/ttyUSB0            # Hardware mode with USB device\n", argv[0]);
+            printf("  %s --realtime --rt-cpu 2             # Real-time sampling pinned to CPU 2\n", argv[0]);
+            printf("  %s --daemon daemon_example.conf      # Bridge and environmental profiles together\n", argv[0]);
             return 1;  // Indicate help was shown
         } else {
             fprintf(stderr, "Error: Unknown argument '%s'\n", argv[i]);
@@ -128,6 +294,12 @@ int parse_command_line_args(int argc, char* argv[], char** device_path,
         }
     }
     
+    // Decimating the main log without event files would just lose data
+    if (options->log_decimation > 1 && options->trigger_pre_ms == 0) {
+        fprintf(stderr, "Error: --log-decimation requires --trigger-pre\n");
+        return -1;
+    }
+    
     return 0;  // Success
 }
 
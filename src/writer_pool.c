@@ -0,0 +1,155 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/writer_pool.h"
+#include "../include/realtime.h"
+#include "../include/trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+
+// Writer thread main loop
+static void* writer_thread(void* arg) {
+    writer_pool_t* pool = arg;
+
+    trace_set_thread_name("writer");
+
+    // Writers stay off the acquisition CPU unless explicitly placed
+    if (pool->writer_cpu >= 0) {
+        pin_current_thread_to_cpu(pool->writer_cpu);
+    } else {
+        reset_current_thread_affinity();
+    }
+
+    pthread_mutex_lock(&pool->lock);
+
+    for (;;) {
+        while (pool->count == 0 && pool->running) {
+            pthread_cond_wait(&pool->not_empty, &pool->lock);
+        }
+
+        if (pool->count == 0 && !pool->running) {
+            break;
+        }
+
+        writer_job_t job = pool->queue[pool->tail];
+        pool->tail = (pool->tail + 1) % WRITER_QUEUE_SIZE;
+        pool->count--;
+        gauge_set(pool->queue_depth_metric, pool->count);
+        pthread_cond_signal(&pool->not_full);
+        pthread_mutex_unlock(&pool->lock);
+
+        if (job.gaps) {
+            write_logger_gaps(job.logger, job.gaps);
+        }
+        if (job.batches) {
+            write_logger_batches(job.logger, job.batches, job.batch_count);
+        } else {
+            write_logger_records(job.logger, job.records, job.count);
+        }
+        complete_logger_write(job.logger);
+
+        pthread_mutex_lock(&pool->lock);
+        pool->jobs_completed++;
+        pool->records_written += job.count;
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+// Start writer threads
+int init_writer_pool(writer_pool_t* pool, int thread_count, int writer_cpu) {
+    if (!pool || thread_count <= 0) return -1;
+
+    if (thread_count > WRITER_POOL_MAX_THREADS) {
+        thread_count = WRITER_POOL_MAX_THREADS;
+    }
+
+    memset(pool, 0, sizeof(*pool));
+    pool->writer_cpu = writer_cpu;
+    pool->running = 1;
+    pool->queue_depth_metric = register_gauge("datalogger_writer_queue_depth",
+                                              "Batches waiting for a writer thread");
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->not_empty, NULL);
+    pthread_cond_init(&pool->not_full, NULL);
+
+    // Disk writes never run at real-time priority
+    pthread_attr_t attr;
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    pthread_attr_setschedparam(&attr, &param);
+
+    for (int i = 0; i < thread_count; i++) {
+        int result = pthread_create(&pool->threads[i], &attr, writer_thread, pool);
+        if (result != 0) {
+            fprintf(stderr, "Error: Cannot start writer thread: %s\n", strerror(result));
+            break;
+        }
+        pool->thread_count++;
+    }
+
+    pthread_attr_destroy(&attr);
+
+    if (pool->thread_count == 0) {
+        cleanup_writer_pool(pool);
+        return -1;
+    }
+
+    printf("Writer pool started with %d thread(s)\n", pool->thread_count);
+    return 0;
+}
+
+// Queue a job, blocking while the queue is full
+int submit_writer_job(writer_pool_t* pool, const writer_job_t* job) {
+    if (!pool || !job) return -1;
+
+    pthread_mutex_lock(&pool->lock);
+
+    while (pool->count == WRITER_QUEUE_SIZE && pool->running) {
+        pthread_cond_wait(&pool->not_full, &pool->lock);
+    }
+
+    if (!pool->running) {
+        pthread_mutex_unlock(&pool->lock);
+        return -1;
+    }
+
+    pool->queue[pool->head] = *job;
+    pool->head = (pool->head + 1) % WRITER_QUEUE_SIZE;
+    pool->count++;
+    gauge_set(pool->queue_depth_metric, pool->count);
+    pthread_cond_signal(&pool->not_empty);
+
+    pthread_mutex_unlock(&pool->lock);
+    return 0;
+}
+
+// Drain queued jobs and stop writer threads
+void cleanup_writer_pool(writer_pool_t* pool) {
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->running = 0;
+    pthread_cond_broadcast(&pool->not_empty);
+    pthread_cond_broadcast(&pool->not_full);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->thread_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    if (pool->thread_count > 0) {
+        printf("Writer pool stopped: %ld batches, %ld records written\n",
+               pool->jobs_completed, pool->records_written);
+    }
+    pool->thread_count = 0;
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->not_empty);
+    pthread_cond_destroy(&pool->not_full);
+}
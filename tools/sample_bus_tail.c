@@ -0,0 +1,82 @@
+#define _POSIX_C_SOURCE 200809L
+
+// Example sample bus consumer: prints live samples as CSV lines.
+// Build with 'make bus-client'; links only libsamplebus.a.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include "sample_bus.h"
+
+#define TAIL_BATCH 256
+
+static volatile sig_atomic_t running = 1;
+
+static void signal_handler(int signal) {
+    (void)signal;
+    running = 0;
+}
+
+static void print_usage(const char* program) {
+    printf("Usage: %s [name] [--oldest] [--count N]\n", program);
+    printf("  name        Bus name under /dev/shm (default: datalogger)\n");
+    printf("  --oldest    Start with the oldest sample still in the ring\n");
+    printf("  --count N   Exit after N samples\n");
+}
+
+int main(int argc, char* argv[]) {
+    const char* name = "datalogger";
+    int from_oldest = 0;
+    long limit = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--oldest") == 0) {
+            from_oldest = 1;
+        } else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+            limit = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (argv[i][0] != '-') {
+            name = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    sample_bus_reader_t reader;
+    if (open_sample_bus(&reader, name, from_oldest) != 0) {
+        return 1;
+    }
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    bus_sample_t samples[TAIL_BATCH];
+    long received = 0;
+
+    printf("timestamp_ns,source,type,value\n");
+    while (running && (limit == 0 || received < limit)) {
+        int count = read_sample_bus(&reader, samples, TAIL_BATCH);
+        if (count < 0) break;  // Publisher stopped
+        if (count == 0) {
+            wait_sample_bus(&reader, 100);
+            continue;
+        }
+
+        for (int i = 0; i < count && (limit == 0 || received < limit); i++, received++) {
+            printf("%lld,%s,%u,%.6f\n", (long long)samples[i].timestamp_ns,
+                   sample_bus_source_name(&reader, samples[i].source),
+                   samples[i].type, samples[i].value);
+        }
+        fflush(stdout);
+    }
+
+    fprintf(stderr, "Received %ld samples, %llu lost to overruns\n",
+            received, (unsigned long long)reader.lost);
+    close_sample_bus(&reader);
+    return 0;
+}
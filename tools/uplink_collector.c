@@ -0,0 +1,218 @@
+#define _POSIX_C_SOURCE 200809L
+
+// Test collector for the daemon's store-and-forward uplink: serves one
+// connection at a time and mirrors every stream's log segments byte for byte
+// under <dir>/<stream>/. Build with 'make uplink-collector'.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "uplink_protocol.h"
+
+static volatile sig_atomic_t running = 1;
+
+static void signal_handler(int signal) {
+    (void)signal;
+    running = 0;
+}
+
+static void print_usage(const char* program) {
+    printf("Usage: %s [--port N] [--dir DIR] [--drop-after N]\n", program);
+    printf("  --port N        Listen port (default: %d)\n", UPLINK_DEFAULT_PORT);
+    printf("  --dir DIR       Where segments are mirrored (default: collected)\n");
+    printf("  --drop-after N  Store every Nth data frame but close the connection\n");
+    printf("                  instead of acknowledging it (simulates a flaky link)\n");
+}
+
+// Names come from the network: no paths
+static int valid_name(const char* name) {
+    return name[0] != '\0' && name[0] != '.' && !strchr(name, '/');
+}
+
+// Newest segment of a stream and its size (segment "" when there is none)
+static void stream_position(const char* dir, const char* stream, char* segment, uint64_t* size) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, stream);
+
+    segment[0] = '\0';
+    *size = 0;
+
+    DIR* entries = opendir(path);
+    if (!entries) return;
+
+    struct dirent* entry;
+    while ((entry = readdir(entries)) != NULL) {
+        if (entry->d_name[0] == '.' || strlen(entry->d_name) >= UPLINK_MAX_NAME) continue;
+        if (strcmp(entry->d_name, segment) > 0) strcpy(segment, entry->d_name);
+    }
+    closedir(entries);
+
+    struct stat info;
+    snprintf(path, sizeof(path), "%s/%s/%s", dir, stream, segment);
+    if (segment[0] != '\0' && stat(path, &info) == 0) *size = (uint64_t)info.st_size;
+}
+
+// Append records to a segment and make them durable before acknowledging
+static int store_records(const char* dir, const uplink_frame_t* frame, const uint8_t* records) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, frame->stream);
+    if (mkdir(path, 0755) != 0 && errno != EEXIST) return -1;
+
+    snprintf(path, sizeof(path), "%s/%s/%s", dir, frame->stream, frame->segment);
+    FILE* file = fopen(path, "ab");
+    if (!file) return -1;
+
+    int result = fwrite(records, 1, frame->raw_length, file) == frame->raw_length &&
+                 fflush(file) == 0 && fsync(fileno(file)) == 0 ? 0 : -1;
+    fclose(file);
+    return result;
+}
+
+// Serve one uplink connection until it closes
+static void serve_connection(int fd, const char* dir, long drop_after,
+                             uint8_t* payload, uint8_t* records, long* total_records) {
+    long data_frames = 0;
+    uplink_frame_t frame;
+
+    while (running && recv_uplink_frame(fd, &frame, payload, UPLINK_MAX_PAYLOAD) == 0) {
+        if (!valid_name(frame.stream) || (frame.segment[0] != '\0' && !valid_name(frame.segment))) {
+            fprintf(stderr, "Rejected frame with invalid stream or segment name\n");
+            return;
+        }
+
+        uplink_frame_t reply;
+        memset(&reply, 0, sizeof(reply));
+        strcpy(reply.stream, frame.stream);
+        stream_position(dir, frame.stream, reply.segment, &reply.offset);
+
+        if (frame.type == UPLINK_HELLO) {
+            reply.type = UPLINK_RESUME;
+            printf("  %s: resuming at %s:%llu\n", frame.stream,
+                   reply.segment[0] ? reply.segment : "(start)", (unsigned long long)reply.offset);
+        } else if (frame.type == UPLINK_DATA) {
+            reply.type = UPLINK_ACK;
+
+            // Only what continues the newest segment, or starts a newer one, is stored
+            int continues = strcmp(frame.segment, reply.segment) == 0 && frame.offset == reply.offset;
+            int starts = frame.offset == 0 && strcmp(frame.segment, reply.segment) > 0;
+            if (continues || starts) {
+                const uint8_t* data = frame.payload;
+                if (frame.raw_length > UPLINK_MAX_RECORDS) return;
+                if (frame.flags & UPLINK_FLAG_COMPRESSED) {
+                    if (decompress_uplink_records(frame.payload, frame.payload_length,
+                                                  records, frame.raw_length) != 0) {
+                        fprintf(stderr, "Rejected corrupt data frame for %s\n", frame.stream);
+                        return;
+                    }
+                    data = records;
+                } else if (frame.payload_length != frame.raw_length) {
+                    return;
+                }
+
+                if (store_records(dir, &frame, data) != 0) {
+                    fprintf(stderr, "Cannot store %s/%s: %s\n", frame.stream, frame.segment, strerror(errno));
+                    return;
+                }
+                strcpy(reply.segment, frame.segment);
+                reply.offset = frame.offset + frame.raw_length;
+                *total_records += frame.record_count;
+            }
+
+            if (drop_after > 0 && ++data_frames % drop_after == 0) {
+                printf("  %s: dropping connection after storing %s:%llu\n", frame.stream,
+                       reply.segment, (unsigned long long)reply.offset);
+                return;
+            }
+        } else {
+            return;
+        }
+
+        if (send_uplink_frame(fd, &reply) != 0) return;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int port = UPLINK_DEFAULT_PORT;
+    const char* dir = "collected";
+    long drop_after = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--dir") == 0 && i + 1 < argc) {
+            dir = argv[++i];
+        } else if (strcmp(argv[i], "--drop-after") == 0 && i + 1 < argc) {
+            drop_after = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Cannot create '%s': %s\n", dir, strerror(errno));
+        return 1;
+    }
+
+    int server_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons((uint16_t)port);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    if (server_fd < 0 || bind(server_fd, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+        listen(server_fd, 4) != 0) {
+        fprintf(stderr, "Cannot listen on port %d: %s\n", port, strerror(errno));
+        return 1;
+    }
+
+    // No SA_RESTART, so a signal interrupts accept and recv
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = signal_handler;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    uint8_t* payload = malloc(UPLINK_MAX_PAYLOAD);
+    uint8_t* records = malloc(UPLINK_MAX_RECORDS);
+    if (!payload || !records) return 1;
+
+    printf("Collecting on port %d into %s/\n", port, dir);
+    fflush(stdout);
+
+    long total_records = 0;
+    while (running) {
+        struct sockaddr_in peer;
+        socklen_t peer_length = sizeof(peer);
+        int fd = accept(server_fd, (struct sockaddr*)&peer, &peer_length);
+        if (fd < 0) continue;
+
+        printf("Connection from %s\n", inet_ntoa(peer.sin_addr));
+        long before = total_records;
+        serve_connection(fd, dir, drop_after, payload, records, &total_records);
+        close(fd);
+        printf("Connection closed: %ld record(s) stored\n", total_records - before);
+        fflush(stdout);
+    }
+
+    printf("Stored %ld record(s)\n", total_records);
+    free(payload);
+    free(records);
+    close(server_fd);
+    return 0;
+}